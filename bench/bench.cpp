@@ -0,0 +1,317 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include "cgroupstats.h"
+#include "cpustats.h"
+#include "diskstats.h"
+#include "fixture.h"
+#include "netstats.h"
+#include "pressure.h"
+#include "procfile.h"
+#include "processtree.h"
+#include "snapshot.h"
+#include "systemcollector.h"
+
+// every allocation in the process, the scan pool's threads included
+static std::atomic<unsigned long long> allocations(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* block = malloc(size > 0 ? size : 1);
+    if (!block) throw std::bad_alloc();
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+struct Options {
+    std::string directory = "/tmp";
+    std::string filter;
+    double minTime = 0.5;               // seconds of timed samples per benchmark
+    int maxProcesses = 100000;
+    int scanThreads = 0;
+    bool keep = false;
+};
+
+struct Result {
+    double nsPerSample;
+    double allocationsPerSample;
+    double itemsPerSecond;
+};
+
+static double monotonicSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// runs sample() until minTime has been spent in it (at least three times),
+// after two untimed warm-up samples that fill caches and grow buffers.
+// between() runs outside the timing, e.g. to advance the fixture
+static Result measure(const Options& options, double items, const std::function<void()>& sample,
+                      const std::function<void()>& between = std::function<void()>()) {
+    for (int i = 0; i < 2; i++) {
+        if (between) between();
+        sample();
+    }
+    
+    double spent = 0.0;
+    unsigned long long samples = 0;
+    unsigned long long allocated = 0;
+    while (spent < options.minTime || samples < 3) {
+        if (between) between();
+        unsigned long long before = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        sample();
+        spent += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        allocated += allocations.load(std::memory_order_relaxed) - before;
+        samples++;
+    }
+    
+    Result result;
+    result.nsPerSample = spent * 1e9 / samples;
+    result.allocationsPerSample = static_cast<double>(allocated) / samples;
+    result.itemsPerSecond = spent > 0.0 ? items * samples / spent : 0.0;
+    return result;
+}
+
+static void report(const char* name, const std::string& shape, const Result& result, const char* unit) {
+    char throughput[48];
+    double rate = result.itemsPerSecond;
+    if (rate >= 1e6) snprintf(throughput, sizeof(throughput), "%.2f M %s/s", rate / 1e6, unit);
+    else if (rate >= 1e3) snprintf(throughput, sizeof(throughput), "%.2f k %s/s", rate / 1e3, unit);
+    else snprintf(throughput, sizeof(throughput), "%.2f %s/s", rate, unit);
+    printf("%-18s %-20s %14.0f %14.2f   %s\n", name, shape.c_str(), result.nsPerSample,
+           result.allocationsPerSample, throughput);
+    fflush(stdout);
+}
+
+static bool selected(const Options& options, const char* name) {
+    return options.filter.empty() || strstr(name, options.filter.c_str()) != nullptr;
+}
+
+static bool build(Fixture& fixture, const Options& options, const FixtureShape& shape) {
+    fixture.setKeep(options.keep);
+    if (fixture.create(options.directory, shape)) return true;
+    std::cerr << "Cannot create fixture: " << fixture.error() << std::endl;
+    return false;
+}
+
+static FixtureShape baseShape() {
+    FixtureShape shape;
+    shape.processes = 100;
+    shape.cores = 8;
+    shape.interfaces = 4;
+    shape.disks = 4;
+    shape.cgroups = 16;
+    shape.btrfs = false;
+    return shape;
+}
+
+// the parsers alone, on a buffer read once
+static bool benchParsers(const Options& options) {
+    if (selected(options, "parse/cpu")) {
+        for (int cores : {1, 8, 64, 512}) {
+            FixtureShape shape = baseShape();
+            shape.cores = cores;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            ProcFile stat((fixture.root() + "/proc/stat").c_str());
+            stat.read();
+            CpuCollector cpu;
+            report("parse/cpu", "cores=" + std::to_string(cores),
+                   measure(options, cores, [&]() { cpu.update(stat); }), "cores");
+        }
+    }
+    if (selected(options, "parse/network")) {
+        for (int interfaces : {1, 10, 100, 1000}) {
+            FixtureShape shape = baseShape();
+            shape.interfaces = interfaces;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            ProcFile netDev((fixture.root() + "/proc/net/dev").c_str());
+            netDev.read();
+            NetCollector network(fixture.root());
+            double now = monotonicSeconds();
+            report("parse/network", "interfaces=" + std::to_string(interfaces),
+                   measure(options, interfaces, [&]() { network.update(netDev, now += 2.0); }), "interfaces");
+        }
+    }
+    if (selected(options, "parse/disk")) {
+        for (int disks : {1, 16, 128}) {
+            FixtureShape shape = baseShape();
+            shape.disks = disks;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            ProcFile diskstats((fixture.root() + "/proc/diskstats").c_str());
+            diskstats.read();
+            DiskCollector disk(fixture.root());
+            double now = monotonicSeconds();
+            report("parse/disk", "disks=" + std::to_string(disks),
+                   measure(options, disks, [&]() { disk.update(diskstats, now += 2.0); }), "disks");
+        }
+    }
+    if (selected(options, "parse/mounts")) {
+        // a fresh collector each time, so the mount table is parsed every sample
+        for (bool btrfs : {false, true}) {
+            FixtureShape shape = baseShape();
+            shape.btrfs = btrfs;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            size_t listed = 0;
+            report("parse/mounts", btrfs ? "btrfs" : "ext4", measure(options, 1, [&]() {
+                DiskCollector disk(fixture.root());
+                disk.updateMounts();
+                listed = disk.mounts().size();
+            }), "tables");
+            
+            // see the comment on the btrfs mount table in fixture.cpp
+            size_t expected = btrfs ? 6 : 1;
+            if (listed != expected) {
+                std::cerr << "parse/mounts: listed " << listed << " filesystems, expected " << expected << std::endl;
+            }
+        }
+    }
+    if (selected(options, "parse/pressure")) {
+        Fixture fixture;
+        if (!build(fixture, options, baseShape())) return false;
+        ProcFile files[PressureResourceCount];
+        static const char* const names[] = {"cpu", "memory", "io"};
+        for (int resource = 0; resource < PressureResourceCount; resource++) {
+            files[resource].open((fixture.root() + "/proc/pressure/" + names[resource]).c_str());
+            files[resource].read();
+        }
+        PressureCollector pressure;
+        report("parse/pressure", "resources=3", measure(options, PressureResourceCount, [&]() {
+            for (int resource = 0; resource < PressureResourceCount; resource++) pressure.update(resource, files[resource]);
+        }), "files");
+    }
+    return true;
+}
+
+// whole sampling passes: open files are re-read, directories re-walked
+static bool benchCollectors(const Options& options) {
+    if (selected(options, "collect/cgroups")) {
+        for (int cgroups : {16, 256}) {
+            FixtureShape shape = baseShape();
+            shape.cgroups = cgroups;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            CgroupCollector collector(fixture.root());
+            double now = monotonicSeconds();
+            Result result = measure(options, cgroups, [&]() { collector.update(now += 2.0); });
+            report("collect/cgroups", "cgroups=" + std::to_string(cgroups), result, "cgroups");
+            
+            // an unchanged tree reuses every buffer and path string; only
+            // inotify events (or a rescan without inotify) may allocate
+            if (result.allocationsPerSample > 0) {
+                std::cerr << "collect/cgroups: expected no allocations in steady state" << std::endl;
+            }
+        }
+    }
+    if (selected(options, "collect/system")) {
+        // one dimension at a time, the others at the base shape
+        FixtureShape shapes[] = {baseShape(), baseShape(), baseShape(), baseShape(), baseShape()};
+        shapes[1].cores = 64;
+        shapes[2].cores = 512;
+        shapes[3].interfaces = 100;
+        shapes[4].interfaces = 1000;
+        for (const FixtureShape& shape : shapes) {
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            SystemCollector collector(fixture.root());
+            Snapshot snapshot;
+            char label[48];
+            snprintf(label, sizeof(label), "cores=%d if=%d", shape.cores, shape.interfaces);
+            report("collect/system", label, measure(options, 1, [&]() { collector.collect(snapshot, false); },
+                                                    [&]() { fixture.advance(); }), "samples");
+        }
+    }
+    if (selected(options, "collect/processes")) {
+        for (int processes : {100, 1000, 10000, 100000}) {
+            if (processes > options.maxProcesses) break;
+            FixtureShape shape = baseShape();
+            shape.processes = processes;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            SystemCollector collector(fixture.root());
+            collector.setScanThreads(options.scanThreads);
+            Snapshot snapshot;
+            report("collect/processes", "processes=" + std::to_string(processes),
+                   measure(options, processes, [&]() { collector.collect(snapshot, true); },
+                           [&]() { fixture.advance(); }), "processes");
+        }
+    }
+    if (selected(options, "tree/update")) {
+        // a steady process table, the usual case between two refreshes
+        for (int processes : {1000, 10000, 100000}) {
+            if (processes > options.maxProcesses) break;
+            FixtureShape shape = baseShape();
+            shape.processes = processes;
+            Fixture fixture;
+            if (!build(fixture, options, shape)) return false;
+            SystemCollector collector(fixture.root());
+            collector.setScanThreads(options.scanThreads);
+            Snapshot snapshot;
+            collector.collect(snapshot, true);
+            ProcessTree tree;
+            report("tree/update", "processes=" + std::to_string(processes),
+                   measure(options, processes, [&]() { tree.update(snapshot.processes); }), "processes");
+        }
+    }
+    return true;
+}
+
+// runs every parser and collector against generated /proc and /sys trees
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "Times the SysPulse parsers and collectors on synthetic /proc and /sys fixtures\n\n"
+                      << "Options:\n"
+                      << "  --dir <path>          Where fixtures are generated (default /tmp)\n"
+                      << "  --filter <text>       Only benchmarks whose name contains text, e.g. parse/cpu\n"
+                      << "  --min-time <s>        Timed seconds per benchmark (default 0.5)\n"
+                      << "  --max-processes <n>   Largest process table to generate (default 100000)\n"
+                      << "  --scan-threads <n>    Threads for the /proc/<pid> scan (0 = auto)\n"
+                      << "  --keep                Leave the fixtures behind for inspection\n";
+            return 0;
+        }
+        if (arg == "--keep") {
+            options.keep = true;
+            continue;
+        }
+        if (arg == "--dir" || arg == "--filter" || arg == "--min-time" || arg == "--max-processes" ||
+            arg == "--scan-threads") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value" << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--dir") options.directory = value;
+            else if (arg == "--filter") options.filter = value;
+            else if (arg == "--min-time") options.minTime = std::atof(value.c_str());
+            else if (arg == "--max-processes") options.maxProcesses = std::atoi(value.c_str());
+            else options.scanThreads = std::atoi(value.c_str());
+            continue;
+        }
+        std::cerr << "Unknown option: " << arg << std::endl;
+        return 1;
+    }
+    
+    printf("%-18s %-20s %14s %14s   %s\n", "benchmark", "shape", "ns/sample", "allocs/sample", "throughput");
+    if (!benchParsers(options) || !benchCollectors(options)) return 1;
+    return 0;
+}
@@ -0,0 +1,375 @@
+#include "fixture.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// a typical 6.x kernel /proc/<pid>/status; Uid: and VmRSS: are what the
+// collector looks for, the rest is there so the scan has the real length
+static const char* const StatusTemplate =
+    "Name:\t%s\n"
+    "Umask:\t0022\n"
+    "State:\tS (sleeping)\n"
+    "Tgid:\t%d\n"
+    "Ngid:\t0\n"
+    "Pid:\t%d\n"
+    "PPid:\t%d\n"
+    "TracerPid:\t0\n"
+    "Uid:\t%d\t%d\t%d\t%d\n"
+    "Gid:\t%d\t%d\t%d\t%d\n"
+    "FDSize:\t64\n"
+    "Groups:\t\n"
+    "NStgid:\t%d\n"
+    "NSpid:\t%d\n"
+    "NSpgid:\t%d\n"
+    "NSsid:\t%d\n"
+    "Kthread:\t0\n"
+    "VmPeak:\t  %d kB\n"
+    "VmSize:\t  %d kB\n"
+    "VmLck:\t       0 kB\n"
+    "VmPin:\t       0 kB\n"
+    "VmHWM:\t   %d kB\n"
+    "VmRSS:\t   %d kB\n"
+    "RssAnon:\t    %d kB\n"
+    "RssFile:\t    1024 kB\n"
+    "RssShmem:\t       0 kB\n"
+    "VmData:\t    2048 kB\n"
+    "VmStk:\t     132 kB\n"
+    "VmExe:\t     812 kB\n"
+    "VmLib:\t    4096 kB\n"
+    "VmPTE:\t      72 kB\n"
+    "VmSwap:\t       0 kB\n"
+    "HugetlbPages:\t       0 kB\n"
+    "CoreDumping:\t0\n"
+    "THP_enabled:\t1\n"
+    "untag_mask:\t0xffffffffffffffff\n"
+    "Threads:\t1\n"
+    "SigQ:\t0/23456\n"
+    "SigPnd:\t0000000000000000\n"
+    "ShdPnd:\t0000000000000000\n"
+    "SigBlk:\t0000000000000000\n"
+    "SigIgn:\t0000000000001000\n"
+    "SigCgt:\t0000000180004002\n"
+    "CapInh:\t0000000000000000\n"
+    "CapPrm:\t0000000000000000\n"
+    "CapEff:\t0000000000000000\n"
+    "CapBnd:\t000001ffffffffff\n"
+    "CapAmb:\t0000000000000000\n"
+    "NoNewPrivs:\t0\n"
+    "Seccomp:\t0\n"
+    "Seccomp_filters:\t0\n"
+    "Speculation_Store_Bypass:\tthread vulnerable\n"
+    "SpeculationIndirectBranch:\tconditional enabled\n"
+    "Cpus_allowed:\tff\n"
+    "Cpus_allowed_list:\t0-7\n"
+    "Mems_allowed:\t00000001\n"
+    "Mems_allowed_list:\t0\n"
+    "voluntary_ctxt_switches:\t%d\n"
+    "nonvoluntary_ctxt_switches:\t%d\n";
+
+static const char* const Meminfo =
+    "MemTotal:       16318480 kB\n"
+    "MemFree:         6120512 kB\n"
+    "MemAvailable:   11820344 kB\n"
+    "Buffers:          412236 kB\n"
+    "Cached:          5203348 kB\n"
+    "SwapCached:            0 kB\n"
+    "Active:          5930120 kB\n"
+    "Inactive:        3321456 kB\n"
+    "Active(anon):    3705244 kB\n"
+    "Inactive(anon):        0 kB\n"
+    "Active(file):    2224876 kB\n"
+    "Inactive(file):  3321456 kB\n"
+    "Unevictable:       65432 kB\n"
+    "Mlocked:               0 kB\n"
+    "SwapTotal:       2097148 kB\n"
+    "SwapFree:        2097148 kB\n"
+    "Zswap:                 0 kB\n"
+    "Zswapped:              0 kB\n"
+    "Dirty:              1204 kB\n"
+    "Writeback:             0 kB\n"
+    "AnonPages:       3701012 kB\n"
+    "Mapped:           903412 kB\n"
+    "Shmem:            131072 kB\n"
+    "KReclaimable:     301288 kB\n"
+    "Slab:             512340 kB\n"
+    "SReclaimable:     301288 kB\n"
+    "SUnreclaim:       211052 kB\n"
+    "KernelStack:       18432 kB\n"
+    "PageTables:        45120 kB\n"
+    "SecPageTables:         0 kB\n"
+    "NFS_Unstable:          0 kB\n"
+    "Bounce:                0 kB\n"
+    "WritebackTmp:          0 kB\n"
+    "CommitLimit:    10256388 kB\n"
+    "Committed_AS:   12873340 kB\n"
+    "VmallocTotal:   34359738367 kB\n"
+    "VmallocUsed:       71234 kB\n"
+    "VmallocChunk:          0 kB\n"
+    "Percpu:            10240 kB\n"
+    "HardwareCorrupted:     0 kB\n"
+    "AnonHugePages:    614400 kB\n"
+    "ShmemHugePages:        0 kB\n"
+    "ShmemPmdMapped:        0 kB\n"
+    "FileHugePages:         0 kB\n"
+    "FilePmdMapped:         0 kB\n"
+    "Unaccepted:            0 kB\n"
+    "HugePages_Total:       0\n"
+    "HugePages_Free:        0\n"
+    "HugePages_Rsvd:        0\n"
+    "HugePages_Surp:        0\n"
+    "Hugepagesize:       2048 kB\n"
+    "Hugetlb:               0 kB\n"
+    "DirectMap4k:      401216 kB\n"
+    "DirectMap2M:    16375808 kB\n";
+
+static const char* const ProcessNames[] = {
+    "systemd", "kworker/0:1-events", "bash", "sshd", "nginx", "postgres", "java", "python3",
+    "containerd-shim", "node", "(sd-pam)", "rsyslogd",
+};
+
+Fixture::Fixture() : size(), step(0), keep(false) {
+}
+
+Fixture::~Fixture() {
+    if (!keep) remove();
+}
+
+bool Fixture::writeFile(const std::string& path, const std::string& text) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        lastError = path + ": " + strerror(errno);
+        return false;
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) lastError = path + ": " + strerror(errno);
+    return ok;
+}
+
+bool Fixture::makeDirectory(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST) return true;
+    lastError = path + ": " + strerror(errno);
+    return false;
+}
+
+static const char* const Ext4Mountinfo =
+    "22 1 253:1 / / rw,relatime shared:1 - ext4 /dev/vda1 rw\n"
+    "30 22 0:26 / /sys/fs/cgroup rw,nosuid,nodev,noexec,relatime shared:9 - cgroup2 cgroup2 rw\n";
+
+// a Fedora-style install (subvolumes "root" and "home", one anonymous dev),
+// an openSUSE-style data disk whose subvolumes nest by path, an ext4 /boot,
+// and bind mounts that must not be listed again. the filesystems to list
+// are /, /home, /boot, /data, /data/.snapshots and /data/var
+static const char* const BtrfsMountinfo =
+    "22 1 0:31 /root / rw,relatime shared:1 - btrfs /dev/nvme0n1p3 rw,seclabel,compress=zstd:1,ssd,"
+    "space_cache=v2,subvolid=257,subvol=/root\n"
+    "30 22 0:26 / /sys/fs/cgroup rw,nosuid,nodev,noexec,relatime shared:9 - cgroup2 cgroup2 rw\n"
+    "45 22 259:2 / /boot rw,relatime shared:30 - ext4 /dev/nvme0n1p2 rw,seclabel\n"
+    "48 22 0:31 /home /home rw,relatime shared:32 - btrfs /dev/nvme0n1p3 rw,seclabel,compress=zstd:1,ssd,"
+    "space_cache=v2,subvolid=256,subvol=/home\n"
+    "50 22 0:44 /@/.snapshots/1/snapshot /data rw,relatime shared:34 - btrfs /dev/sda1 rw,ssd,"
+    "space_cache=v2,subvolid=268,subvol=/@/.snapshots/1/snapshot\n"
+    "51 50 0:44 /@/.snapshots /data/.snapshots rw,relatime shared:35 - btrfs /dev/sda1 rw,ssd,"
+    "space_cache=v2,subvolid=266,subvol=/@/.snapshots\n"
+    "52 50 0:44 /@/var /data/var rw,relatime shared:36 - btrfs /dev/sda1 rw,ssd,"
+    "space_cache=v2,subvolid=265,subvol=/@/var\n"
+    "60 22 0:31 /home/dev/projects /srv/projects rw,relatime shared:32 - btrfs /dev/nvme0n1p3 rw,seclabel,"
+    "compress=zstd:1,ssd,space_cache=v2,subvolid=256,subvol=/home\n"
+    "61 22 0:31 /home /mnt/home rw,relatime shared:32 - btrfs /dev/nvme0n1p3 rw,seclabel,compress=zstd:1,ssd,"
+    "space_cache=v2,subvolid=256,subvol=/home\n"
+    "62 22 259:2 /grub2 /mnt/grub rw,relatime shared:30 - ext4 /dev/nvme0n1p2 rw,seclabel\n";
+
+bool Fixture::create(const std::string& parent, const FixtureShape& shape) {
+    remove();
+    size = shape;
+    step = 0;
+    
+    std::string pattern = parent + "/syspulse-fixture-XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    if (!mkdtemp(name.data())) {
+        lastError = pattern + ": " + strerror(errno);
+        return false;
+    }
+    rootPath = name.data();
+    
+    static const char* const directories[] = {
+        "/proc", "/proc/net", "/proc/pressure", "/proc/self", "/sys", "/sys/block", "/sys/class",
+        "/sys/class/net", "/sys/class/thermal", "/sys/class/thermal/thermal_zone0", "/sys/fs",
+        "/sys/fs/cgroup", "/sys/fs/cgroup/system.slice", "/boot", "/home", "/data", "/data/.snapshots",
+        "/data/var",
+    };
+    for (const char* directory : directories) {
+        if (!makeDirectory(rootPath + directory)) return false;
+    }
+    
+    // the root filesystem and the cgroup2 mount, both below the fixture root
+    if (!writeFile(rootPath + "/proc/self/mountinfo", shape.btrfs ? BtrfsMountinfo : Ext4Mountinfo) ||
+        !writeFile(rootPath + "/proc/meminfo", Meminfo) ||
+        !writeFile(rootPath + "/proc/uptime", "351234.56 2712345.67\n") ||
+        !writeFile(rootPath + "/sys/class/thermal/thermal_zone0/temp", "47000\n")) {
+        return false;
+    }
+    
+    char path[256];
+    for (int i = 0; i < shape.interfaces; i++) {
+        snprintf(path, sizeof(path), "/sys/class/net/eth%d", i);
+        if (!makeDirectory(rootPath + path) || !writeFile(rootPath + path + "/flags", "0x1003\n")) return false;
+    }
+    if (!makeDirectory(rootPath + "/sys/class/net/lo") || !writeFile(rootPath + "/sys/class/net/lo/flags", "0x9\n")) {
+        return false;
+    }
+    for (int i = 0; i < shape.disks; i++) {
+        snprintf(path, sizeof(path), "/sys/block/nvme%dn1", i);
+        if (!makeDirectory(rootPath + path)) return false;
+    }
+    
+    for (int i = 0; i < shape.cgroups; i++) {
+        snprintf(path, sizeof(path), "/sys/fs/cgroup/system.slice/service%d.service", i);
+        if (!makeDirectory(rootPath + path) || !writeCgroup(path, true)) return false;
+    }
+    if (!writeCgroup("/sys/fs/cgroup/system.slice", shape.cgroups > 0)) return false;
+    
+    // pids start at 1 and are dense, like a freshly booted host
+    for (int pid = 1; pid <= shape.processes; pid++) {
+        if (!writeProcess(pid)) return false;
+    }
+    return advance();
+}
+
+void Fixture::remove() {
+    if (rootPath.empty()) return;
+    // children first; anything that cannot be removed is left behind
+    nftw(rootPath.c_str(), [](const char* path, const struct stat*, int, struct FTW*) {
+        ::remove(path);
+        return 0;
+    }, 16, FTW_DEPTH | FTW_PHYS);
+    rootPath.clear();
+}
+
+bool Fixture::writeCgroup(const std::string& path, bool populated) {
+    std::string directory = rootPath + path;
+    unsigned long long usage = 1000000ULL + step * 10000ULL;
+    char text[256];
+    snprintf(text, sizeof(text), "populated %d\nfrozen 0\n", populated ? 1 : 0);
+    if (!writeFile(directory + "/cgroup.events", text)) return false;
+    snprintf(text, sizeof(text), "usage_usec %llu\nuser_usec %llu\nsystem_usec %llu\n"
+             "nr_periods 0\nnr_throttled 0\nthrottled_usec 0\n", usage, usage / 2, usage / 2);
+    return writeFile(directory + "/cpu.stat", text) &&
+           writeFile(directory + "/memory.current", "73400320\n") &&
+           writeFile(directory + "/memory.max", "max\n") &&
+           writeFile(directory + "/pids.current", "4\n") &&
+           writeFile(directory + "/io.stat", "259:0 rbytes=180224 wbytes=4096 rios=3 wios=1 dbytes=0 dios=0\n");
+}
+
+bool Fixture::writeProcess(int pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d", pid);
+    std::string directory = rootPath + path;
+    if (!makeDirectory(directory)) return false;
+    
+    const char* name = ProcessNames[pid % (sizeof(ProcessNames) / sizeof(ProcessNames[0]))];
+    int ppid = pid > 1 ? 1 + (pid - 1) / 4 : 0;
+    int uid = pid % 3 == 0 ? 1000 : 0;
+    int rss = 2048 + (pid * 37) % 500000;
+    
+    // pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt
+    // cmajflt utime stime cutime cstime priority nice threads itrealvalue starttime vsize rss ...
+    char text[2600];
+    int length = snprintf(text, sizeof(text),
+                          "%d (%s) S %d %d %d 0 -1 4194560 %d 0 12 0 %d %d 0 0 20 0 1 0 %d %d %d "
+                          "18446744073709551615 1 1 0 0 0 0 0 4096 16384 0 0 0 17 %d 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                          pid, name, ppid, pid, pid, pid * 13, pid % 997, pid % 331, 100 + pid,
+                          rss * 4096, rss / 4, pid % 8);
+    if (!writeFile(directory + "/stat", std::string(text, length))) return false;
+    
+    length = snprintf(text, sizeof(text), StatusTemplate, name, pid, pid, ppid, uid, uid, uid, uid,
+                      uid, uid, uid, uid, pid, pid, pid, pid, rss * 3, rss * 3, rss, rss, rss - 1024,
+                      pid % 1000, pid % 100);
+    if (!writeFile(directory + "/status", std::string(text, length))) return false;
+    
+    length = snprintf(text, sizeof(text),
+                      "rchar: %d\nwchar: %d\nsyscr: %d\nsyscw: %d\nread_bytes: %d\nwrite_bytes: %d\n"
+                      "cancelled_write_bytes: 0\n",
+                      pid * 9173, pid * 4411, pid % 5003, pid % 2011, (pid % 4096) * 4096, (pid % 1024) * 4096);
+    return writeFile(directory + "/io", std::string(text, length));
+}
+
+bool Fixture::writeStat() {
+    std::string text;
+    text.reserve(static_cast<size_t>(size.cores + 8) * 96);
+    char line[192];
+    
+    // each core gains 100 ticks a step, a quarter of them busy
+    unsigned long long base = 1000000ULL + step * 100ULL;
+    unsigned long long cores = static_cast<unsigned long long>(size.cores);
+    snprintf(line, sizeof(line), "cpu  %llu 120 %llu %llu 800 0 300 0 0 0\n",
+             cores * base / 5, cores * base / 20, cores * base * 3 / 4);
+    text += line;
+    for (int core = 0; core < size.cores; core++) {
+        snprintf(line, sizeof(line), "cpu%d %llu 15 %llu %llu 100 0 37 0 0 0\n",
+                 core, base / 5, base / 20, base * 3 / 4);
+        text += line;
+    }
+    snprintf(line, sizeof(line), "intr %llu 0 9 0 0 0\nctxt %llu\nbtime 1700000000\nprocesses %d\n"
+             "procs_running 2\nprocs_blocked 0\nsoftirq 123456 0 1 2 3 4 5 6 7 8\n",
+             step * 1000, step * 5000, size.processes);
+    text += line;
+    return writeFile(rootPath + "/proc/stat", text);
+}
+
+bool Fixture::writeNetDev() {
+    std::string text = "Inter-|   Receive                                                |  Transmit\n"
+                       " face |bytes    packets errs drop fifo frame compressed multicast|"
+                       "bytes    packets errs drop fifo colls carrier compressed\n";
+    text.reserve(static_cast<size_t>(size.interfaces + 3) * 128);
+    char line[256];
+    unsigned long long bytes = 5000000ULL + step * 125000ULL;
+    snprintf(line, sizeof(line), "    lo: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+             bytes, bytes / 100, bytes, bytes / 100);
+    text += line;
+    for (int i = 0; i < size.interfaces; i++) {
+        snprintf(line, sizeof(line), "%6s%d: %llu %llu 0 0 0 0 0 12 %llu %llu 0 0 0 0 0 0\n", "eth", i,
+                 bytes * 3, bytes / 400, bytes, bytes / 500);
+        text += line;
+    }
+    return writeFile(rootPath + "/proc/net/dev", text);
+}
+
+bool Fixture::writeDiskstats() {
+    std::string text;
+    char line[256];
+    unsigned long long ios = 10000ULL + step * 50ULL;
+    for (int i = 0; i < size.disks; i++) {
+        // the whole disk, then its partition, which has no /sys/block entry
+        snprintf(line, sizeof(line), " 259 %7d nvme%dn1 %llu 100 %llu 2000 %llu 50 %llu 3000 0 %llu 5000 0 0 0 0 10 20\n",
+                 i * 2, i, ios, ios * 16, ios, ios * 8, ios / 4);
+        text += line;
+        snprintf(line, sizeof(line), " 259 %7d nvme%dn1p1 %llu 100 %llu 2000 %llu 50 %llu 3000 0 %llu 5000 0 0 0 0 0 0\n",
+                 i * 2 + 1, i, ios, ios * 16, ios, ios * 8, ios / 4);
+        text += line;
+    }
+    return writeFile(rootPath + "/proc/diskstats", text);
+}
+
+bool Fixture::writePressure() {
+    static const char* const resources[] = {"cpu", "memory", "io"};
+    char text[256];
+    for (const char* resource : resources) {
+        snprintf(text, sizeof(text),
+                 "some avg10=1.25 avg60=0.80 avg300=0.33 total=%llu\nfull avg10=0.10 avg60=0.05 avg300=0.01 total=%llu\n",
+                 123456ULL + step * 1000ULL, 12345ULL + step * 100ULL);
+        if (!writeFile(rootPath + "/proc/pressure/" + resource, text)) return false;
+    }
+    return true;
+}
+
+bool Fixture::advance() {
+    step++;
+    return writeStat() && writeNetDev() && writeDiskstats() && writePressure();
+}
@@ -0,0 +1,59 @@
+#ifndef FIXTURE_H
+#define FIXTURE_H
+
+#include <string>
+
+// the size of a generated machine
+struct FixtureShape {
+    int processes;
+    int cores;
+    int interfaces;                     // besides lo
+    int disks;                          // each with one partition
+    int cgroups;                        // populated leaves below system.slice
+    bool btrfs;                         // mount table of btrfs subvolumes instead of one ext4 root
+};
+
+// a synthetic /proc and /sys tree with the files syspulse reads, laid out
+// so that SystemCollector(root()) can sample it like the live system.
+// advance() moves the system-wide counters on, so rates are non-zero; the
+// per-process files stay as written, which costs the same to parse.
+class Fixture {
+public:
+    Fixture();
+    ~Fixture();
+    
+    Fixture(const Fixture&) = delete;
+    Fixture& operator=(const Fixture&) = delete;
+    
+    // builds the tree in a new directory below parent
+    bool create(const std::string& parent, const FixtureShape& shape);
+    // deletes the tree; also done by the destructor unless keep is set
+    void remove();
+    void setKeep(bool enabled) { keep = enabled; }
+    
+    // rewrite /proc/stat, /proc/net/dev, /proc/diskstats and the psi files
+    // with counters one step further
+    bool advance();
+    
+    const std::string& root() const { return rootPath; }
+    const FixtureShape& shape() const { return size; }
+    const std::string& error() const { return lastError; }
+    
+private:
+    bool writeFile(const std::string& path, const std::string& text);
+    bool makeDirectory(const std::string& path);
+    bool writeStat();
+    bool writeNetDev();
+    bool writeDiskstats();
+    bool writePressure();
+    bool writeProcess(int pid);
+    bool writeCgroup(const std::string& path, bool populated);
+    
+    std::string rootPath;
+    FixtureShape size;
+    unsigned long long step;
+    bool keep;
+    std::string lastError;
+};
+
+#endif
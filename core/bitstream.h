@@ -0,0 +1,66 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// msb-first bit packing into a growable byte buffer
+class BitWriter {
+public:
+    BitWriter() : bitCount(0) {}
+    
+    void writeBit(bool bit) {
+        if ((bitCount & 7) == 0) bytes.push_back(0);
+        if (bit) bytes.back() |= static_cast<uint8_t>(0x80 >> (bitCount & 7));
+        bitCount++;
+    }
+    
+    // low `count` bits of value, most significant first
+    void writeBits(uint64_t value, int count) {
+        for (int i = count - 1; i >= 0; i--) writeBit((value >> i) & 1);
+    }
+    
+    void clear() {
+        bytes.clear();
+        bitCount = 0;
+    }
+    
+    const std::vector<uint8_t>& data() const { return bytes; }
+    size_t bits() const { return bitCount; }
+    
+private:
+    std::vector<uint8_t> bytes;
+    size_t bitCount;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t length) : data(data), bitLength(length * 8), position(0) {}
+    
+    bool readBit() {
+        if (position >= bitLength) {
+            position++;
+            return false;
+        }
+        bool bit = (data[position >> 3] >> (7 - (position & 7))) & 1;
+        position++;
+        return bit;
+    }
+    
+    uint64_t readBits(int count) {
+        uint64_t value = 0;
+        for (int i = 0; i < count; i++) value = (value << 1) | (readBit() ? 1 : 0);
+        return value;
+    }
+    
+    // true once a read has gone past the end of the buffer
+    bool overrun() const { return position > bitLength; }
+    
+private:
+    const uint8_t* data;
+    size_t bitLength;
+    size_t position;
+};
+
+#endif
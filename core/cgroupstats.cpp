@@ -0,0 +1,324 @@
+#include "cgroupstats.h"
+#include "counters.h"
+#include "scanner.h"
+#include "selfstats.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// what a watch on a cgroup directory has to report
+static const uint32_t WatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ONLYDIR;
+
+CgroupCollector::CgroupCollector(const std::string& rootPath)
+    : root(rootPath), mountSearched(false), inotifyFd(-1), rescanNeeded(true),
+      missingWatches(false), previousTime(0.0), reads(0) {
+}
+
+CgroupCollector::~CgroupCollector() {
+    if (inotifyFd >= 0) close(inotifyFd);
+}
+
+void CgroupCollector::findMount() {
+    mountSearched = true;
+    ProcFile mountinfo((root + "/proc/self/mountinfo").c_str());
+    if (!mountinfo.read()) return;
+    
+    // id parent major:minor root mountpoint options [optional...] - fstype source options
+    Scanner sc(mountinfo.begin(), mountinfo.end());
+    while (!sc.atEnd()) {
+        const char* lineEnd = static_cast<const char*>(memchr(sc.pos, '\n', sc.end - sc.pos));
+        if (!lineEnd) lineEnd = sc.end;
+        sc.skipTokens(4);
+        sc.skipSpaces();
+        const char* pointStart = sc.pos;
+        sc.skipToken();
+        std::string point(pointStart, sc.pos - pointStart);
+        const char* type = static_cast<const char*>(memmem(sc.pos, lineEnd - sc.pos, " - cgroup2 ", 11));
+        sc.pos = lineEnd < sc.end ? lineEnd + 1 : sc.end;
+        if (type) {
+            mountPoint = root + point;
+            return;
+        }
+    }
+}
+
+void CgroupCollector::rescan() {
+    rescanNeeded = false;
+    if (inotifyFd >= 0) close(inotifyFd);
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watches.clear();
+    missingWatches = false;
+    
+    // keep the counters of cgroups that survive, so their rates carry on
+    std::map<std::string, Node> before;
+    before.swap(nodes);
+    addTree("/", 0);
+    for (auto& entry : nodes) {
+        auto old = before.find(entry.first);
+        if (old == before.end()) continue;
+        int watch = entry.second.watch;
+        entry.second = old->second;
+        entry.second.watch = watch;
+        entry.second.dirty = true;
+    }
+}
+
+void CgroupCollector::addTree(const std::string& path, int depth) {
+    std::string directory = path == "/" ? mountPoint : mountPoint + path;
+    
+    // watch before listing, so a child created in between is not missed;
+    // one already listed is skipped when its event arrives
+    int watch = -1;
+    if (inotifyFd >= 0) {
+        watch = inotify_add_watch(inotifyFd, directory.c_str(), WatchMask);
+        countSyscalls(1);
+        if (watch >= 0) watches[watch] = path;
+        else missingWatches = true;
+    }
+    
+    Node& node = nodes[path];
+    node.stats = CgroupStats();
+    node.stats.path = path;
+    node.stats.depth = depth;
+    node.directory = directory;
+    node.watch = watch;
+    node.dirty = true;
+    
+    DIR* dir = opendir(directory.c_str());
+    countSyscalls(1);
+    if (!dir) return;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') continue;
+        std::string child = path == "/" ? path + entry->d_name : path + "/" + entry->d_name;
+        if (nodes.find(child) == nodes.end()) addTree(child, depth + 1);
+    }
+    closedir(dir);
+    countSyscalls(2);
+}
+
+void CgroupCollector::removeTree(const std::string& path) {
+    auto it = nodes.find(path);
+    if (it == nodes.end()) return;
+    // the kernel drops the watches itself when the directories go
+    if (it->second.watch >= 0) watches.erase(it->second.watch);
+    nodes.erase(it);
+    
+    // descendants are one run from "path/" on; siblings such as "path-x" or
+    // "path.scope" sort between path and that run, so start at the prefix
+    std::string prefix = path + "/";
+    it = nodes.lower_bound(prefix);
+    while (it != nodes.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        if (it->second.watch >= 0) watches.erase(it->second.watch);
+        it = nodes.erase(it);
+    }
+}
+
+void CgroupCollector::relistUnwatched() {
+    // relist() adds and removes nodes, so take the paths first
+    missingWatches = false;
+    std::vector<std::string> paths;
+    for (const auto& entry : nodes) {
+        if (entry.second.watch < 0) paths.push_back(entry.first);
+    }
+    for (const std::string& path : paths) relist(path);
+}
+
+void CgroupCollector::relist(const std::string& path) {
+    auto it = nodes.find(path);
+    if (it == nodes.end()) return;
+    Node& node = it->second;
+    int depth = node.stats.depth;
+    
+    // watches may have been freed since; nothing reports cgroup.events
+    // changes until one is in place, so read it again either way
+    node.dirty = true;
+    node.watch = inotify_add_watch(inotifyFd, node.directory.c_str(), WatchMask);
+    countSyscalls(1);
+    if (node.watch >= 0) watches[node.watch] = path;
+    else missingWatches = true;
+    
+    DIR* dir = opendir(node.directory.c_str());
+    countSyscalls(1);
+    if (!dir) return;
+    std::vector<std::string> present;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') continue;
+        std::string child = path == "/" ? path + entry->d_name : path + "/" + entry->d_name;
+        if (nodes.find(child) == nodes.end()) addTree(child, depth + 1);
+        present.push_back(child);
+    }
+    closedir(dir);
+    countSyscalls(2);
+    
+    // direct children that are no longer listed
+    std::string prefix = path == "/" ? path : path + "/";
+    std::vector<std::string> gone;
+    for (auto child = nodes.lower_bound(prefix);
+         child != nodes.end() && child->first.compare(0, prefix.size(), prefix) == 0; ++child) {
+        if (child->first == path || child->first.find('/', prefix.size()) != std::string::npos) continue;
+        if (std::find(present.begin(), present.end(), child->first) == present.end()) gone.push_back(child->first);
+    }
+    for (const std::string& child : gone) removeTree(child);
+}
+
+void CgroupCollector::drainEvents() {
+    alignas(struct inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        countSyscalls(1, length > 0 ? static_cast<unsigned long long>(length) : 0);
+        if (length <= 0) return;
+        
+        for (char* p = buffer; p < buffer + length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescanNeeded = true;
+                return;
+            }
+            auto watch = watches.find(event->wd);
+            if (watch == watches.end() || event->len == 0) continue;
+            
+            const std::string& parent = watch->second;
+            if ((event->mask & IN_MODIFY) && strcmp(event->name, "cgroup.events") == 0) {
+                auto node = nodes.find(parent);
+                if (node != nodes.end()) node->second.dirty = true;
+                continue;
+            }
+            if (!(event->mask & IN_ISDIR)) continue;
+            std::string child = parent == "/" ? parent + event->name : parent + "/" + event->name;
+            if (event->mask & IN_CREATE) {
+                auto node = nodes.find(parent);
+                if (nodes.find(child) == nodes.end() && node != nodes.end()) {
+                    addTree(child, node->second.stats.depth + 1);
+                }
+            } else if (event->mask & IN_DELETE) {
+                removeTree(child);
+            }
+        }
+    }
+}
+
+bool CgroupCollector::readFile(const Node& node, const char* name) {
+    // runs for five files of every populated cgroup each tick; no allocation
+    char path[PATH_MAX];
+    int length = snprintf(path, sizeof(path), "%s/%s", node.directory.c_str(), name);
+    if (length < 0 || static_cast<size_t>(length) >= sizeof(path)) return false;
+    bool ok = file.open(path) && file.read();
+    if (!ok) file.close();
+    return ok;
+}
+
+void CgroupCollector::readPopulated(Node& node) {
+    node.dirty = false;
+    
+    // the root has no cgroup.events and always holds every process
+    if (node.stats.depth == 0) {
+        node.stats.populated = true;
+        return;
+    }
+    node.stats.populated = false;
+    if (!readFile(node, "cgroup.events")) return;
+    Scanner sc(file.begin(), file.end());
+    if (sc.findLine("populated", 9)) node.stats.populated = sc.parseU64() != 0;
+    file.close();
+}
+
+void CgroupCollector::readCounters(Node& node, double scale) {
+    CgroupStats& stats = node.stats;
+    unsigned long long cpuBefore = stats.cpuUsageUs;
+    unsigned long long readBefore = stats.readBytes;
+    unsigned long long writtenBefore = stats.writtenBytes;
+    bool first = stats.cpuUsageUs == 0 && stats.readBytes == 0 && stats.writtenBytes == 0;
+    
+    // a controller that is not enabled for this cgroup simply has no file
+    if (readFile(node, "cpu.stat")) {
+        Scanner sc(file.begin(), file.end());
+        if (sc.findLine("usage_usec", 10)) stats.cpuUsageUs = sc.parseU64();
+    }
+    stats.memoryCurrent = 0;
+    if (readFile(node, "memory.current")) {
+        Scanner sc(file.begin(), file.end());
+        stats.memoryCurrent = sc.parseU64();
+    }
+    stats.memoryMax = 0;
+    if (readFile(node, "memory.max")) {
+        Scanner sc(file.begin(), file.end());
+        stats.memoryMax = sc.parseU64();
+    }
+    stats.pids = 0;
+    if (readFile(node, "pids.current")) {
+        Scanner sc(file.begin(), file.end());
+        stats.pids = sc.parseU64();
+    }
+    if (readFile(node, "io.stat")) {
+        // "8:0 rbytes=180224 wbytes=0 rios=3 wios=0 dbytes=0 dios=0", per device
+        unsigned long long readBytes = 0;
+        unsigned long long writtenBytes = 0;
+        Scanner sc(file.begin(), file.end());
+        while (!sc.atEnd()) {
+            sc.skipToken();
+            while (true) {
+                sc.skipSpaces();
+                if (sc.atEnd() || *sc.pos == '\n') break;
+                if (sc.consume("rbytes=", 7)) {
+                    readBytes += sc.parseU64();
+                } else if (sc.consume("wbytes=", 7)) {
+                    writtenBytes += sc.parseU64();
+                } else {
+                    sc.skipToken();
+                }
+            }
+            sc.skipLine();
+        }
+        stats.readBytes = readBytes;
+        stats.writtenBytes = writtenBytes;
+    }
+    file.close();
+    
+    if (first || scale == 0.0) {
+        stats.cpuPercent = 0.0;
+        stats.readBytesPerSecond = 0.0;
+        stats.writeBytesPerSecond = 0.0;
+        return;
+    }
+    stats.cpuPercent = counterDelta(cpuBefore, stats.cpuUsageUs) * scale / 10000.0;
+    stats.readBytesPerSecond = counterDelta(readBefore, stats.readBytes) * scale;
+    stats.writeBytesPerSecond = counterDelta(writtenBefore, stats.writtenBytes) * scale;
+}
+
+void CgroupCollector::update(double now) {
+    if (!mountSearched) findMount();
+    if (mountPoint.empty()) return;
+    
+    double elapsed = previousTime > 0.0 ? now - previousTime : 0.0;
+    double scale = elapsed > 0.0 ? 1.0 / elapsed : 0.0;
+    previousTime = now;
+    
+    if (inotifyFd >= 0) drainEvents();
+    if (rescanNeeded || inotifyFd < 0) rescan();
+    else if (missingWatches) relistUnwatched();
+    
+    // assigned in place, so the path strings keep their capacity
+    list.resize(nodes.size());
+    size_t index = 0;
+    reads = 0;
+    for (auto& entry : nodes) {
+        Node& node = entry.second;
+        if (node.dirty) readPopulated(node);
+        
+        // an empty cgroup cannot use cpu or do io; leave it alone
+        if (node.stats.populated) {
+            readCounters(node, scale);
+            reads++;
+        } else {
+            node.stats.cpuPercent = 0.0;
+            node.stats.readBytesPerSecond = 0.0;
+            node.stats.writeBytesPerSecond = 0.0;
+        }
+        list[index++] = node.stats;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef CGROUPSTATS_H
+#define CGROUPSTATS_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "procfile.h"
+
+// one cgroup of the v2 hierarchy with rates over the last interval
+struct CgroupStats {
+    std::string path;                   // "/" for the root, "/system.slice/nginx.service"
+    int depth;                          // 0 for the root
+    bool populated;                     // has processes, here or below
+    unsigned long long cpuUsageUs;      // cpu.stat usage_usec
+    unsigned long long memoryCurrent;   // bytes, memory.current
+    unsigned long long memoryMax;       // bytes, 0 without a limit
+    unsigned long long readBytes;       // io.stat rbytes summed over devices
+    unsigned long long writtenBytes;
+    unsigned long long pids;            // pids.current
+    double cpuPercent;                  // of one cpu, like process cpu %
+    double readBytesPerSecond;
+    double writeBytesPerSecond;
+};
+
+// walks the cgroup v2 hierarchy (the first cgroup2 mount, usually
+// /sys/fs/cgroup). the tree is kept up to date from inotify instead of
+// readdir on every tick: a watch on each cgroup directory reports created and
+// removed children, and the kernel signals a modify on cgroup.events when a
+// cgroup gains or loses its last process. only populated cgroups have their
+// cpu.stat, memory.current, io.stat and pids.current re-read; an empty one
+// keeps its last values with zero rates. without inotify the whole tree is
+// re-listed every update, and so is each directory whose watch could not be
+// added (max_user_watches used up), with the watch retried each time.
+class CgroupCollector {
+public:
+    // the cgroup2 mount is looked up in root's mountinfo and taken below root
+    explicit CgroupCollector(const std::string& root = std::string());
+    ~CgroupCollector();
+    
+    CgroupCollector(const CgroupCollector&) = delete;
+    CgroupCollector& operator=(const CgroupCollector&) = delete;
+    
+    // now is CLOCK_MONOTONIC seconds
+    void update(double now);
+    
+    // false when no cgroup2 filesystem is mounted
+    bool available() const { return !mountPoint.empty(); }
+    
+    // every cgroup, parents before their children
+    const std::vector<CgroupStats>& cgroups() const { return list; }
+    
+    // cgroups read on the last update, out of cgroups().size()
+    size_t lastReads() const { return reads; }
+    
+private:
+    struct Node {
+        CgroupStats stats;
+        std::string directory;          // mount point plus path, built once
+        int watch;
+        bool dirty;                     // re-read cgroup.events
+    };
+    
+    void findMount();
+    void rescan();
+    void addTree(const std::string& path, int depth);
+    void removeTree(const std::string& path);
+    void relistUnwatched();
+    void relist(const std::string& path);
+    void drainEvents();
+    void readPopulated(Node& node);
+    void readCounters(Node& node, double scale);
+    bool readFile(const Node& node, const char* name);
+    
+    std::string root;
+    std::string mountPoint;
+    bool mountSearched;
+    int inotifyFd;
+    bool rescanNeeded;
+    bool missingWatches;                // some directory has no watch
+    
+    // keyed by path below the mount; ordered so parents precede children
+    std::map<std::string, Node> nodes;
+    std::unordered_map<int, std::string> watches;
+    
+    ProcFile file;
+    std::vector<CgroupStats> list;
+    double previousTime;
+    size_t reads;
+};
+
+#endif
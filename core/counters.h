@@ -0,0 +1,16 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+// growth of a kernel counter between two readings. counters are 64-bit on
+// current kernels, but some drivers (and 32-bit kernels) still export 32-bit
+// ones that wrap at 4 GiB. only a counter that was in the top quarter of that
+// range is taken to have wrapped; any other counter going backwards was
+// reset, e.g. a veth or disk re-created under the same name, and everything
+// it shows now is new
+inline unsigned long long counterDelta(unsigned long long before, unsigned long long after) {
+    if (after >= before) return after - before;
+    if (before > 0xc0000000ULL && before <= 0xffffffffULL) return after + (0x100000000ULL - before);
+    return after;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "cpustats.h"
+#include "scanner.h"
+#include <algorithm>
+#include <utility>
+
+CpuCollector::CpuCollector()
+    : primed(false), aggregateBusy(0), aggregateIowait(0), aggregateSteal(0) {
+}
+
+void CpuCollector::Counters::resize(size_t count) {
+    for (std::vector<uint64_t>* field : {&user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal}) {
+        field->resize(count);
+    }
+}
+
+void CpuCollector::update(const ProcFile& stat) {
+    // "cpu" then "cpuN" lines: user nice system idle iowait irq softirq steal guest guest_nice.
+    // fields an older kernel does not have parse as 0
+    Scanner sc(stat.begin(), stat.end());
+    currentIds.clear();
+    size_t count = 0;
+    
+    while (sc.consume("cpu", 3)) {
+        int id = -1;
+        if (!sc.atEnd() && *sc.pos != ' ') id = static_cast<int>(sc.parseU64());
+        
+        if (count >= current.user.size()) current.resize(count + 1);
+        current.user[count] = sc.parseU64();
+        current.nice[count] = sc.parseU64();
+        current.system[count] = sc.parseU64();
+        current.idle[count] = sc.parseU64();
+        current.iowait[count] = sc.parseU64();
+        current.irq[count] = sc.parseU64();
+        current.softirq[count] = sc.parseU64();
+        current.steal[count] = sc.parseU64();
+        
+        if (count > 0) currentIds.push_back(id);
+        count++;
+        sc.skipLine();
+    }
+    
+    busyAll.resize(count);
+    iowaitAll.resize(count);
+    stealAll.resize(count);
+    
+    // a core going offline or online shifts every slot, so start over
+    if (primed && currentIds == previousIds) {
+        computeUsage(previous, current, count, busyAll.data(), iowaitAll.data(), stealAll.data());
+    } else {
+        std::fill(busyAll.begin(), busyAll.end(), 0.0f);
+        std::fill(iowaitAll.begin(), iowaitAll.end(), 0.0f);
+        std::fill(stealAll.begin(), stealAll.end(), 0.0f);
+    }
+    
+    aggregateBusy = count > 0 ? busyAll[0] : 0.0;
+    aggregateIowait = count > 0 ? iowaitAll[0] : 0.0;
+    aggregateSteal = count > 0 ? stealAll[0] : 0.0;
+    
+    size_t cores = count > 0 ? count - 1 : 0;
+    usage.ids.assign(currentIds.begin(), currentIds.end());
+    usage.busy.assign(busyAll.begin() + (count - cores), busyAll.end());
+    usage.iowait.assign(iowaitAll.begin() + (count - cores), iowaitAll.end());
+    usage.steal.assign(stealAll.begin() + (count - cores), stealAll.end());
+    
+    std::swap(previous, current);
+    std::swap(previousIds, currentIds);
+    primed = count > 0;
+}
+
+// counters only ever grow, but a reading can step back (iowait is known to),
+// so every delta saturates at zero. one interval is far below 2^31 ticks even
+// on the aggregate line, so the work is done in 32 bits, which keeps the loop
+// within what plain sse2 can vectorize
+static inline int32_t delta(uint64_t before, uint64_t after) {
+    int32_t change = static_cast<int32_t>(static_cast<uint32_t>(after) - static_cast<uint32_t>(before));
+    return change > 0 ? change : 0;
+}
+
+void CpuCollector::computeUsage(const Counters& before, const Counters& after, size_t count,
+                                float* __restrict busy, float* __restrict iowait, float* __restrict steal) {
+    const uint64_t* __restrict user0 = before.user.data();
+    const uint64_t* __restrict nice0 = before.nice.data();
+    const uint64_t* __restrict system0 = before.system.data();
+    const uint64_t* __restrict idle0 = before.idle.data();
+    const uint64_t* __restrict iowait0 = before.iowait.data();
+    const uint64_t* __restrict irq0 = before.irq.data();
+    const uint64_t* __restrict softirq0 = before.softirq.data();
+    const uint64_t* __restrict steal0 = before.steal.data();
+    const uint64_t* __restrict user1 = after.user.data();
+    const uint64_t* __restrict nice1 = after.nice.data();
+    const uint64_t* __restrict system1 = after.system.data();
+    const uint64_t* __restrict idle1 = after.idle.data();
+    const uint64_t* __restrict iowait1 = after.iowait.data();
+    const uint64_t* __restrict irq1 = after.irq.data();
+    const uint64_t* __restrict softirq1 = after.softirq.data();
+    const uint64_t* __restrict steal1 = after.steal.data();
+    
+    for (size_t i = 0; i < count; i++) {
+        int32_t work = delta(user0[i], user1[i]) + delta(nice0[i], nice1[i]) + delta(system0[i], system1[i]) +
+                       delta(irq0[i], irq1[i]) + delta(softirq0[i], softirq1[i]);
+        int32_t wait = delta(iowait0[i], iowait1[i]);
+        int32_t stolen = delta(steal0[i], steal1[i]);
+        int32_t total = work + wait + stolen + delta(idle0[i], idle1[i]);
+        
+        float scale = 100.0f / static_cast<float>(total > 0 ? total : 1);
+        busy[i] = static_cast<float>(work) * scale;
+        iowait[i] = static_cast<float>(wait) * scale;
+        steal[i] = static_cast<float>(stolen) * scale;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef CPUSTATS_H
+#define CPUSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "procfile.h"
+
+// per-core utilisation over one interval, as percentages of each core's ticks
+struct CoreUsage {
+    std::vector<int> ids;           // N of "cpuN"
+    std::vector<float> busy;        // user + nice + system + irq + softirq
+    std::vector<float> iowait;
+    std::vector<float> steal;       // time a hypervisor ran someone else
+    
+    size_t size() const { return ids.size(); }
+};
+
+// parses the aggregate and every cpuN line of /proc/stat into one array per
+// counter (index 0 is the aggregate line, then one slot per core) and turns
+// two readings into percentages in a single branch-free pass over those
+// arrays, which the compiler can vectorize. guest time is already part of
+// user/nice, so it is not counted twice.
+class CpuCollector {
+public:
+    CpuCollector();
+    
+    // percentages cover the time since the previous update; all zero on the
+    // first call and whenever the set of online cores changes
+    void update(const ProcFile& stat);
+    
+    double busy() const { return aggregateBusy; }
+    double iowait() const { return aggregateIowait; }
+    double steal() const { return aggregateSteal; }
+    
+    const CoreUsage& cores() const { return usage; }
+    
+private:
+    struct Counters {
+        std::vector<uint64_t> user, nice, system, idle, iowait, irq, softirq, steal;
+        
+        void resize(size_t count);
+    };
+    
+    static void computeUsage(const Counters& before, const Counters& after, size_t count,
+                             float* __restrict busy, float* __restrict iowait, float* __restrict steal);
+    
+    Counters previous;
+    Counters current;
+    std::vector<int> previousIds;
+    std::vector<int> currentIds;
+    bool primed;
+    
+    std::vector<float> busyAll;
+    std::vector<float> iowaitAll;
+    std::vector<float> stealAll;
+    
+    double aggregateBusy;
+    double aggregateIowait;
+    double aggregateSteal;
+    CoreUsage usage;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "decimate.h"
+#include <cmath>
+
+void decimateLTTB(const HistoryTier& tier, size_t first, size_t count, size_t threshold,
+                  std::vector<ChartPoint>& out) {
+    out.clear();
+    if (count == 0) return;
+    
+    if (threshold < 3 || count <= threshold) {
+        for (size_t i = first; i < first + count; i++) {
+            out.push_back({tier.timeAt(i), tier.avgAt(i)});
+        }
+        return;
+    }
+    
+    // first and last points are always kept; the rest is split into threshold - 2 buckets
+    double bucketSize = static_cast<double>(count - 2) / (threshold - 2);
+    size_t last = first + count - 1;
+    
+    size_t selected = first;
+    out.push_back({tier.timeAt(first), tier.avgAt(first)});
+    
+    for (size_t bucket = 0; bucket < threshold - 2; bucket++) {
+        size_t start = first + 1 + static_cast<size_t>(std::floor(bucket * bucketSize));
+        size_t end = first + 1 + static_cast<size_t>(std::floor((bucket + 1) * bucketSize));
+        if (end > last) end = last;
+        
+        // average of the next bucket is the third triangle vertex
+        size_t nextStart = end;
+        size_t nextEnd = first + 1 + static_cast<size_t>(std::floor((bucket + 2) * bucketSize));
+        if (nextEnd > last + 1) nextEnd = last + 1;
+        if (nextStart >= nextEnd) nextStart = nextEnd - 1;
+        
+        double avgX = 0.0, avgY = 0.0;
+        for (size_t i = nextStart; i < nextEnd; i++) {
+            avgX += tier.timeAt(i);
+            avgY += tier.avgAt(i);
+        }
+        avgX /= (nextEnd - nextStart);
+        avgY /= (nextEnd - nextStart);
+        
+        double ax = tier.timeAt(selected);
+        double ay = tier.avgAt(selected);
+        
+        double bestArea = -1.0;
+        size_t best = start;
+        for (size_t i = start; i < end; i++) {
+            double area = std::fabs((ax - avgX) * (tier.avgAt(i) - ay) - (ax - tier.timeAt(i)) * (avgY - ay));
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+        
+        selected = best;
+        out.push_back({tier.timeAt(best), tier.avgAt(best)});
+    }
+    
+    out.push_back({tier.timeAt(last), tier.avgAt(last)});
+}
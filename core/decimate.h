@@ -0,0 +1,19 @@
+#ifndef DECIMATE_H
+#define DECIMATE_H
+
+#include <cstddef>
+#include <vector>
+#include "metrichistory.h"
+
+struct ChartPoint {
+    double x;
+    double y;
+};
+
+// largest-triangle-three-buckets: reduce points [first, first + count) of a
+// tier's averages to at most threshold points that keep the visual shape.
+// out is cleared and refilled; its capacity is reused between calls.
+void decimateLTTB(const HistoryTier& tier, size_t first, size_t count, size_t threshold,
+                  std::vector<ChartPoint>& out);
+
+#endif
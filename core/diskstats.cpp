@@ -0,0 +1,294 @@
+#include "diskstats.h"
+#include "counters.h"
+#include "scanner.h"
+#include "selfstats.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#include <utility>
+
+// /proc/diskstats counts 512-byte sectors whatever the device's block size
+static const unsigned long long SectorBytes = 512;
+
+DiskCollector::DiskCollector(const std::string& rootPath) : previousTime(0.0), root(rootPath), mountsParsed(false) {
+    mountinfo.open((root + "/proc/self/mountinfo").c_str());
+}
+
+bool DiskCollector::isWholeDisk(const std::string& name) {
+    // partitions have no /sys/block entry of their own
+    if (name.compare(0, 4, "loop") == 0 || name.compare(0, 3, "ram") == 0) return false;
+    std::string path = root + "/sys/block/" + name;
+    countSyscalls(1);
+    return access(path.c_str(), F_OK) == 0;
+}
+
+const DeviceStats* DiskCollector::findPrevious(const std::string& name, size_t hint) const {
+    if (hint < previous.size() && previous[hint].name == name) return &previous[hint];
+    for (const DeviceStats& entry : previous) {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+void DiskCollector::update(const ProcFile& diskstats, double now) {
+    double elapsed = previousTime > 0.0 ? now - previousTime : 0.0;
+    double scale = elapsed > 0.0 ? 1.0 / elapsed : 0.0;
+    
+    // same double buffering as NetCollector: no allocation for a steady device list
+    std::swap(previous, current);
+    
+    Scanner sc(diskstats.begin(), diskstats.end());
+    size_t count = 0;
+    std::string name;
+    while (!sc.atEnd()) {
+        // major minor name, then: reads merged sectors ms, writes merged sectors ms,
+        // in-flight, io ms, weighted io ms, and discard/flush fields on newer kernels
+        sc.parseU64();
+        sc.parseU64();
+        sc.skipSpaces();
+        const char* start = sc.pos;
+        sc.skipToken();
+        name.assign(start, sc.pos - start);
+        if (name.empty()) break;
+        
+        if (std::find(ignored.begin(), ignored.end(), name) != ignored.end()) {
+            sc.skipLine();
+            continue;
+        }
+        const DeviceStats* before = findPrevious(name, count);
+        if (!before && !isWholeDisk(name)) {
+            ignored.push_back(name);
+            sc.skipLine();
+            continue;
+        }
+        
+        if (count >= current.size()) current.emplace_back();
+        DeviceStats& entry = current[count];
+        entry.name = name;
+        entry.reads = sc.parseU64();
+        sc.skipToken();
+        entry.readBytes = sc.parseU64() * SectorBytes;
+        entry.readMs = sc.parseU64();
+        entry.writes = sc.parseU64();
+        sc.skipToken();
+        entry.writtenBytes = sc.parseU64() * SectorBytes;
+        entry.writeMs = sc.parseU64();
+        sc.skipToken();
+        entry.ioMs = sc.parseU64();
+        entry.queueMs = sc.parseU64();
+        sc.skipLine();
+        
+        if (before && elapsed > 0.0) {
+            unsigned long long reads = counterDelta(before->reads, entry.reads);
+            unsigned long long writes = counterDelta(before->writes, entry.writes);
+            unsigned long long waited = counterDelta(before->readMs, entry.readMs) +
+                                        counterDelta(before->writeMs, entry.writeMs);
+            double elapsedMs = elapsed * 1000.0;
+            
+            entry.readsPerSecond = reads * scale;
+            entry.writesPerSecond = writes * scale;
+            // the kernel counts sectors, so a 32-bit counter wraps in sectors, not bytes
+            entry.readBytesPerSecond = counterDelta(before->readBytes / SectorBytes, entry.readBytes / SectorBytes) *
+                                       SectorBytes * scale;
+            entry.writeBytesPerSecond =
+                counterDelta(before->writtenBytes / SectorBytes, entry.writtenBytes / SectorBytes) * SectorBytes * scale;
+            entry.queueDepth = counterDelta(before->queueMs, entry.queueMs) / elapsedMs;
+            entry.awaitMs = reads + writes > 0 ? static_cast<double>(waited) / (reads + writes) : 0.0;
+            entry.utilization = std::min(100.0, counterDelta(before->ioMs, entry.ioMs) * 100.0 / elapsedMs);
+        } else {
+            entry.readsPerSecond = 0.0;
+            entry.writesPerSecond = 0.0;
+            entry.readBytesPerSecond = 0.0;
+            entry.writeBytesPerSecond = 0.0;
+            entry.queueDepth = 0.0;
+            entry.awaitMs = 0.0;
+            entry.utilization = 0.0;
+        }
+        count++;
+    }
+    current.resize(count);
+    previousTime = now;
+}
+
+bool DiskCollector::mountsChanged() {
+    // the kernel flags POLLPRI (and POLLERR) on mountinfo whenever the mount
+    // table of this namespace changes; polling clears the flag again
+    struct pollfd watch = {};
+    watch.fd = mountinfo.descriptor();
+    watch.events = POLLPRI;
+    countSyscalls(1);
+    return poll(&watch, 1, 0) > 0 && (watch.revents & (POLLPRI | POLLERR)) != 0;
+}
+
+// mountinfo escapes space, tab, newline and backslash as \ooo
+static void unescape(std::string& text) {
+    size_t out = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\\' && i + 3 < text.size()) {
+            int value = 0;
+            bool octal = true;
+            for (size_t k = 1; k <= 3; k++) {
+                char c = text[i + k];
+                if (c < '0' || c > '7') octal = false;
+                value = value * 8 + (c - '0');
+            }
+            if (octal) {
+                text[out++] = static_cast<char>(value);
+                i += 3;
+                continue;
+            }
+        }
+        text[out++] = text[i];
+    }
+    text.resize(out);
+}
+
+// one mountinfo line of a filesystem we may list
+struct MountCandidate {
+    unsigned long long major;
+    unsigned long long minor;
+    std::string root;                   // of the filesystem, as mounted here
+    std::string point;
+    std::string source;
+    std::string type;
+    std::string subvolume;              // btrfs subvol= option, empty elsewhere
+};
+
+// true when path is below directory, which is a mountinfo root
+static bool isBelow(const std::string& path, const std::string& directory) {
+    if (directory == "/") return path != "/";
+    return path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 &&
+           path[directory.size()] == '/';
+}
+
+// a bind mount of a directory that another listed mount already shows
+static bool isBindMount(const std::vector<MountCandidate>& candidates, size_t index) {
+    const MountCandidate& mount = candidates[index];
+    
+    // btrfs subvolumes share one anonymous device and may nest by path, so
+    // there only a root other than the mounted subvolume makes a bind mount
+    bool subvolume = !mount.subvolume.empty();
+    if (subvolume && mount.root != mount.subvolume) return true;
+    
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const MountCandidate& other = candidates[i];
+        if (i == index || other.major != mount.major || other.minor != mount.minor) continue;
+        if (!subvolume && isBelow(mount.root, other.root)) return true;
+        // the same tree mounted twice: keep the shortest mount point, then the first
+        if (other.root == mount.root &&
+            (other.point.size() < mount.point.size() || (other.point.size() == mount.point.size() && i < index))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DiskCollector::parseMounts() {
+    mountList.clear();
+    statPaths.clear();
+    if (!mountinfo.read()) return;
+    
+    // id parent major:minor root mountpoint options [optional fields...] - fstype source superoptions
+    std::vector<MountCandidate> candidates;
+    Scanner sc(mountinfo.begin(), mountinfo.end());
+    while (!sc.atEnd()) {
+        const char* lineEnd = static_cast<const char*>(memchr(sc.pos, '\n', sc.end - sc.pos));
+        if (!lineEnd) lineEnd = sc.end;
+        
+        MountCandidate mount;
+        sc.skipTokens(2);
+        mount.major = sc.parseU64();
+        sc.consume(":", 1);
+        mount.minor = sc.parseU64();
+        sc.skipSpaces();
+        const char* rootStart = sc.pos;
+        sc.skipToken();
+        mount.root.assign(rootStart, sc.pos - rootStart);
+        sc.skipSpaces();
+        const char* pointStart = sc.pos;
+        sc.skipToken();
+        mount.point.assign(pointStart, sc.pos - pointStart);
+        
+        // the optional fields end at a lone "-"
+        const char* separator = pointStart;
+        while (separator + 2 < lineEnd && !(separator[0] == ' ' && separator[1] == '-' && separator[2] == ' ')) {
+            separator++;
+        }
+        if (separator + 2 >= lineEnd) {
+            sc.pos = lineEnd < sc.end ? lineEnd + 1 : sc.end;
+            continue;
+        }
+        sc.pos = separator + 2;
+        sc.skipSpaces();
+        const char* typeStart = sc.pos;
+        sc.skipToken();
+        mount.type.assign(typeStart, sc.pos - typeStart);
+        sc.skipSpaces();
+        const char* sourceStart = sc.pos;
+        sc.skipToken();
+        mount.source.assign(sourceStart, sc.pos - sourceStart);
+        sc.skipSpaces();
+        const char* optionsStart = sc.pos;
+        sc.skipToken();
+        if (mount.type == "btrfs") {
+            const char* options = optionsStart;
+            const char* optionsEnd = sc.pos;
+            while (options < optionsEnd) {
+                const char* comma = static_cast<const char*>(memchr(options, ',', optionsEnd - options));
+                if (!comma) comma = optionsEnd;
+                if (comma - options > 7 && memcmp(options, "subvol=", 7) == 0) {
+                    mount.subvolume.assign(options + 7, comma - options - 7);
+                }
+                options = comma + 1;
+            }
+        }
+        sc.pos = lineEnd < sc.end ? lineEnd + 1 : sc.end;
+        
+        // block-backed filesystems (and zfs datasets)
+        bool blockDevice = mount.source.compare(0, 5, "/dev/") == 0 && mount.source.compare(0, 9, "/dev/loop") != 0;
+        if ((!blockDevice && mount.type != "zfs") || mount.type == "squashfs") continue;
+        candidates.push_back(std::move(mount));
+    }
+    
+    // each filesystem tree once; the root need not be "/", since btrfs
+    // subvolumes and container bind mounts are mounted from elsewhere
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (isBindMount(candidates, i)) continue;
+        const MountCandidate& mount = candidates[i];
+        MountUsage usage = {};
+        usage.mountPoint = mount.point;
+        unescape(usage.mountPoint);
+        usage.device = mount.source;
+        usage.fsType = mount.type;
+        mountList.push_back(usage);
+        statPaths.push_back(root + usage.mountPoint);
+    }
+    mountsParsed = true;
+}
+
+void DiskCollector::updateMounts() {
+    if (!mountsParsed || mountsChanged()) parseMounts();
+    
+    for (size_t i = 0; i < mountList.size(); i++) {
+        MountUsage& usage = mountList[i];
+        struct statvfs stat;
+        countSyscalls(1);
+        if (statvfs(statPaths[i].c_str(), &stat) != 0 || stat.f_blocks == 0) {
+            usage.total = 0;
+            usage.used = 0;
+            usage.available = 0;
+            usage.percent = 0.0;
+            continue;
+        }
+        usage.total = static_cast<unsigned long long>(stat.f_blocks) * stat.f_frsize;
+        usage.available = static_cast<unsigned long long>(stat.f_bavail) * stat.f_frsize;
+        
+        // same definition as the root filesystem in SystemStats: space root
+        // keeps in reserve counts as used
+        usage.used = usage.total - usage.available;
+        usage.percent = 100.0 * usage.used / usage.total;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef DISKSTATS_H
+#define DISKSTATS_H
+
+#include <string>
+#include <vector>
+#include "procfile.h"
+
+// one whole-disk line of /proc/diskstats plus rates over the last interval
+struct DeviceStats {
+    std::string name;
+    unsigned long long reads;           // completed
+    unsigned long long writes;
+    unsigned long long readBytes;
+    unsigned long long writtenBytes;
+    unsigned long long readMs;          // time spent on completed reads
+    unsigned long long writeMs;
+    unsigned long long ioMs;            // time with at least one request in flight
+    unsigned long long queueMs;         // in-flight time weighted by queue length
+    double readsPerSecond;
+    double writesPerSecond;
+    double readBytesPerSecond;
+    double writeBytesPerSecond;
+    double queueDepth;                  // average requests in flight
+    double awaitMs;                     // average time per completed request
+    double utilization;                 // % of the interval with io in flight
+};
+
+// space on one mounted filesystem
+struct MountUsage {
+    std::string mountPoint;
+    std::string device;
+    std::string fsType;
+    unsigned long long total;           // bytes
+    unsigned long long used;
+    unsigned long long available;       // to unprivileged users
+    double percent;
+};
+
+// per-device io from /proc/diskstats and usage of every block-backed mount.
+// the mount table is only re-parsed when poll() on /proc/self/mountinfo
+// reports a change; each tick just statvfs()es the mounts already known.
+// loop and ram devices, partitions and network filesystems are left out
+// (statvfs on an unreachable nfs server blocks).
+class DiskCollector {
+public:
+    // mountinfo and /sys/block are read below root, and mounts are
+    // statvfs()ed there
+    explicit DiskCollector(const std::string& root = std::string());
+    
+    // now is CLOCK_MONOTONIC seconds at which diskstats was read
+    void update(const ProcFile& diskstats, double now);
+    
+    // refresh the usage of every mount
+    void updateMounts();
+    
+    const std::vector<DeviceStats>& devices() const { return current; }
+    const std::vector<MountUsage>& mounts() const { return mountList; }
+    
+private:
+    bool isWholeDisk(const std::string& name);
+    const DeviceStats* findPrevious(const std::string& name, size_t hint) const;
+    bool mountsChanged();
+    void parseMounts();
+    
+    std::vector<DeviceStats> current;
+    std::vector<DeviceStats> previous;
+    double previousTime;
+    
+    // names seen in /proc/diskstats that are not whole disks, so /sys is
+    // only asked once about each
+    std::vector<std::string> ignored;
+    
+    std::string root;
+    ProcFile mountinfo;
+    bool mountsParsed;
+    std::vector<MountUsage> mountList;
+    std::vector<std::string> statPaths; // root + mount point, one per mountList entry
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "fastsampler.h"
+#include "scanner.h"
+#include <algorithm>
+#include <ctime>
+
+void FastSampler::Accumulator::reset() {
+    min = 0.0;
+    max = 0.0;
+    sum = 0.0;
+}
+
+void FastSampler::Accumulator::add(double value, bool first) {
+    if (first) {
+        min = value;
+        max = value;
+    } else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    sum += value;
+}
+
+MetricSummary FastSampler::Accumulator::summary(unsigned samples) const {
+    MetricSummary out = {};
+    if (samples == 0) return out;
+    out.min = min;
+    out.max = max;
+    out.mean = sum / samples;
+    return out;
+}
+
+FastSampler::FastSampler() : stopping(false), primed(false) {
+    stat.open("/proc/stat");
+    meminfo.open("/proc/meminfo");
+    netDev.open("/proc/net/dev");
+    reset();
+    missedTotal = 0;
+    period = 0.0;
+}
+
+FastSampler::~FastSampler() {
+    stop();
+}
+
+void FastSampler::reset() {
+    count = 0;
+    cpuUsage.reset();
+    memoryUsage.reset();
+    rxRate.reset();
+    txRate.reset();
+    missed = 0;
+    latenessSum = 0.0;
+    latenessMax = 0.0;
+}
+
+bool FastSampler::start(int periodMs) {
+    stop();
+    if (periodMs < MinPeriodMs) periodMs = MinPeriodMs;
+    if (periodMs > MaxPeriodMs) periodMs = MaxPeriodMs;
+    if (!ticker.start(periodMs * 1000000LL)) return false;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reset();
+        period = periodMs;
+    }
+    primed = false;
+    stopping.store(false);
+    thread = std::thread(&FastSampler::run, this);
+    return true;
+}
+
+void FastSampler::stop() {
+    if (!thread.joinable()) return;
+    stopping.store(true);
+    ticker.interrupt();
+    thread.join();
+    ticker.stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    period = 0.0;
+}
+
+void FastSampler::run() {
+    while (!stopping.load()) {
+        // false after stop(), or when the timer cannot be polled; waiting
+        // again would return at once and spin
+        if (!ticker.wait()) break;
+        
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        sample(now.tv_sec + now.tv_nsec / 1e9);
+    }
+}
+
+void FastSampler::sample(double now) {
+    stat.read();
+    meminfo.read();
+    netDev.read();
+    cpu.update(stat);
+    network.update(netDev, now);
+    
+    unsigned long long memTotal = 0;
+    unsigned long long memAvailable = 0;
+    Scanner sc(meminfo.begin(), meminfo.end());
+    if (sc.findLine("MemTotal:", 9)) memTotal = sc.parseU64();
+    if (sc.findLine("MemAvailable:", 13)) memAvailable = sc.parseU64();
+    double memory = memTotal > 0 ? 100.0 * (memTotal - memAvailable) / memTotal : 0.0;
+    
+    // rates need two readings
+    if (!primed) {
+        primed = true;
+        return;
+    }
+    
+    const InterfaceStats& total = network.total();
+    std::lock_guard<std::mutex> lock(mutex);
+    bool first = count++ == 0;
+    cpuUsage.add(cpu.busy(), first);
+    memoryUsage.add(memory, first);
+    rxRate.add(total.rxRate, first);
+    txRate.add(total.txRate, first);
+    missed += ticker.missed();
+    missedTotal += ticker.missed();
+    latenessSum += ticker.lateness();
+    latenessMax = std::max(latenessMax, ticker.lateness());
+}
+
+void FastSampler::take(FastStats& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.samples = count;
+    out.periodMs = period;
+    out.cpu = cpuUsage.summary(count);
+    out.memory = memoryUsage.summary(count);
+    out.netRx = rxRate.summary(count);
+    out.netTx = txRate.summary(count);
+    out.missed = missed;
+    out.missedTotal = missedTotal;
+    out.jitterMeanMs = count > 0 ? latenessSum / count * 1000.0 : 0.0;
+    out.jitterMaxMs = latenessMax * 1000.0;
+    reset();
+}
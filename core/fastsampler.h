@@ -0,0 +1,101 @@
+#ifndef FASTSAMPLER_H
+#define FASTSAMPLER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "cpustats.h"
+#include "netstats.h"
+#include "procfile.h"
+#include "ticker.h"
+
+struct MetricSummary {
+    double min;
+    double max;
+    double mean;
+};
+
+// what the fast sampler saw between two display samples
+struct FastStats {
+    unsigned samples;                   // 0 when fast sampling is off
+    double periodMs;
+    MetricSummary cpu;                  // busy %
+    MetricSummary memory;               // used %
+    MetricSummary netRx;                // bytes per second, non-loopback sum
+    MetricSummary netTx;
+    unsigned long long missed;          // ticks lost to a late wakeup
+    unsigned long long missedTotal;     // since start()
+    double jitterMeanMs;                // wakeup after the deadline
+    double jitterMaxMs;
+};
+
+// samples the cheap system-wide metrics (cpu from /proc/stat, memory from
+// /proc/meminfo, network from /proc/net/dev) every 10-100 ms on a thread of
+// its own, driven by a Ticker, and folds them into min/max/mean until the
+// display side takes the summary. the slow /proc/<pid> walk never delays it.
+// cpu time in /proc/stat has USER_HZ (10 ms) resolution, so a single-core
+// burst shorter than that shows up as 0 or 100%.
+class FastSampler {
+public:
+    FastSampler();
+    ~FastSampler();
+    
+    FastSampler(const FastSampler&) = delete;
+    FastSampler& operator=(const FastSampler&) = delete;
+    
+    // periodMs is clamped to 10-100; restarts a running sampler
+    bool start(int periodMs);
+    void stop();
+    bool running() const { return thread.joinable(); }
+    
+    // summary since the previous take(), which starts a new one
+    void take(FastStats& out);
+    
+    const std::string& error() const { return ticker.error(); }
+    
+    static const int MinPeriodMs = 10;
+    static const int MaxPeriodMs = 100;
+    
+private:
+    struct Accumulator {
+        double min;
+        double max;
+        double sum;
+        
+        void reset();
+        void add(double value, bool first);
+        MetricSummary summary(unsigned count) const;
+    };
+    
+    void run();
+    void sample(double now);
+    void reset();
+    
+    Ticker ticker;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    
+    // sampler thread only
+    ProcFile stat;
+    ProcFile meminfo;
+    ProcFile netDev;
+    CpuCollector cpu;
+    NetCollector network;
+    bool primed;
+    
+    // guarded by mutex
+    std::mutex mutex;
+    double period;                      // ms, 0 while stopped
+    unsigned count;
+    Accumulator cpuUsage;
+    Accumulator memoryUsage;
+    Accumulator rxRate;
+    Accumulator txRate;
+    unsigned long long missed;
+    unsigned long long missedTotal;
+    double latenessSum;
+    double latenessMax;
+};
+
+#endif
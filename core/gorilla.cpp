@@ -0,0 +1,138 @@
+#include "gorilla.h"
+#include <cstring>
+
+static uint64_t doubleBits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bitsDouble(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// signed value in `bits` bits, two's complement
+static int64_t signExtend(uint64_t value, int bits) {
+    uint64_t sign = 1ULL << (bits - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+void DeltaEncoder::append(BitWriter& out, int64_t value) {
+    if (count == 0) {
+        out.writeBits(static_cast<uint64_t>(value), 64);
+    } else {
+        int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(previous));
+        int64_t dod = static_cast<int64_t>(static_cast<uint64_t>(delta) - static_cast<uint64_t>(previousDelta));
+        
+        if (dod == 0) {
+            out.writeBit(0);
+        } else if (dod >= -64 && dod <= 63) {
+            out.writeBits(0x2, 2);
+            out.writeBits(static_cast<uint64_t>(dod), 7);
+        } else if (dod >= -256 && dod <= 255) {
+            out.writeBits(0x6, 3);
+            out.writeBits(static_cast<uint64_t>(dod), 9);
+        } else if (dod >= -2048 && dod <= 2047) {
+            out.writeBits(0xe, 4);
+            out.writeBits(static_cast<uint64_t>(dod), 12);
+        } else if (dod >= INT32_MIN && dod <= INT32_MAX) {
+            out.writeBits(0x1e, 5);
+            out.writeBits(static_cast<uint64_t>(dod), 32);
+        } else {
+            out.writeBits(0x1f, 5);
+            out.writeBits(zigzag(dod), 64);
+        }
+        previousDelta = delta;
+    }
+    previous = value;
+    count++;
+}
+
+int64_t DeltaDecoder::next(BitReader& in) {
+    if (count == 0) {
+        previous = static_cast<int64_t>(in.readBits(64));
+    } else {
+        int64_t dod;
+        if (!in.readBit()) {
+            dod = 0;
+        } else if (!in.readBit()) {
+            dod = signExtend(in.readBits(7), 7);
+        } else if (!in.readBit()) {
+            dod = signExtend(in.readBits(9), 9);
+        } else if (!in.readBit()) {
+            dod = signExtend(in.readBits(12), 12);
+        } else if (!in.readBit()) {
+            dod = signExtend(in.readBits(32), 32);
+        } else {
+            dod = unzigzag(in.readBits(64));
+        }
+
+        previousDelta = static_cast<int64_t>(static_cast<uint64_t>(previousDelta) + static_cast<uint64_t>(dod));
+        previous = static_cast<int64_t>(static_cast<uint64_t>(previous) + static_cast<uint64_t>(previousDelta));
+    }
+    count++;
+    return previous;
+}
+
+void XorEncoder::append(BitWriter& out, double value) {
+    uint64_t bits = doubleBits(value);
+    
+    if (count == 0) {
+        out.writeBits(bits, 64);
+    } else {
+        uint64_t x = bits ^ previous;
+        if (x == 0) {
+            out.writeBit(0);
+        } else {
+            out.writeBit(1);
+            int lead = __builtin_clzll(x);
+            int trail = __builtin_ctzll(x);
+            if (lead > 31) lead = 31;
+            
+            if (leading != 0xff && lead >= leading && trail >= trailing) {
+                // fits inside the previous meaningful window
+                out.writeBit(0);
+                out.writeBits(x >> trailing, 64 - leading - trailing);
+            } else {
+                int meaningful = 64 - lead - trail;
+                out.writeBit(1);
+                out.writeBits(static_cast<uint64_t>(lead), 5);
+                // 64 meaningful bits does not fit in 6 bits; store it as 0
+                out.writeBits(static_cast<uint64_t>(meaningful & 63), 6);
+                out.writeBits(x >> trail, meaningful);
+                leading = lead;
+                trailing = trail;
+            }
+        }
+    }
+    previous = bits;
+    count++;
+}
+
+double XorDecoder::next(BitReader& in) {
+    if (count == 0) {
+        previous = in.readBits(64);
+    } else if (in.readBit()) {
+        if (in.readBit()) {
+            leading = static_cast<int>(in.readBits(5));
+            int meaningful = static_cast<int>(in.readBits(6));
+            if (meaningful == 0) meaningful = 64;
+            trailing = 64 - leading - meaningful;
+        }
+        int meaningful = 64 - leading - trailing;
+        uint64_t x = in.readBits(meaningful) << trailing;
+        previous ^= x;
+    }
+    count++;
+    return bitsDouble(previous);
+}
@@ -0,0 +1,60 @@
+#ifndef GORILLA_H
+#define GORILLA_H
+
+#include <cstdint>
+#include "bitstream.h"
+
+// Gorilla-style column codecs (Pelkonen et al., VLDB 2015).
+// integers (timestamps, counters) are stored as delta-of-delta with
+// variable-width buckets; doubles as the XOR with the previous value,
+// reusing the previous leading/trailing zero window when it fits.
+
+class DeltaEncoder {
+public:
+    DeltaEncoder() { reset(); }
+    void reset() { count = 0; previous = 0; previousDelta = 0; }
+    void append(BitWriter& out, int64_t value);
+    
+private:
+    size_t count;
+    int64_t previous;
+    int64_t previousDelta;
+};
+
+class DeltaDecoder {
+public:
+    DeltaDecoder() : count(0), previous(0), previousDelta(0) {}
+    int64_t next(BitReader& in);
+    
+private:
+    size_t count;
+    int64_t previous;
+    int64_t previousDelta;
+};
+
+class XorEncoder {
+public:
+    XorEncoder() { reset(); }
+    void reset() { count = 0; previous = 0; leading = 0xff; trailing = 0; }
+    void append(BitWriter& out, double value);
+    
+private:
+    size_t count;
+    uint64_t previous;
+    int leading;
+    int trailing;
+};
+
+class XorDecoder {
+public:
+    XorDecoder() : count(0), previous(0), leading(0), trailing(0) {}
+    double next(BitReader& in);
+    
+private:
+    size_t count;
+    uint64_t previous;
+    int leading;
+    int trailing;
+};
+
+#endif
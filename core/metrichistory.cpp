@@ -0,0 +1,96 @@
+#include "metrichistory.h"
+#include <cmath>
+
+HistoryTier::HistoryTier(double bucketSeconds, size_t capacity)
+    : bucket(bucketSeconds), times(capacity), mins(capacity), avgs(capacity), maxs(capacity),
+      head(0), count(0) {
+}
+
+void HistoryTier::push(double time, double min, double avg, double max) {
+    if (times.empty()) return;
+    
+    size_t s;
+    if (count < times.size()) {
+        s = slot(count);
+        count++;
+    } else {
+        // full: overwrite the oldest point
+        s = head;
+        head = head + 1 == times.size() ? 0 : head + 1;
+    }
+    
+    times[s] = time;
+    mins[s] = min;
+    avgs[s] = avg;
+    maxs[s] = max;
+}
+
+size_t HistoryTier::lowerBound(double time) const {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (timeAt(middle) < time) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+void HistoryTier::clear() {
+    head = 0;
+    count = 0;
+}
+
+MetricHistory::MetricHistory(size_t rawCapacity, size_t minuteCapacity, size_t hourCapacity) {
+    tiers.emplace_back(0.0, rawCapacity);
+    tiers.emplace_back(60.0, minuteCapacity);
+    tiers.emplace_back(3600.0, hourCapacity);
+    clear();
+}
+
+void MetricHistory::clear() {
+    for (HistoryTier& tier : tiers) tier.clear();
+    for (Pending& p : pending) p = {0.0, 0.0, 0.0, 0.0, 0};
+}
+
+void MetricHistory::append(double time, double value) {
+    tiers[Raw].push(time, value, value, value);
+    
+    for (int level = Minute; level < LevelCount; level++) {
+        Pending& p = pending[level];
+        double start = std::floor(time / tiers[level].bucketSeconds()) * tiers[level].bucketSeconds();
+        
+        if (p.count > 0 && start != p.start) flush(static_cast<Level>(level));
+        
+        if (p.count == 0) {
+            p = {start, value, value, 0.0, 0};
+        }
+        if (value < p.min) p.min = value;
+        if (value > p.max) p.max = value;
+        p.sum += value;
+        p.count++;
+    }
+}
+
+void MetricHistory::flush(Level level) {
+    Pending& p = pending[level];
+    tiers[level].push(p.start, p.min, p.sum / p.count, p.max);
+    p.count = 0;
+}
+
+MetricHistory::Level MetricHistory::levelFor(double seconds) const {
+    Level coarsest = Raw;
+    for (int level = Raw; level < LevelCount; level++) {
+        const HistoryTier& tier = tiers[level];
+        
+        // a history built without its coarse tiers stops at the last one it has
+        if (tier.capacity() == 0) break;
+        coarsest = static_cast<Level>(level);
+        
+        // a tier that has not wrapped yet still holds everything since the first sample
+        if (tier.size() < tier.capacity()) return coarsest;
+        
+        double span = tier.timeAt(tier.size() - 1) - tier.timeAt(0);
+        if (span >= seconds) return coarsest;
+    }
+    return coarsest;
+}
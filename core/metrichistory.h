@@ -0,0 +1,86 @@
+#ifndef METRICHISTORY_H
+#define METRICHISTORY_H
+
+#include <cstddef>
+#include <vector>
+
+// fixed-capacity ring of (time, min, avg, max) points stored as separate
+// arrays. index 0 is the oldest point still held.
+class HistoryTier {
+public:
+    HistoryTier(double bucketSeconds, size_t capacity);
+    
+    double bucketSeconds() const { return bucket; }
+    size_t capacity() const { return times.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    double timeAt(size_t i) const { return times[slot(i)]; }
+    double minAt(size_t i) const { return mins[slot(i)]; }
+    double avgAt(size_t i) const { return avgs[slot(i)]; }
+    double maxAt(size_t i) const { return maxs[slot(i)]; }
+    
+    // index of the first point at or after time
+    size_t lowerBound(double time) const;
+    
+    void push(double time, double min, double avg, double max);
+    void clear();
+    
+private:
+    size_t slot(size_t i) const {
+        size_t s = head + i;
+        return s >= times.size() ? s - times.size() : s;
+    }
+    
+    double bucket;
+    std::vector<double> times;
+    std::vector<double> mins;
+    std::vector<double> avgs;
+    std::vector<double> maxs;
+    size_t head;
+    size_t count;
+};
+
+// bounded history of one metric. every sample lands in the raw tier and is
+// rolled up into 1 minute and 1 hour buckets (min/avg/max), so memory stays
+// fixed while still covering long ranges: by default an hour of raw samples,
+// a day of minutes and a month of hours. a coarse bucket shows up in its
+// tier once the first sample of the next bucket arrives.
+class MetricHistory {
+public:
+    enum Level {
+        Raw,
+        Minute,
+        Hour,
+        LevelCount
+    };
+    
+    explicit MetricHistory(size_t rawCapacity = 3600, size_t minuteCapacity = 1440,
+                           size_t hourCapacity = 720);
+    
+    // time in seconds; samples must arrive in time order
+    void append(double time, double value);
+    void clear();
+    
+    const HistoryTier& tier(Level level) const { return tiers[level]; }
+    
+    // finest tier whose retained span covers the requested window
+    Level levelFor(double seconds) const;
+    
+private:
+    // the bucket currently being filled for one coarse tier
+    struct Pending {
+        double start;
+        double min;
+        double max;
+        double sum;
+        size_t count;
+    };
+    
+    void flush(Level level);
+    
+    std::vector<HistoryTier> tiers;
+    Pending pending[LevelCount];
+};
+
+#endif
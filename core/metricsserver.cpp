@@ -0,0 +1,289 @@
+#include "metricsserver.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// a scraper that has not finished its request by then is dropped
+static const int IdleSeconds = 10;
+static const size_t MaxConnections = 1024;
+
+static std::shared_ptr<const std::string> response(const char* status, const std::string& body) {
+    std::string text = std::string("HTTP/1.1 ") + status + "\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n" + body;
+    return std::make_shared<const std::string>(std::move(text));
+}
+
+MetricsServer::MetricsServer()
+    : epollFd(epoll_create1(EPOLL_CLOEXEC)),
+      metrics(response("503 Service Unavailable", "no sample yet\n")),
+      notFound(response("404 Not Found", "metrics are served at /metrics\n")) {
+}
+
+MetricsServer::~MetricsServer() {
+    for (auto& entry : connections) close(entry.first);
+    for (int fd : listeners) close(fd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool MetricsServer::fail(const std::string& what) {
+    errorText = what + ": " + strerror(errno);
+    return false;
+}
+
+bool MetricsServer::addListener(int fd) {
+    if (listen(fd, 128) != 0) {
+        close(fd);
+        return fail("listen");
+    }
+    
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        return fail("epoll_ctl");
+    }
+    listeners.push_back(fd);
+    return true;
+}
+
+bool MetricsServer::listenTcp(const std::string& address) {
+    std::string host = "127.0.0.1";
+    std::string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+    if (host == "localhost") host = "127.0.0.1";
+    
+    sockaddr_in socketAddress = {};
+    socketAddress.sin_family = AF_INET;
+    char* end = nullptr;
+    long number = strtol(port.c_str(), &end, 10);
+    if (port.empty() || *end != '\0' || number <= 0 || number > 65535 ||
+        inet_pton(AF_INET, host.c_str(), &socketAddress.sin_addr) != 1) {
+        errorText = "bad listen address: " + address;
+        return false;
+    }
+    socketAddress.sin_port = htons(static_cast<uint16_t>(number));
+    
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return fail("socket");
+    
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) {
+        close(fd);
+        return fail("bind " + address);
+    }
+    return addListener(fd);
+}
+
+bool MetricsServer::listenUnix(const std::string& path) {
+    sockaddr_un socketAddress = {};
+    socketAddress.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(socketAddress.sun_path)) {
+        errorText = "bad socket path: " + path;
+        return false;
+    }
+    memcpy(socketAddress.sun_path, path.c_str(), path.size());
+    
+    // only ever remove a leftover socket, never a regular file
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(path.c_str());
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return fail("socket");
+    
+    if (bind(fd, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0) {
+        close(fd);
+        return fail("bind " + path);
+    }
+    unixPath = path;
+    return addListener(fd);
+}
+
+void MetricsServer::publish(const std::string& body) {
+    // connections still sending the previous response keep it alive
+    metrics = response("200 OK", body);
+}
+
+void MetricsServer::accept(int listener) {
+    while (true) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        
+        if (connections.size() >= MaxConnections) {
+            close(fd);
+            continue;
+        }
+        
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        
+        Connection& connection = connections[fd];
+        connection.received = 0;
+        connection.response.reset();
+        connection.sent = 0;
+        connection.since = Clock::now();
+    }
+}
+
+void MetricsServer::readRequest(int fd, Connection& connection) {
+    bool closed = false;
+    while (connection.received < sizeof(connection.request)) {
+        ssize_t count = read(fd, connection.request + connection.received,
+                             sizeof(connection.request) - connection.received);
+        if (count == 0) {
+            closed = true;
+            break;
+        }
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+        connection.received += static_cast<size_t>(count);
+    }
+    
+    // answer once the headers are complete; nothing past them is needed
+    const char* begin = connection.request;
+    const char* end = begin + connection.received;
+    static const char blankLine[] = "\r\n\r\n";
+    bool complete = std::search(begin, end, blankLine, blankLine + 4) != end;
+    if (!complete && !closed && connection.received < sizeof(connection.request)) return;
+    if (!complete && connection.received == 0) {
+        drop(fd);
+        return;
+    }
+    
+    static const char path[] = "GET /metrics";
+    size_t length = sizeof(path) - 1;
+    bool isMetrics = connection.received > length && memcmp(begin, path, length) == 0 &&
+                     (begin[length] == ' ' || begin[length] == '?');
+    connection.response = complete && isMetrics ? metrics : notFound;
+    connection.sent = 0;
+    writeResponse(fd, connection);
+}
+
+void MetricsServer::writeResponse(int fd, Connection& connection) {
+    const std::string& text = *connection.response;
+    while (connection.sent < text.size()) {
+        ssize_t count = send(fd, text.data() + connection.sent, text.size() - connection.sent, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                // socket buffer full: finish when it drains
+                epoll_event event = {};
+                event.events = EPOLLOUT;
+                event.data.fd = fd;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+                return;
+            }
+            break;
+        }
+        connection.sent += static_cast<size_t>(count);
+    }
+    drop(fd);
+}
+
+void MetricsServer::drop(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+void MetricsServer::dropIdle(Clock::time_point now) {
+    std::vector<int> idle;
+    for (const auto& entry : connections) {
+        if (now - entry.second.since > std::chrono::seconds(IdleSeconds)) idle.push_back(entry.first);
+    }
+    for (int fd : idle) drop(fd);
+}
+
+bool MetricsServer::run(int intervalMs, const std::function<void()>& onTick,
+                        const volatile sig_atomic_t* stop) {
+    if (epollFd < 0) return fail("epoll_create1");
+    if (listeners.empty()) {
+        errorText = "nothing to listen on";
+        return false;
+    }
+    
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) return fail("timerfd_create");
+    
+    itimerspec period = {};
+    period.it_interval.tv_sec = intervalMs / 1000;
+    period.it_interval.tv_nsec = (intervalMs % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+    timerfd_settime(timerFd, 0, &period, nullptr);
+    
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = timerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+    
+    if (onTick) onTick();
+    
+    epoll_event events[64];
+    while (!stop || !*stop) {
+        // the timeout only bounds how long a stop request can go unnoticed
+        int ready = epoll_wait(epollFd, events, 64, 1000);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            close(timerFd);
+            return fail("epoll_wait");
+        }
+        
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            
+            if (fd == timerFd) {
+                uint64_t expirations;
+                if (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                    if (onTick) onTick();
+                    dropIdle(Clock::now());
+                }
+                continue;
+            }
+            if (std::find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                accept(fd);
+                continue;
+            }
+            
+            auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                drop(fd);
+            } else if (found->second.response) {
+                writeResponse(fd, found->second);
+            } else {
+                readRequest(fd, found->second);
+            }
+        }
+    }
+    
+    close(timerFd);
+    return true;
+}
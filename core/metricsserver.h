@@ -0,0 +1,68 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// single-threaded epoll http server for the --daemon mode. the caller
+// publishes a complete pre-rendered response once per sample; a scrape of
+// /metrics only parses the request line and sends that buffer, normally in
+// one write(2), so any number of scrapers never cause extra /proc reads.
+// sampling runs on the same loop from a timerfd, so there are no locks.
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+    
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    
+    // "9101", "127.0.0.1:9101" or "0.0.0.0:9101"
+    bool listenTcp(const std::string& address);
+    // a stale socket file left at path is replaced
+    bool listenUnix(const std::string& path);
+    
+    // body served for GET /metrics until the next publish
+    void publish(const std::string& body);
+    
+    // serve until *stop is set, calling onTick every intervalMs
+    bool run(int intervalMs, const std::function<void()>& onTick,
+             const volatile sig_atomic_t* stop = nullptr);
+    
+    const std::string& error() const { return errorText; }
+    
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    struct Connection {
+        char request[1024];
+        size_t received;
+        std::shared_ptr<const std::string> response;
+        size_t sent;
+        Clock::time_point since;
+    };
+    
+    bool fail(const std::string& what);
+    bool addListener(int fd);
+    void accept(int listener);
+    void readRequest(int fd, Connection& connection);
+    void writeResponse(int fd, Connection& connection);
+    void drop(int fd);
+    void dropIdle(Clock::time_point now);
+    
+    std::string errorText;
+    int epollFd;
+    std::vector<int> listeners;
+    std::string unixPath;
+    std::unordered_map<int, Connection> connections;
+    
+    std::shared_ptr<const std::string> metrics;
+    std::shared_ptr<const std::string> notFound;
+};
+
+#endif
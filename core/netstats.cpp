@@ -0,0 +1,113 @@
+#include "netstats.h"
+#include "counters.h"
+#include "scanner.h"
+#include <cstdio>
+#include <net/if.h>
+#include <utility>
+
+NetCollector::NetCollector(const std::string& rootPath) : previousTime(0.0), aggregate(), root(rootPath) {
+}
+
+bool NetCollector::isLoopback(const std::string& name) const {
+    // read once per interface, when it first shows up
+    std::string path = root + "/sys/class/net/" + name + "/flags";
+    ProcFile file;
+    if (file.open(path.c_str()) && file.read() && file.size() > 2) {
+        Scanner sc(file.begin(), file.end());
+        if (sc.consume("0x", 2)) {
+            unsigned long flags = 0;
+            while (!sc.atEnd()) {
+                char c = *sc.pos++;
+                if (c >= '0' && c <= '9') flags = flags * 16 + (c - '0');
+                else if (c >= 'a' && c <= 'f') flags = flags * 16 + (c - 'a' + 10);
+                else break;
+            }
+            return (flags & IFF_LOOPBACK) != 0;
+        }
+    }
+    return name == "lo";
+}
+
+const InterfaceStats* NetCollector::findPrevious(const std::string& name, size_t hint) const {
+    // the interface list rarely changes, so the same slot almost always matches
+    if (hint < previous.size() && previous[hint].name == name) return &previous[hint];
+    for (const InterfaceStats& entry : previous) {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+void NetCollector::update(const ProcFile& netDev, double now) {
+    double elapsed = previousTime > 0.0 ? now - previousTime : 0.0;
+    double scale = elapsed > 0.0 ? 1.0 / elapsed : 0.0;
+    
+    // the last reading becomes the baseline; the one before it lends its
+    // slots, so a steady interface list does not allocate
+    std::swap(previous, current);
+    
+    Scanner sc(netDev.begin(), netDev.end());
+    
+    // skip header lines
+    sc.skipLine();
+    sc.skipLine();
+    
+    aggregate = InterfaceStats();
+    size_t count = 0;
+    while (!sc.atEnd()) {
+        sc.skipSpaces();
+        const char* name = sc.pos;
+        if (!sc.skipPast(':')) break;
+        
+        if (count >= current.size()) current.emplace_back();
+        InterfaceStats& entry = current[count];
+        entry.name.assign(name, sc.pos - 1 - name);
+        
+        // rx: bytes packets errs drop fifo frame compressed multicast
+        // tx: bytes packets errs drop ...
+        entry.rxBytes = sc.parseU64();
+        entry.rxPackets = sc.parseU64();
+        entry.rxErrors = sc.parseU64();
+        entry.rxDrops = sc.parseU64();
+        sc.skipTokens(4);
+        entry.txBytes = sc.parseU64();
+        entry.txPackets = sc.parseU64();
+        entry.txErrors = sc.parseU64();
+        entry.txDrops = sc.parseU64();
+        sc.skipLine();
+        
+        const InterfaceStats* before = findPrevious(entry.name, count);
+        if (before) {
+            entry.loopback = before->loopback;
+            entry.rxRate = counterDelta(before->rxBytes, entry.rxBytes) * scale;
+            entry.txRate = counterDelta(before->txBytes, entry.txBytes) * scale;
+            entry.rxPacketRate = counterDelta(before->rxPackets, entry.rxPackets) * scale;
+            entry.txPacketRate = counterDelta(before->txPackets, entry.txPackets) * scale;
+        } else {
+            entry.loopback = isLoopback(entry.name);
+            entry.rxRate = 0.0;
+            entry.txRate = 0.0;
+            entry.rxPacketRate = 0.0;
+            entry.txPacketRate = 0.0;
+        }
+        
+        // the aggregate rate sums per-interface deltas, so an interface
+        // going away does not show up as negative traffic
+        if (!entry.loopback) {
+            aggregate.rxBytes += entry.rxBytes;
+            aggregate.rxPackets += entry.rxPackets;
+            aggregate.rxErrors += entry.rxErrors;
+            aggregate.rxDrops += entry.rxDrops;
+            aggregate.txBytes += entry.txBytes;
+            aggregate.txPackets += entry.txPackets;
+            aggregate.txErrors += entry.txErrors;
+            aggregate.txDrops += entry.txDrops;
+            aggregate.rxRate += entry.rxRate;
+            aggregate.txRate += entry.txRate;
+            aggregate.rxPacketRate += entry.rxPacketRate;
+            aggregate.txPacketRate += entry.txPacketRate;
+        }
+        count++;
+    }
+    current.resize(count);
+    previousTime = now;
+}
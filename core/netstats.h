@@ -0,0 +1,55 @@
+#ifndef NETSTATS_H
+#define NETSTATS_H
+
+#include <string>
+#include <vector>
+#include "procfile.h"
+
+// one line of /proc/net/dev plus rates over the last interval
+struct InterfaceStats {
+    std::string name;
+    bool loopback;
+    unsigned long long rxBytes;
+    unsigned long long rxPackets;
+    unsigned long long rxErrors;
+    unsigned long long rxDrops;
+    unsigned long long txBytes;
+    unsigned long long txPackets;
+    unsigned long long txErrors;
+    unsigned long long txDrops;
+    double rxRate;                      // bytes per second
+    double txRate;
+    double rxPacketRate;                // packets per second
+    double txPacketRate;
+};
+
+// per-interface counters and rates. rates are divided by the monotonic time
+// between the two reads of /proc/net/dev, not by the nominal interval, so a
+// late tick does not inflate them; counters that wrap (32-bit drivers) or
+// reset (interface re-created) never produce a negative or huge delta.
+class NetCollector {
+public:
+    // interface flags are read from root + /sys/class/net
+    explicit NetCollector(const std::string& root = std::string());
+    
+    // now is CLOCK_MONOTONIC seconds at which netDev was read
+    void update(const ProcFile& netDev, double now);
+    
+    // every interface, loopback included, in /proc/net/dev order
+    const std::vector<InterfaceStats>& interfaces() const { return current; }
+    
+    // sum of every interface except loopback; name is empty
+    const InterfaceStats& total() const { return aggregate; }
+    
+private:
+    bool isLoopback(const std::string& name) const;
+    const InterfaceStats* findPrevious(const std::string& name, size_t hint) const;
+    
+    std::vector<InterfaceStats> current;
+    std::vector<InterfaceStats> previous;
+    double previousTime;
+    InterfaceStats aggregate;
+    std::string root;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef PIDTABLE_H
+#define PIDTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// open-addressing (linear probing) hash keyed by pid, for per-process state
+// that has to survive between samples. capacity is a power of two and only
+// grows, entries are removed with backward-shift deletion so there are no
+// tombstones and a steady process population never rehashes.
+template <typename T>
+class PidTable {
+public:
+    explicit PidTable(size_t initialCapacity = 1024) : count(0) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) capacity <<= 1;
+        entries.resize(capacity);
+        mask = capacity - 1;
+    }
+    
+    size_t size() const { return count; }
+    
+    T* find(int pid) {
+        for (size_t i = hash(pid) & mask;; i = (i + 1) & mask) {
+            if (entries[i].pid == pid) return &entries[i].value;
+            if (entries[i].pid == 0) return nullptr;
+        }
+    }
+    
+    const T* find(int pid) const {
+        return const_cast<PidTable*>(this)->find(pid);
+    }
+    
+    // find the entry for pid, creating a value-initialized one if absent
+    T& insert(int pid, bool& inserted) {
+        if ((count + 1) * 2 > entries.size()) grow();
+        
+        size_t i = hash(pid) & mask;
+        while (entries[i].pid != 0) {
+            if (entries[i].pid == pid) {
+                inserted = false;
+                return entries[i].value;
+            }
+            i = (i + 1) & mask;
+        }
+        
+        entries[i].pid = pid;
+        entries[i].value = T();
+        count++;
+        inserted = true;
+        return entries[i].value;
+    }
+    
+    void erase(int pid) {
+        for (size_t i = hash(pid) & mask; entries[i].pid != 0; i = (i + 1) & mask) {
+            if (entries[i].pid == pid) {
+                eraseSlot(i);
+                return;
+            }
+        }
+    }
+    
+    // drop every entry for which stale(value) is true, in one pass over the entries
+    template <typename Pred>
+    void removeIf(Pred stale) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            // backward shift may pull another entry into slot i, so recheck it
+            while (entries[i].pid != 0 && stale(entries[i].value)) {
+                eraseSlot(i);
+            }
+        }
+    }
+    
+    template <typename Fn>
+    void forEach(Fn fn) {
+        for (Slot& slot : entries) {
+            if (slot.pid != 0) fn(slot.pid, slot.value);
+        }
+    }
+    
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (const Slot& slot : entries) {
+            if (slot.pid != 0) fn(slot.pid, slot.value);
+        }
+    }
+    
+private:
+    struct Slot {
+        int pid = 0;
+        T value = T();
+    };
+    
+    static size_t hash(int pid) {
+        return static_cast<size_t>(static_cast<uint32_t>(pid) * 2654435761u);
+    }
+    
+    void eraseSlot(size_t hole) {
+        size_t i = hole;
+        while (true) {
+            i = (i + 1) & mask;
+            if (entries[i].pid == 0) break;
+            
+            // move slot i back into the hole unless its home lies cyclically in (hole, i]
+            size_t home = hash(entries[i].pid) & mask;
+            bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+            if (stays) continue;
+            
+            entries[hole] = entries[i];
+            hole = i;
+        }
+        entries[hole].pid = 0;
+        entries[hole].value = T();
+        count--;
+    }
+    
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(entries);
+        entries.resize(old.size() * 2);
+        mask = entries.size() - 1;
+        
+        for (Slot& slot : old) {
+            if (slot.pid == 0) continue;
+            size_t i = hash(slot.pid) & mask;
+            while (entries[i].pid != 0) i = (i + 1) & mask;
+            entries[i] = slot;
+        }
+    }
+    
+    std::vector<Slot> entries;
+    size_t count;
+    size_t mask;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "pressure.h"
+#include "scanner.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+const char* pressureResourceName(int resource) {
+    static const char* const names[] = {"cpu", "memory", "io"};
+    return resource >= 0 && resource < PressureResourceCount ? names[resource] : "";
+}
+
+PressureCollector::PressureCollector() : resources() {
+}
+
+// "avg10=0.32 avg60=1.56 avg300=1.61 total=59345827"
+static void parseLine(Scanner& sc, PressureLine& line) {
+    sc.skipPast('=');
+    line.avg10 = sc.parseDouble();
+    sc.skipPast('=');
+    line.avg60 = sc.parseDouble();
+    sc.skipPast('=');
+    line.avg300 = sc.parseDouble();
+    sc.skipPast('=');
+    line.totalUs = sc.parseU64();
+    sc.skipLine();
+}
+
+void PressureCollector::update(int resource, const ProcFile& file) {
+    Pressure& pressure = resources[resource];
+    pressure = Pressure();
+    if (file.size() == 0) return;
+    
+    // "full" is missing for cpu on kernels before 5.13
+    Scanner sc(file.begin(), file.end());
+    if (!sc.consume("some", 4)) return;
+    parseLine(sc, pressure.some);
+    if (sc.consume("full", 4)) parseLine(sc, pressure.full);
+    pressure.available = true;
+}
+
+PressureTriggers::PressureTriggers() : wakeFd(-1), stopping(false) {
+}
+
+PressureTriggers::~PressureTriggers() {
+    if (watcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+        watcher.join();
+    }
+    for (int fd : descriptors) {
+        if (fd >= 0) close(fd);
+    }
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool PressureTriggers::add(const std::string& spec) {
+    // resource:some|full:stall ms:window ms
+    char resourceName[16];
+    char kind[8];
+    unsigned stallMs = 0;
+    unsigned windowMs = 0;
+    char extra;
+    if (sscanf(spec.c_str(), "%15[a-z]:%7[a-z]:%u:%u%c", resourceName, kind, &stallMs, &windowMs, &extra) != 4) {
+        lastError = "expected resource:some|full:stall_ms:window_ms, got \"" + spec + "\"";
+        return false;
+    }
+    
+    PressureTrigger trigger = {};
+    trigger.resource = -1;
+    for (int resource = 0; resource < PressureResourceCount; resource++) {
+        if (strcmp(resourceName, pressureResourceName(resource)) == 0) trigger.resource = resource;
+    }
+    if (trigger.resource < 0 || (strcmp(kind, "some") != 0 && strcmp(kind, "full") != 0)) {
+        lastError = "unknown pressure resource or kind in \"" + spec + "\"";
+        return false;
+    }
+    if (windowMs < 500 || windowMs > 10000 || stallMs == 0 || stallMs > windowMs) {
+        lastError = "window must be 500-10000 ms and the stall at most the window, in \"" + spec + "\"";
+        return false;
+    }
+    trigger.full = kind[0] == 'f';
+    trigger.stallUs = stallMs * 1000;
+    trigger.windowUs = windowMs * 1000;
+    
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/pressure/%s", resourceName);
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        lastError = std::string("cannot open ") + path + ": " + strerror(errno);
+        return false;
+    }
+    
+    // the trigger lives as long as the descriptor, which is the one to poll
+    char threshold[64];
+    int length = snprintf(threshold, sizeof(threshold), "%s %u %u", kind, trigger.stallUs, trigger.windowUs);
+    if (write(fd, threshold, static_cast<size_t>(length) + 1) < 0) {
+        lastError = std::string("kernel refused trigger \"") + spec + "\": " + strerror(errno);
+        if (errno == EINVAL && windowMs % 2000 != 0) lastError += " (without CAP_SYS_RESOURCE the window must be a multiple of 2000 ms)";
+        close(fd);
+        return false;
+    }
+    
+    if (wakeFd < 0) {
+        wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wakeFd < 0) {
+            lastError = std::string("eventfd: ") + strerror(errno);
+            close(fd);
+            return false;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        triggers.push_back(trigger);
+        descriptors.push_back(fd);
+    }
+    
+    // the watcher picks up the new descriptor when woken
+    if (watcher.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    } else {
+        watcher = std::thread(&PressureTriggers::watch, this);
+    }
+    return true;
+}
+
+bool PressureTriggers::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return triggers.empty();
+}
+
+void PressureTriggers::read(std::vector<PressureTrigger>& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.assign(triggers.begin(), triggers.end());
+}
+
+void PressureTriggers::watch() {
+    std::vector<struct pollfd> fds;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            fds.resize(descriptors.size() + 1);
+            fds[0].fd = wakeFd;
+            fds[0].events = POLLIN;
+            for (size_t i = 0; i < descriptors.size(); i++) {
+                fds[i + 1].fd = descriptors[i];
+                fds[i + 1].events = POLLPRI;
+            }
+        }
+        
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            ssize_t got = ::read(wakeFd, &count, sizeof(count));
+            (void)got;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents & POLLERR) {
+                // the monitored group went away; stop watching this one
+                close(descriptors[i - 1]);
+                descriptors[i - 1] = -1;
+            } else if (fds[i].revents & POLLPRI) {
+                triggers[i - 1].events++;
+                triggers[i - 1].lastEvent = now;
+            }
+        }
+    }
+}
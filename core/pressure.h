@@ -0,0 +1,104 @@
+#ifndef PRESSURE_H
+#define PRESSURE_H
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "procfile.h"
+
+enum PressureResource {
+    PressureCpu,
+    PressureMemory,
+    PressureIo,
+    PressureResourceCount
+};
+
+// "cpu", "memory", "io"
+const char* pressureResourceName(int resource);
+
+// one "some" or "full" line of /proc/pressure/<resource>
+struct PressureLine {
+    double avg10;                       // % of time stalled, decaying averages
+    double avg60;
+    double avg300;
+    unsigned long long totalUs;         // stall time since boot
+};
+
+// "some": at least one task stalled on the resource; "full": every
+// non-idle task stalled at once (always zero for cpu at the system level)
+struct Pressure {
+    bool available;
+    PressureLine some;
+    PressureLine full;
+};
+
+// a kernel stall threshold: fires when tasks stall for stallUs within any
+// windowUs. events and lastEvent are kept by PressureTriggers
+struct PressureTrigger {
+    int resource;
+    bool full;
+    unsigned stallUs;
+    unsigned windowUs;
+    unsigned long long events;
+    double lastEvent;                   // unix seconds, 0 before the first
+};
+
+struct PressureStats {
+    Pressure resources[PressureResourceCount];
+    std::vector<PressureTrigger> triggers;
+};
+
+// parses /proc/pressure/{cpu,memory,io}; a resource whose file could not be
+// read (no PSI in the kernel, or psi=0) is marked unavailable
+class PressureCollector {
+public:
+    PressureCollector();
+    
+    // file is a fresh read of /proc/pressure/<resource>
+    void update(int resource, const ProcFile& file);
+    
+    const Pressure& resource(int index) const { return resources[index]; }
+    
+private:
+    Pressure resources[PressureResourceCount];
+};
+
+// PSI poll triggers. each one is a /proc/pressure file opened for writing
+// with its threshold written to it; the kernel then raises POLLPRI on that
+// descriptor whenever the threshold is crossed, at most once per window. a
+// watcher thread sleeps in poll() on all of them, so stalls are timestamped
+// to the millisecond without any periodic polling. windows must be between
+// 500ms and 10s; without CAP_SYS_RESOURCE they must also be a multiple of 2s.
+class PressureTriggers {
+public:
+    PressureTriggers();
+    ~PressureTriggers();
+    
+    PressureTriggers(const PressureTriggers&) = delete;
+    PressureTriggers& operator=(const PressureTriggers&) = delete;
+    
+    // "memory:some:150:1000" = some memory stall of 150ms within 1s;
+    // false with error() set when the spec is malformed or the kernel
+    // refuses it. the watcher starts with the first trigger
+    bool add(const std::string& spec);
+    
+    bool empty() const;
+    const std::string& error() const { return lastError; }
+    
+    // copy the triggers and their event counts; safe from any thread
+    void read(std::vector<PressureTrigger>& out) const;
+    
+private:
+    void watch();
+    
+    mutable std::mutex mutex;
+    std::vector<PressureTrigger> triggers;
+    std::vector<int> descriptors;
+    int wakeFd;
+    bool stopping;
+    std::thread watcher;
+    std::string lastError;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "processtree.h"
+
+ProcessTree::ProcessTree() : generation(0) {
+}
+
+void ProcessTree::clear() {
+    nodes.clear();
+    freeNodes.clear();
+    nodeOfPid = PidTable<uint32_t>();
+    roots.clear();
+    preorder.clear();
+}
+
+const std::vector<int>& ProcessTree::children(int pid) const {
+    static const std::vector<int> none;
+    if (pid == 0) return roots;
+    const uint32_t* slot = nodeOfPid.find(pid);
+    return slot ? nodes[*slot].children : none;
+}
+
+const ProcessTreeNode* ProcessTree::find(int pid) const {
+    const uint32_t* slot = nodeOfPid.find(pid);
+    return slot ? &nodes[*slot] : nullptr;
+}
+
+uint32_t ProcessTree::allocate() {
+    if (!freeNodes.empty()) {
+        uint32_t slot = freeNodes.back();
+        freeNodes.pop_back();
+        return slot;
+    }
+    nodes.emplace_back();
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void ProcessTree::update(const std::vector<ProcessInfo>& processes, Listener* listener) {
+    unsigned current = ++generation;
+    
+    // refresh the known pids; new ones are created unlinked
+    for (const ProcessInfo& info : processes) {
+        bool inserted;
+        uint32_t& slot = nodeOfPid.insert(info.pid, inserted);
+        if (inserted) {
+            slot = allocate();
+            ProcessTreeNode& fresh = nodes[slot];
+            fresh.parent = 0;
+            fresh.position = 0;
+            fresh.depth = 0;
+            fresh.children.clear();
+            fresh.linked = false;
+            fresh.placing = false;
+        }
+        nodes[slot].info = info;
+        nodes[slot].generation = current;
+    }
+    
+    // link the new pids and move the reparented ones; nodes does not grow
+    // from here on, so references into it stay valid
+    for (const ProcessInfo& info : processes) place(info.pid, listener);
+    
+    // live children have moved off exited parents by now, so only the
+    // topmost exited pid of each subtree has to leave its parent's list
+    stale.clear();
+    nodeOfPid.forEach([&](int pid, uint32_t& slot) {
+        if (nodes[slot].generation != current) stale.push_back(pid);
+    });
+    for (int pid : stale) {
+        ProcessTreeNode& entry = node(pid);
+        if (entry.parent == 0 || node(entry.parent).generation == current) detach(pid, listener);
+    }
+    for (int pid : stale) {
+        uint32_t slot = *nodeOfPid.find(pid);
+        nodes[slot].children.clear();
+        freeNodes.push_back(slot);
+        nodeOfPid.erase(pid);
+    }
+    
+    rollUp();
+}
+
+void ProcessTree::place(int pid, Listener* listener) {
+    ProcessTreeNode& entry = node(pid);
+    int parent = entry.info.ppid;
+    uint32_t* parentSlot = parent > 0 && parent != pid ? nodeOfPid.find(parent) : nullptr;
+    if (!parentSlot || nodes[*parentSlot].generation != generation) parent = 0;
+    if (entry.linked && entry.parent == parent) return;
+    
+    if (parent != 0) {
+        // parents first, so a new subtree is linked from the top down
+        ProcessTreeNode& up = nodes[*parentSlot];
+        entry.placing = true;
+        if (!up.linked && !up.placing) place(parent, listener);
+        entry.placing = false;
+        
+        // a ppid cycle, which only a torn read can produce, goes to the top level
+        if (!up.linked || isAncestor(pid, parent)) parent = 0;
+        if (entry.linked && entry.parent == parent) return;
+    }
+    if (entry.linked) detach(pid, listener);
+    attach(pid, parent, listener);
+}
+
+bool ProcessTree::isAncestor(int ancestor, int pid) {
+    for (int current = pid; current != 0; current = node(current).parent) {
+        if (current == ancestor) return true;
+    }
+    return false;
+}
+
+void ProcessTree::attach(int pid, int parent, Listener* listener) {
+    std::vector<int>& list = childList(parent);
+    ProcessTreeNode& entry = node(pid);
+    int position = static_cast<int>(list.size());
+    
+    if (listener) listener->beginInsert(parent, position);
+    entry.parent = parent;
+    entry.position = position;
+    entry.linked = true;
+    list.push_back(pid);
+    if (listener) listener->endInsert();
+}
+
+void ProcessTree::detach(int pid, Listener* listener) {
+    ProcessTreeNode& entry = node(pid);
+    std::vector<int>& list = childList(entry.parent);
+    int position = entry.position;
+    
+    if (listener) listener->beginRemove(entry.parent, position);
+    list.erase(list.begin() + position);
+    for (size_t i = position; i < list.size(); i++) node(list[i]).position = static_cast<int>(i);
+    entry.linked = false;
+    if (listener) listener->endRemove();
+}
+
+void ProcessTree::rollUp() {
+    // pre-order, so every parent is visited before its children; a visit
+    // remembers where its parent was visited, which saves a lookup per
+    // process on the way back
+    visits.clear();
+    stack.clear();
+    for (size_t i = roots.size(); i-- > 0; ) stack.push_back({*nodeOfPid.find(roots[i]), NoParent});
+    while (!stack.empty()) {
+        Visit visit = stack.back();
+        stack.pop_back();
+        ProcessTreeNode& entry = nodes[visit.node];
+        entry.depth = visit.parent == NoParent ? 0 : nodes[visits[visit.parent].node].depth + 1;
+        entry.subtreeCpu = entry.info.cpu;
+        entry.subtreeMemory = entry.info.memory;
+        entry.descendants = 0;
+        uint32_t self = static_cast<uint32_t>(visits.size());
+        visits.push_back(visit);
+        for (size_t i = entry.children.size(); i-- > 0; ) {
+            stack.push_back({*nodeOfPid.find(entry.children[i]), self});
+        }
+    }
+    
+    // backwards, each subtree is complete before it is added to its parent
+    preorder.resize(visits.size());
+    for (size_t i = visits.size(); i-- > 0; ) {
+        const ProcessTreeNode& entry = nodes[visits[i].node];
+        preorder[i] = entry.info.pid;
+        if (visits[i].parent == NoParent) continue;
+        ProcessTreeNode& up = nodes[visits[visits[i].parent].node];
+        up.subtreeCpu += entry.subtreeCpu;
+        up.subtreeMemory += entry.subtreeMemory;
+        up.descendants += entry.descendants + 1;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PROCESSTREE_H
+#define PROCESSTREE_H
+
+#include <cstdint>
+#include <vector>
+#include "pidtable.h"
+#include "systemstats.h"
+
+// one process in the tree, with the totals of everything below it
+struct ProcessTreeNode {
+    ProcessInfo info;
+    int parent;                         // pid, 0 at the top level
+    int position;                       // index among the parent's children
+    int depth;                          // 0 at the top level
+    std::vector<int> children;          // pids, in the order they were linked
+    double subtreeCpu;                  // own plus every descendant's
+    double subtreeMemory;
+    unsigned descendants;
+    unsigned generation;                // update() that last saw the pid
+    bool linked;
+    bool placing;                       // on the stack of place(), to break ppid cycles
+};
+
+// the process table as a parent -> children tree, keyed by ppid. update()
+// only touches the links of pids that appeared, exited or were reparented,
+// so a steady system costs one lookup per process; the subtree totals are
+// then rolled up in one bottom-up pass. a process whose parent is not in
+// the table (init, kthreadd, or one the scan missed) sits at the top level.
+class ProcessTree {
+public:
+    // told about every structural change, in the begin/end pairs a Qt item
+    // model needs; positions are in the children list of parent (0 = top)
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        virtual void beginInsert(int parent, int position) = 0;
+        virtual void endInsert() = 0;
+        virtual void beginRemove(int parent, int position) = 0;
+        virtual void endRemove() = 0;
+    };
+    
+    ProcessTree();
+    
+    void update(const std::vector<ProcessInfo>& processes, Listener* listener = nullptr);
+    void clear();
+    
+    size_t size() const { return nodeOfPid.size(); }
+    // children of pid, or the top level for 0; empty for an unknown pid
+    const std::vector<int>& children(int pid) const;
+    const ProcessTreeNode* find(int pid) const;
+    // every pid, parents before children, as of the last update()
+    const std::vector<int>& order() const { return preorder; }
+    
+private:
+    ProcessTreeNode& node(int pid) { return nodes[*nodeOfPid.find(pid)]; }
+    std::vector<int>& childList(int parent) { return parent == 0 ? roots : node(parent).children; }
+    uint32_t allocate();
+    void place(int pid, Listener* listener);
+    void attach(int pid, int parent, Listener* listener);
+    void detach(int pid, Listener* listener);
+    bool isAncestor(int ancestor, int pid);
+    void rollUp();
+    
+    std::vector<ProcessTreeNode> nodes;
+    std::vector<uint32_t> freeNodes;
+    PidTable<uint32_t> nodeOfPid;       // pid -> index into nodes
+    std::vector<int> roots;
+    unsigned generation;
+    
+    // scratch, kept so a steady tree allocates nothing
+    struct Visit {
+        uint32_t node;
+        uint32_t parent;                // index into visits
+    };
+    static const uint32_t NoParent = UINT32_MAX;
+    std::vector<int> stale;
+    std::vector<Visit> stack;
+    std::vector<Visit> visits;
+    std::vector<int> preorder;
+};
+
+#endif
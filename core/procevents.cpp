@@ -0,0 +1,303 @@
+#include "procevents.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// how long start() waits for the kernel to answer the subscription
+static const int AcknowledgeTimeoutMs = 1000;
+// room for a burst of several thousand events between two wakeups
+static const int ReceiveBufferBytes = 4 << 20;
+// every event we read has at least four pid fields after the common header
+static const size_t MinimumEventBytes = offsetof(struct proc_event, event_data) + 4 * sizeof(__kernel_pid_t);
+
+const int ProcessEvents::ScanIntervalSeconds;
+
+ProcessEvents::ProcessEvents()
+    : liveCount(0), eventSerial(0), walks(0), synced(false), overflowed(false), totals(), socketFd(-1),
+      wakeFd(-1), failed(false), stopping(false), acknowledged(false), acknowledgeError(0) {
+}
+
+ProcessEvents::~ProcessEvents() {
+    if (listener.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+        listener.join();
+    }
+    if (socketFd >= 0) {
+        // the kernel only builds events while someone listens
+        subscribe(PROC_CN_MCAST_IGNORE);
+        close(socketFd);
+    }
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool ProcessEvents::subscribe(int op) {
+    // nlmsghdr, cn_msg, then the operation. the kernel numbers its replies
+    // itself, but answers with our ack plus one, which tells our
+    // acknowledgement from another listener's
+    alignas(struct nlmsghdr) char buffer[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+    memset(buffer, 0, sizeof(buffer));
+    struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(buffer);
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    struct cn_msg* message = static_cast<struct cn_msg*>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->ack = static_cast<uint32_t>(getpid());
+    message->len = sizeof(enum proc_cn_mcast_op);
+    enum proc_cn_mcast_op value = static_cast<enum proc_cn_mcast_op>(op);
+    memcpy(message->data, &value, sizeof(value));
+    return send(socketFd, buffer, header->nlmsg_len, 0) >= 0;
+}
+
+bool ProcessEvents::start() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (listener.joinable()) return !failed;
+    
+    socketFd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (socketFd < 0) {
+        lastError = std::string("cannot open the proc connector: ") + strerror(errno);
+        return false;
+    }
+    
+    struct sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    bool subscribed = bind(socketFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0;
+    if (subscribed) {
+        // the forced size needs the same capability as the subscription itself
+        int size = ReceiveBufferBytes;
+        if (setsockopt(socketFd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+            setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        }
+        subscribed = subscribe(PROC_CN_MCAST_LISTEN);
+    }
+    if (!subscribed) {
+        lastError = std::string("cannot subscribe to process events: ") + strerror(errno);
+        close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+    
+    // the kernel answers with an empty event carrying an errno; events of
+    // other listeners' processes may arrive first and already count
+    acknowledged = false;
+    char buffer[8192];
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(AcknowledgeTimeoutMs);
+    while (!acknowledged) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) break;
+        struct pollfd fd = {socketFd, POLLIN, 0};
+        if (poll(&fd, 1, static_cast<int>(left.count())) <= 0) continue;
+        ssize_t length = recv(socketFd, buffer, sizeof(buffer), 0);
+        if (length > 0) apply(buffer, static_cast<size_t>(length));
+    }
+    if (!acknowledged || acknowledgeError != 0) {
+        lastError = acknowledged
+            ? std::string("the proc connector refused the subscription: ") + strerror(acknowledgeError)
+            : std::string("no answer from the proc connector (kernel without CONFIG_PROC_EVENTS?)");
+        close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+    
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    failed = false;
+    listener = std::thread(&ProcessEvents::listen, this);
+    return true;
+}
+
+bool ProcessEvents::active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return listener.joinable() && !failed;
+}
+
+std::string ProcessEvents::error() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
+
+void ProcessEvents::apply(char* buffer, size_t length) {
+    int remaining = static_cast<int>(length);
+    for (struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(buffer); NLMSG_OK(header, remaining);
+         header = NLMSG_NEXT(header, remaining)) {
+        if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) continue;
+        const struct cn_msg* message = static_cast<const struct cn_msg*>(NLMSG_DATA(header));
+        if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC || message->len < MinimumEventBytes) {
+            continue;
+        }
+        
+        // the payload sits at an odd offset, and the kernel's struct may be
+        // longer or shorter than ours
+        struct proc_event event;
+        memset(&event, 0, sizeof(event));
+        memcpy(&event, message->data, std::min<size_t>(message->len, sizeof(event)));
+        
+        switch (event.what) {
+        case proc_event::PROC_EVENT_NONE:
+            // acknowledgements go to every listener
+            if (message->ack == static_cast<uint32_t>(getpid()) + 1) {
+                acknowledged = true;
+                acknowledgeError = static_cast<int>(event.event_data.ack.err);
+            }
+            break;
+        case proc_event::PROC_EVENT_FORK: {
+            // a new thread shares the tgid of its process
+            if (event.event_data.fork.child_pid != event.event_data.fork.child_tgid) break;
+            totals.forks++;
+            bool inserted;
+            Entry& entry = entries.insert(event.event_data.fork.child_tgid, inserted);
+            if (!entry.alive) {
+                entry.alive = true;
+                liveCount++;
+            }
+            entry.serial = ++eventSerial;
+            break;
+        }
+        case proc_event::PROC_EVENT_EXEC:
+            totals.execs++;
+            break;
+        case proc_event::PROC_EVENT_EXIT:
+            if (event.event_data.exit.process_pid != event.event_data.exit.process_tgid) break;
+            totals.exits++;
+            markExited(event.event_data.exit.process_tgid);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ProcessEvents::markExited(int pid) {
+    bool inserted;
+    Entry& entry = entries.insert(pid, inserted);
+    if (entry.alive) {
+        entry.alive = false;
+        liveCount--;
+    }
+    entry.serial = ++eventSerial;
+}
+
+void ProcessEvents::listen() {
+    std::vector<char> buffer(64 * 1024);
+    struct pollfd fds[2] = {{wakeFd, POLLIN, 0}, {socketFd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+        if (fds[0].revents & POLLIN) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+        }
+        
+        // one event per datagram; take all that are queued
+        while (true) {
+            ssize_t length = recv(socketFd, buffer.data(), buffer.size(), 0);
+            if (length > 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                apply(buffer.data(), static_cast<size_t>(length));
+            } else if (length < 0 && errno == ENOBUFS) {
+                // events were dropped; the owner walks /proc on its next pass
+                std::lock_guard<std::mutex> lock(mutex);
+                overflowed = true;
+                totals.overflows++;
+            } else if (length < 0 && errno == EINTR) {
+                continue;
+            } else if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                std::lock_guard<std::mutex> lock(mutex);
+                lastError = std::string("process events stopped: ") + (length < 0 ? strerror(errno) : "socket closed");
+                failed = true;
+                return;
+            }
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    lastError = std::string("process events stopped: ") + strerror(errno);
+    failed = true;
+}
+
+bool ProcessEvents::scanDue(std::chrono::steady_clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !synced || overflowed || now - lastWalk >= std::chrono::seconds(ScanIntervalSeconds);
+}
+
+unsigned long long ProcessEvents::serial() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return eventSerial;
+}
+
+void ProcessEvents::resync(const std::vector<int>& walked, unsigned long long since,
+                           std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned walk = ++walks;
+    unsigned long long corrected = 0;
+    
+    // a pid we have no record of at all is a fork we missed. one whose exit
+    // was seen stays dead even when listed: it was a zombie, or exited
+    // while the walk ran
+    for (int pid : walked) {
+        bool inserted;
+        Entry& entry = entries.insert(pid, inserted);
+        entry.walk = walk;
+        if (!inserted) continue;
+        entry.alive = true;
+        liveCount++;
+        corrected++;
+    }
+    
+    entries.removeIf([&](const Entry& entry) {
+        // tombstones have done their job once a walk is applied
+        if (!entry.alive) return true;
+        // listed, or forked after the walk began
+        if (entry.walk == walk || entry.serial > since) return false;
+        // alive by our books but gone from /proc: its exit was lost
+        liveCount--;
+        corrected++;
+        return true;
+    });
+    
+    // the first walk is the baseline, not a correction
+    if (synced) totals.corrections += corrected;
+    synced = true;
+    overflowed = false;
+    lastWalk = now;
+}
+
+void ProcessEvents::forget(int pid) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry* entry = entries.find(pid);
+    if (entry && entry->alive) markExited(pid);
+}
+
+void ProcessEvents::pids(std::vector<int>& out) const {
+    out.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.reserve(liveCount);
+        entries.forEach([&](int pid, const Entry& entry) {
+            if (entry.alive) out.push_back(pid);
+        });
+    }
+    std::sort(out.begin(), out.end());
+}
+
+ProcessEventCounts ProcessEvents::counts() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ProcessEventCounts result = totals;
+    result.active = listener.joinable() && !failed;
+    return result;
+}
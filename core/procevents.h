@@ -0,0 +1,97 @@
+#ifndef PROCEVENTS_H
+#define PROCEVENTS_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pidtable.h"
+
+// event totals since start()
+struct ProcessEventCounts {
+    bool active;                        // the pid set comes from events, not a /proc walk
+    unsigned long long forks;           // new processes; threads are not counted
+    unsigned long long execs;
+    unsigned long long exits;
+    unsigned long long corrections;     // pids a consistency walk had to add or remove
+    unsigned long long overflows;       // times the socket dropped events
+};
+
+// the live pid set, kept from the fork and exit events of the kernel's proc
+// connector (netlink, CONFIG_PROC_EVENTS) instead of a walk of /proc every
+// sample. a thread drains the socket as events arrive, so processes that
+// live for a few milliseconds are still counted. the first set has to come
+// from /proc, and events are lost when the socket overflows, so the owner
+// resyncs from a full walk at start, after an overflow and every
+// ScanIntervalSeconds as a consistency check. subscribing needs
+// CAP_NET_ADMIN; without it start() fails and the owner keeps walking /proc.
+class ProcessEvents {
+public:
+    static const int ScanIntervalSeconds = 60;
+    
+    ProcessEvents();
+    ~ProcessEvents();
+    
+    ProcessEvents(const ProcessEvents&) = delete;
+    ProcessEvents& operator=(const ProcessEvents&) = delete;
+    
+    // subscribe and start the listener thread; false with error() set when
+    // the connector is missing or refuses the subscription. safe from any thread
+    bool start();
+    // subscribed, and the socket has not failed since
+    bool active() const;
+    std::string error() const;
+    
+    // true when the set needs a full walk: never synced, events were lost,
+    // or the last walk is ScanIntervalSeconds old
+    bool scanDue(std::chrono::steady_clock::time_point now) const;
+    // the event count so far; take it before walking /proc and pass it to resync()
+    unsigned long long serial() const;
+    // make the set what a walk that began at serial `since` found. pids that
+    // forked or exited after since keep the state their events gave them,
+    // since the walk may have listed the directory before or after them
+    void resync(const std::vector<int>& walked, unsigned long long since,
+                std::chrono::steady_clock::time_point now);
+    // a pid whose /proc entry has gone before its exit event arrived
+    void forget(int pid);
+    
+    // the live pids in ascending order
+    void pids(std::vector<int>& out) const;
+    ProcessEventCounts counts() const;
+    
+private:
+    // exited pids stay as tombstones until the next resync, so a walk that
+    // still listed them does not bring them back
+    struct Entry {
+        unsigned long long serial;      // of the event that last changed it, 0 from a walk
+        unsigned walk;                  // resync that last listed it
+        bool alive;
+    };
+    
+    bool subscribe(int op);
+    void apply(char* buffer, size_t length);         // with the mutex held
+    void markExited(int pid);
+    void listen();
+    
+    mutable std::mutex mutex;
+    PidTable<Entry> entries;
+    size_t liveCount;
+    unsigned long long eventSerial;
+    unsigned walks;
+    bool synced;
+    bool overflowed;
+    std::chrono::steady_clock::time_point lastWalk;
+    ProcessEventCounts totals;
+    
+    int socketFd;
+    int wakeFd;
+    bool failed;
+    bool stopping;
+    bool acknowledged;
+    int acknowledgeError;
+    std::thread listener;
+    std::string lastError;
+};
+
+#endif
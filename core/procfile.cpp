@@ -0,0 +1,55 @@
+#include "procfile.h"
+#include "selfstats.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+ProcFile::ProcFile() : fd(-1), buffer(4096), length(0) {
+}
+
+ProcFile::ProcFile(const char* path) : ProcFile() {
+    open(path);
+}
+
+ProcFile::~ProcFile() {
+    close();
+}
+
+bool ProcFile::open(const char* path) {
+    close();
+    fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    countSyscalls(1);
+    return fd >= 0;
+}
+
+void ProcFile::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        countSyscalls(1);
+        fd = -1;
+    }
+    length = 0;
+}
+
+bool ProcFile::read() {
+    length = 0;
+    if (fd < 0) return false;
+    
+    while (true) {
+        if (length == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        
+        ssize_t n = pread(fd, buffer.data() + length, buffer.size() - length, static_cast<off_t>(length));
+        countSyscalls(1, n > 0 ? static_cast<unsigned long long>(n) : 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            length = 0;
+            return false;
+        }
+        if (n == 0) break;
+        length += static_cast<size_t>(n);
+    }
+    
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef PROCFILE_H
+#define PROCFILE_H
+
+#include <cstddef>
+#include <vector>
+
+// keeps a /proc (or /sys) file descriptor open and re-reads it from offset 0
+// with pread into a buffer that only ever grows, so steady-state reads do not allocate
+class ProcFile {
+public:
+    ProcFile();
+    explicit ProcFile(const char* path);
+    ~ProcFile();
+    
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+    
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    
+    // for poll(), e.g. on /proc/self/mountinfo
+    int descriptor() const { return fd; }
+    
+    // refresh the buffer with the current file contents
+    bool read();
+    
+    const char* begin() const { return buffer.data(); }
+    const char* end() const { return buffer.data() + length; }
+    size_t size() const { return length; }
+    
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t length;
+};
+
+#endif
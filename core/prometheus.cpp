@@ -0,0 +1,308 @@
+#include "prometheus.h"
+#include <cstdio>
+
+static void metric(std::string& out, const char* name, const char* type, const char* help,
+                   const char* labels, double value) {
+    char line[256];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s%s %.15g\n",
+                          name, help, name, type, name, labels, value);
+    if (length > 0) out.append(line, static_cast<size_t>(length) < sizeof(line) ? length : sizeof(line) - 1);
+}
+
+// one family with a sample per core: HELP/TYPE once, then a line per label
+static void coreMetric(std::string& out, const char* name, const char* help,
+                       const CoreUsage& cores, const std::vector<float>& values) {
+    char line[160];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+    if (length > 0) out.append(line, static_cast<size_t>(length));
+    for (size_t i = 0; i < cores.size(); i++) {
+        length = snprintf(line, sizeof(line), "%s{cpu=\"%d\"} %.4g\n", name, cores.ids[i], values[i]);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+// one family with a sample per entry of a table (interface, disk, mount),
+// labelled with the entry's key; label values are escaped as the format requires
+template <typename Entry, typename T>
+static void tableMetric(std::string& out, const char* name, const char* type, const char* help, const char* label,
+                        const std::vector<Entry>& entries, std::string Entry::*key, T Entry::*field) {
+    char line[192];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    if (length > 0) out.append(line, static_cast<size_t>(length));
+    for (const Entry& entry : entries) {
+        out += name;
+        out += '{';
+        out += label;
+        out += "=\"";
+        for (char c : entry.*key) {
+            if (c == '\\' || c == '"') out += '\\';
+            if (c == '\n') {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        length = snprintf(line, sizeof(line), "\"} %.15g\n", static_cast<double>(entry.*field));
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+static double pressureAvg10(const PressureLine& line) { return line.avg10; }
+static double pressureAvg60(const PressureLine& line) { return line.avg60; }
+static double pressureSeconds(const PressureLine& line) { return line.totalUs / 1e6; }
+
+// one family with a sample per psi resource the kernel reports
+static void pressureMetric(std::string& out, const char* name, const char* type, const char* help,
+                           const PressureStats& pressure, bool full, double (*value)(const PressureLine&)) {
+    char line[192];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    if (length > 0) out.append(line, static_cast<size_t>(length));
+    for (int resource = 0; resource < PressureResourceCount; resource++) {
+        const Pressure& entry = pressure.resources[resource];
+        if (!entry.available) continue;
+        length = snprintf(line, sizeof(line), "%s{resource=\"%s\"} %.15g\n", name, pressureResourceName(resource),
+                          value(full ? entry.full : entry.some));
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+static void pressureMetrics(std::string& out, const PressureStats& pressure) {
+    const char* some = "Time some tasks stalled on the resource";
+    const char* full = "Time all non-idle tasks stalled on the resource";
+    char help[96];
+    
+    snprintf(help, sizeof(help), "%s, 10s average.", some);
+    pressureMetric(out, "syspulse_pressure_some_avg10_percent", "gauge", help, pressure, false, pressureAvg10);
+    snprintf(help, sizeof(help), "%s, 60s average.", some);
+    pressureMetric(out, "syspulse_pressure_some_avg60_percent", "gauge", help, pressure, false, pressureAvg60);
+    snprintf(help, sizeof(help), "%s.", some);
+    pressureMetric(out, "syspulse_pressure_some_stalled_seconds_total", "counter", help, pressure, false, pressureSeconds);
+    snprintf(help, sizeof(help), "%s, 10s average.", full);
+    pressureMetric(out, "syspulse_pressure_full_avg10_percent", "gauge", help, pressure, true, pressureAvg10);
+    snprintf(help, sizeof(help), "%s, 60s average.", full);
+    pressureMetric(out, "syspulse_pressure_full_avg60_percent", "gauge", help, pressure, true, pressureAvg60);
+    snprintf(help, sizeof(help), "%s.", full);
+    pressureMetric(out, "syspulse_pressure_full_stalled_seconds_total", "counter", help, pressure, true, pressureSeconds);
+    
+    if (pressure.triggers.empty()) return;
+    out += "# HELP syspulse_pressure_trigger_events_total Times a --psi-trigger threshold was crossed.\n"
+           "# TYPE syspulse_pressure_trigger_events_total counter\n";
+    char line[192];
+    for (const PressureTrigger& trigger : pressure.triggers) {
+        int length = snprintf(line, sizeof(line),
+                              "syspulse_pressure_trigger_events_total{resource=\"%s\",kind=\"%s\",stall_ms=\"%u\",window_ms=\"%u\"} %llu\n",
+                              pressureResourceName(trigger.resource), trigger.full ? "full" : "some",
+                              trigger.stallUs / 1000, trigger.windowUs / 1000, trigger.events);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+// one gauge family with a sample per statistic, labelled stat="..."
+static void statMetric(std::string& out, const char* name, const char* help,
+                       const char* const* stats, const double* values, int count) {
+    char line[192];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+    if (length > 0) out.append(line, static_cast<size_t>(length));
+    for (int i = 0; i < count; i++) {
+        length = snprintf(line, sizeof(line), "%s{stat=\"%s\"} %.15g\n", name, stats[i], values[i]);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+// min/mean/max of the fast samples since the last snapshot
+static void summaryMetric(std::string& out, const char* name, const char* help, const MetricSummary& summary) {
+    static const char* const stats[] = {"min", "mean", "max"};
+    const double values[] = {summary.min, summary.mean, summary.max};
+    statMetric(out, name, help, stats, values, 3);
+}
+
+static void fastMetrics(std::string& out, const FastStats& fast) {
+    summaryMetric(out, "syspulse_cpu_usage_burst_percent", "CPU busy time of the fast samples over the last interval.", fast.cpu);
+    summaryMetric(out, "syspulse_memory_usage_burst_percent", "Memory in use in the fast samples over the last interval.", fast.memory);
+    summaryMetric(out, "syspulse_network_receive_burst_bytes_per_second", "Receive rate of the fast samples over the last interval.", fast.netRx);
+    summaryMetric(out, "syspulse_network_transmit_burst_bytes_per_second", "Transmit rate of the fast samples over the last interval.", fast.netTx);
+    metric(out, "syspulse_fast_sample_period_seconds", "gauge", "Period of the fast sampler.", "", fast.periodMs / 1000.0);
+    metric(out, "syspulse_fast_samples", "gauge", "Fast samples taken over the last interval.", "", fast.samples);
+    static const char* const jitterStats[] = {"mean", "max"};
+    const double jitter[] = {fast.jitterMeanMs / 1000.0, fast.jitterMaxMs / 1000.0};
+    statMetric(out, "syspulse_fast_sample_jitter_seconds", "How late the fast sampler woke over the last interval.",
+               jitterStats, jitter, 2);
+    metric(out, "syspulse_fast_samples_missed_total", "counter", "Fast sampler ticks lost to late wakeups.", "",
+           static_cast<double>(fast.missedTotal));
+}
+
+// one family with a sample per collector that has run
+static void collectorMetric(std::string& out, const char* name, const char* help, const SelfStats& self,
+                            unsigned long long CollectorStats::*field) {
+    char line[192];
+    int length = snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+    if (length > 0) out.append(line, static_cast<size_t>(length));
+    for (int collector = 0; collector < CollectorCount; collector++) {
+        const CollectorStats& stats = self.collectors[collector];
+        if (stats.calls == 0) continue;
+        length = snprintf(line, sizeof(line), "%s{collector=\"%s\"} %llu\n", name, collectorName(collector), stats.*field);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+}
+
+static void eventMetrics(std::string& out, const ProcessEventCounts& events) {
+    metric(out, "syspulse_process_forks_total", "counter", "Processes forked since the proc connector subscription.", "",
+           static_cast<double>(events.forks));
+    metric(out, "syspulse_process_execs_total", "counter", "Execs since the proc connector subscription.", "",
+           static_cast<double>(events.execs));
+    metric(out, "syspulse_process_exits_total", "counter", "Processes exited since the proc connector subscription.", "",
+           static_cast<double>(events.exits));
+    metric(out, "syspulse_process_event_corrections_total", "counter", "Pids a consistency walk of /proc had to add or remove.", "",
+           static_cast<double>(events.corrections));
+    metric(out, "syspulse_process_event_overflows_total", "counter", "Times the proc connector socket dropped events.", "",
+           static_cast<double>(events.overflows));
+}
+
+static void selfMetrics(std::string& out, const SelfStats& self) {
+    // the power-of-two microsecond buckets as a cumulative histogram
+    const char* name = "syspulse_collector_duration_seconds";
+    out += "# HELP syspulse_collector_duration_seconds Wall time of one pass of each collector.\n"
+           "# TYPE syspulse_collector_duration_seconds histogram\n";
+    char line[192];
+    for (int collector = 0; collector < CollectorCount; collector++) {
+        const CollectorStats& stats = self.collectors[collector];
+        if (stats.calls == 0) continue;
+        const char* label = collectorName(collector);
+        unsigned long long cumulative = 0;
+        for (int bucket = 0; bucket < CollectorStats::Buckets - 1; bucket++) {
+            cumulative += stats.buckets[bucket];
+            int length = snprintf(line, sizeof(line), "%s_bucket{collector=\"%s\",le=\"%.6g\"} %llu\n", name, label,
+                                  CollectorStats::bucketLimitUs(bucket) / 1e6, cumulative);
+            if (length > 0) out.append(line, static_cast<size_t>(length));
+        }
+        int length = snprintf(line, sizeof(line), "%s_bucket{collector=\"%s\",le=\"+Inf\"} %llu\n", name, label, stats.calls);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+        length = snprintf(line, sizeof(line), "%s_sum{collector=\"%s\"} %.9g\n", name, label, stats.totalUs / 1e6);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+        length = snprintf(line, sizeof(line), "%s_count{collector=\"%s\"} %llu\n", name, label, stats.calls);
+        if (length > 0) out.append(line, static_cast<size_t>(length));
+    }
+    collectorMetric(out, "syspulse_collector_syscalls_total", "Syscalls made by each collector.", self,
+                    &CollectorStats::totalSyscalls);
+    collectorMetric(out, "syspulse_collector_read_bytes_total", "Bytes each collector read from /proc and /sys.", self,
+                    &CollectorStats::totalBytes);
+    metric(out, "syspulse_self_cpu_usage_percent", "gauge", "CPU used by the monitor itself over the last interval, 100 per cpu.", "",
+           self.cpuPercent);
+    metric(out, "syspulse_self_resident_bytes", "gauge", "Resident memory of the monitor itself.", "",
+           static_cast<double>(self.rssBytes));
+}
+
+void renderPrometheus(const Snapshot& snapshot, std::string& out) {
+    const SystemStats& stats = snapshot.stats;
+    const CoreUsage& cores = snapshot.cores;
+    out.clear();
+    
+    metric(out, "syspulse_cpu_usage_percent", "gauge", "CPU busy time over the last interval.", "", stats.cpu);
+    metric(out, "syspulse_cpu_iowait_percent", "gauge", "CPU time waiting on io over the last interval.", "", stats.cpuIowait);
+    metric(out, "syspulse_cpu_steal_percent", "gauge", "CPU time stolen by the hypervisor over the last interval.", "", stats.cpuSteal);
+    if (cores.size() > 0) {
+        coreMetric(out, "syspulse_cpu_core_busy_percent", "Per-core busy time over the last interval.", cores, cores.busy);
+        coreMetric(out, "syspulse_cpu_core_iowait_percent", "Per-core io wait over the last interval.", cores, cores.iowait);
+        coreMetric(out, "syspulse_cpu_core_steal_percent", "Per-core steal over the last interval.", cores, cores.steal);
+    }
+    metric(out, "syspulse_cpu_cores", "gauge", "Online CPU cores.", "", stats.cores);
+    metric(out, "syspulse_memory_usage_percent", "gauge", "Memory in use (MemTotal - MemAvailable).", "", stats.memory);
+    metric(out, "syspulse_memory_total_bytes", "gauge", "MemTotal from /proc/meminfo.", "", stats.memTotal * 1024.0);
+    metric(out, "syspulse_memory_available_bytes", "gauge", "MemAvailable from /proc/meminfo.", "", stats.memAvailable * 1024.0);
+    if (!snapshot.mounts.empty()) {
+        const std::vector<MountUsage>& mounts = snapshot.mounts;
+        tableMetric(out, "syspulse_disk_usage_percent", "gauge", "Space used on the filesystem.", "mountpoint",
+                    mounts, &MountUsage::mountPoint, &MountUsage::percent);
+        tableMetric(out, "syspulse_disk_total_bytes", "gauge", "Size of the filesystem.", "mountpoint",
+                    mounts, &MountUsage::mountPoint, &MountUsage::total);
+        tableMetric(out, "syspulse_disk_used_bytes", "gauge", "Space used on the filesystem.", "mountpoint",
+                    mounts, &MountUsage::mountPoint, &MountUsage::used);
+        tableMetric(out, "syspulse_disk_available_bytes", "gauge", "Space available to unprivileged users.", "mountpoint",
+                    mounts, &MountUsage::mountPoint, &MountUsage::available);
+    } else {
+        metric(out, "syspulse_disk_usage_percent", "gauge", "Space used on the filesystem.", "{mountpoint=\"/\"}", stats.disk);
+        metric(out, "syspulse_disk_total_bytes", "gauge", "Size of the filesystem.", "{mountpoint=\"/\"}", static_cast<double>(stats.diskTotal));
+        metric(out, "syspulse_disk_used_bytes", "gauge", "Space used on the filesystem.", "{mountpoint=\"/\"}", static_cast<double>(stats.diskUsed));
+    }
+    if (!snapshot.devices.empty()) {
+        const std::vector<DeviceStats>& devices = snapshot.devices;
+        std::string DeviceStats::*device = &DeviceStats::name;
+        tableMetric(out, "syspulse_disk_reads_completed_total", "counter", "Reads completed.", "device",
+                    devices, device, &DeviceStats::reads);
+        tableMetric(out, "syspulse_disk_writes_completed_total", "counter", "Writes completed.", "device",
+                    devices, device, &DeviceStats::writes);
+        tableMetric(out, "syspulse_disk_read_bytes_total", "counter", "Bytes read.", "device",
+                    devices, device, &DeviceStats::readBytes);
+        tableMetric(out, "syspulse_disk_written_bytes_total", "counter", "Bytes written.", "device",
+                    devices, device, &DeviceStats::writtenBytes);
+        tableMetric(out, "syspulse_disk_read_bytes_per_second", "gauge", "Read throughput over the last interval.", "device",
+                    devices, device, &DeviceStats::readBytesPerSecond);
+        tableMetric(out, "syspulse_disk_write_bytes_per_second", "gauge", "Write throughput over the last interval.", "device",
+                    devices, device, &DeviceStats::writeBytesPerSecond);
+        tableMetric(out, "syspulse_disk_reads_per_second", "gauge", "Read IOPS over the last interval.", "device",
+                    devices, device, &DeviceStats::readsPerSecond);
+        tableMetric(out, "syspulse_disk_writes_per_second", "gauge", "Write IOPS over the last interval.", "device",
+                    devices, device, &DeviceStats::writesPerSecond);
+        tableMetric(out, "syspulse_disk_queue_depth", "gauge", "Average requests in flight over the last interval.", "device",
+                    devices, device, &DeviceStats::queueDepth);
+        tableMetric(out, "syspulse_disk_await_milliseconds", "gauge", "Average time per completed request.", "device",
+                    devices, device, &DeviceStats::awaitMs);
+        tableMetric(out, "syspulse_disk_utilization_percent", "gauge", "Time with io in flight over the last interval.", "device",
+                    devices, device, &DeviceStats::utilization);
+    }
+    metric(out, "syspulse_network_receive_bytes_total", "counter", "Bytes received on all non-loopback interfaces.", "", static_cast<double>(stats.netRxBytes));
+    metric(out, "syspulse_network_transmit_bytes_total", "counter", "Bytes sent on all non-loopback interfaces.", "", static_cast<double>(stats.netTxBytes));
+    metric(out, "syspulse_network_receive_bytes_per_second", "gauge", "Receive rate over the last interval.", "", static_cast<double>(stats.netRxSpeed));
+    metric(out, "syspulse_network_transmit_bytes_per_second", "gauge", "Transmit rate over the last interval.", "", static_cast<double>(stats.netTxSpeed));
+    if (!snapshot.interfaces.empty()) {
+        const std::vector<InterfaceStats>& list = snapshot.interfaces;
+        std::string InterfaceStats::*device = &InterfaceStats::name;
+        tableMetric(out, "syspulse_network_device_receive_bytes_total", "counter", "Bytes received.", "device",
+                    list, device, &InterfaceStats::rxBytes);
+        tableMetric(out, "syspulse_network_device_transmit_bytes_total", "counter", "Bytes sent.", "device",
+                    list, device, &InterfaceStats::txBytes);
+        tableMetric(out, "syspulse_network_device_receive_packets_total", "counter", "Packets received.", "device",
+                    list, device, &InterfaceStats::rxPackets);
+        tableMetric(out, "syspulse_network_device_transmit_packets_total", "counter", "Packets sent.", "device",
+                    list, device, &InterfaceStats::txPackets);
+        tableMetric(out, "syspulse_network_device_receive_errors_total", "counter", "Receive errors.", "device",
+                    list, device, &InterfaceStats::rxErrors);
+        tableMetric(out, "syspulse_network_device_transmit_errors_total", "counter", "Transmit errors.", "device",
+                    list, device, &InterfaceStats::txErrors);
+        tableMetric(out, "syspulse_network_device_receive_drop_total", "counter", "Received packets dropped.", "device",
+                    list, device, &InterfaceStats::rxDrops);
+        tableMetric(out, "syspulse_network_device_transmit_drop_total", "counter", "Outgoing packets dropped.", "device",
+                    list, device, &InterfaceStats::txDrops);
+        tableMetric(out, "syspulse_network_device_receive_bytes_per_second", "gauge", "Receive rate over the last interval.", "device",
+                    list, device, &InterfaceStats::rxRate);
+        tableMetric(out, "syspulse_network_device_transmit_bytes_per_second", "gauge", "Transmit rate over the last interval.", "device",
+                    list, device, &InterfaceStats::txRate);
+    }
+    metric(out, "syspulse_processes", "gauge", "Processes in /proc.", "", stats.processes);
+    if (snapshot.events.active) eventMetrics(out, snapshot.events);
+    metric(out, "syspulse_uptime_seconds", "gauge", "Time since boot.", "", stats.uptime);
+    if (stats.temperature > 0) {
+        metric(out, "syspulse_temperature_celsius", "gauge", "CPU temperature.", "{zone=\"thermal_zone0\"}", stats.temperature);
+    }
+    if (snapshot.fast.samples > 0) fastMetrics(out, snapshot.fast);
+    if (snapshot.self.collectors[CollectCpu].calls > 0) selfMetrics(out, snapshot.self);
+    if (!snapshot.cgroups.empty()) {
+        const std::vector<CgroupStats>& groups = snapshot.cgroups;
+        tableMetric(out, "syspulse_cgroup_cpu_usage_percent", "gauge", "CPU used by the cgroup over the last interval, 100 per cpu.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::cpuPercent);
+        tableMetric(out, "syspulse_cgroup_memory_bytes", "gauge", "memory.current of the cgroup.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::memoryCurrent);
+        tableMetric(out, "syspulse_cgroup_memory_max_bytes", "gauge", "memory.max of the cgroup, 0 without a limit.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::memoryMax);
+        tableMetric(out, "syspulse_cgroup_read_bytes_total", "counter", "Bytes read by the cgroup.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::readBytes);
+        tableMetric(out, "syspulse_cgroup_written_bytes_total", "counter", "Bytes written by the cgroup.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::writtenBytes);
+        tableMetric(out, "syspulse_cgroup_pids", "gauge", "pids.current of the cgroup.", "cgroup",
+                    groups, &CgroupStats::path, &CgroupStats::pids);
+    }
+    bool pressure = false;
+    for (const Pressure& entry : snapshot.pressure.resources) pressure = pressure || entry.available;
+    if (pressure) pressureMetrics(out, snapshot.pressure);
+    metric(out, "syspulse_sample_timestamp_seconds", "gauge", "Unix time the sample was taken.", "", stats.timestamp);
+}
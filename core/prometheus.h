@@ -0,0 +1,14 @@
+#ifndef PROMETHEUS_H
+#define PROMETHEUS_H
+
+#include <string>
+#include "snapshot.h"
+
+// render a sample in the prometheus text exposition format (version 0.0.4).
+// out is cleared and refilled, so reusing one string keeps its capacity and
+// steady-state renders do not allocate.
+// per-core, per-interface, per-disk and per-mount series are added for
+// whichever of those tables the snapshot has.
+void renderPrometheus(const Snapshot& snapshot, std::string& out);
+
+#endif
@@ -0,0 +1,246 @@
+#include "recorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace recording;
+
+static void putBytes(std::vector<uint8_t>& out, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+static void padTo8(std::vector<uint8_t>& out) {
+    out.resize((out.size() + 7) & ~static_cast<size_t>(7), 0);
+}
+
+static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+Recorder::Recorder(const std::string& directory, bool withProcesses, size_t segmentBytes)
+    : directory(directory), withProcesses(withProcesses), segmentBytes(segmentBytes),
+      fd(-1), sequence(0), segmentSize(0), headerBytes(0),
+      streams(columns().size()), deltaEncoders(columns().size()), xorEncoders(columns().size()),
+      sampleCount(0), blockHasProcesses(false), firstTime(0), lastTime(0) {
+}
+
+Recorder::~Recorder() {
+    close();
+}
+
+bool Recorder::fail(const std::string& what) {
+    errorText = what + ": " + strerror(errno);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return false;
+}
+
+bool Recorder::open() {
+    if (fd >= 0) return true;
+    
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return fail("cannot create " + directory);
+    }
+    
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return fail("cannot open " + directory);
+    
+    // never overwrite an earlier run: continue after the highest segment
+    sequence = 0;
+    while (dirent* entry = readdir(dir)) {
+        unsigned number;
+        char suffix[8];
+        if (sscanf(entry->d_name, "segment-%u.%7s", &number, suffix) == 2 &&
+            strcmp(suffix, "spr") == 0) {
+            sequence = std::max(sequence, number);
+        }
+    }
+    closedir(dir);
+    
+    resetBlock();
+    return startSegment();
+}
+
+bool Recorder::startSegment() {
+    if (fd >= 0) ::close(fd);
+    
+    sequence++;
+    std::string path = directory + "/" + segmentName(sequence);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return fail("cannot create " + path);
+    
+    const std::vector<Column>& list = columns();
+    std::vector<uint8_t> prologue;
+    
+    SegmentHeader header;
+    memcpy(header.magic, SegmentMagic, sizeof(header.magic));
+    header.version = Version;
+    header.columnCount = static_cast<uint32_t>(list.size());
+    putBytes(prologue, &header, sizeof(header));
+    
+    for (const Column& column : list) {
+        size_t length = strlen(column.name);
+        prologue.push_back(column.kind());
+        prologue.push_back(static_cast<uint8_t>(length));
+        putBytes(prologue, column.name, length);
+    }
+    padTo8(prologue);
+    
+    segmentSize = 0;
+    headerBytes = prologue.size();
+    return writeAll(prologue.data(), prologue.size());
+}
+
+bool Recorder::writeAll(const void* data, size_t length) {
+    const char* pos = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t written = ::write(fd, pos, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return fail("write to " + directory + " failed");
+        }
+        pos += written;
+        length -= static_cast<size_t>(written);
+        segmentSize += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void Recorder::resetBlock() {
+    for (BitWriter& stream : streams) stream.clear();
+    for (DeltaEncoder& encoder : deltaEncoders) encoder.reset();
+    for (XorEncoder& encoder : xorEncoders) encoder.reset();
+    sampleCount = 0;
+    blockHasProcesses = false;
+    processRows.clear();
+    stringTable.clear();
+    blockStrings.clear();
+}
+
+uint32_t Recorder::blockString(uint32_t poolId, const StringPool& strings) {
+    auto found = blockStrings.find(poolId);
+    if (found != blockStrings.end()) return found->second;
+    
+    uint32_t index = static_cast<uint32_t>(blockStrings.size());
+    blockStrings.emplace(poolId, index);
+    putVarint(stringTable, strings.length(poolId));
+    putBytes(stringTable, strings.data(poolId), strings.length(poolId));
+    return index;
+}
+
+bool Recorder::append(const SystemStats& stats, const std::vector<ProcessInfo>* processes,
+                      const StringPool* strings) {
+    if (fd < 0) return false;
+    
+    // block times match the millisecond timestamps readers decode
+    double time = std::llround(stats.timestamp * 1000.0) / 1000.0;
+    
+    if (sampleCount > 0 && time - firstTime >= BlockSeconds) {
+        if (!flush()) return false;
+    }
+    
+    const std::vector<Column>& list = columns();
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].kind() == XorColumn) {
+            xorEncoders[i].append(streams[i], list[i].doubleValue(stats));
+        } else {
+            deltaEncoders[i].append(streams[i], list[i].integerValue(stats));
+        }
+    }
+    
+    if (sampleCount == 0) firstTime = time;
+    lastTime = time;
+    sampleCount++;
+    
+    // every sample gets a row count so readers can stay in step; samples
+    // taken without a process list record zero rows
+    if (withProcesses) {
+        bool hasList = processes && strings;
+        putVarint(processRows, hasList ? processes->size() : 0);
+        if (hasList) {
+            blockHasProcesses = true;
+            int previousPid = 0;
+            for (const ProcessInfo& process : *processes) {
+                putVarint(processRows, zigzag(static_cast<int64_t>(process.pid) - previousPid));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.cpu, 0.0) * 10.0)));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.memory, 0.0) * 100.0)));
+                putVarint(processRows, blockString(process.nameId, *strings));
+                putVarint(processRows, blockString(process.userId, *strings));
+                putVarint(processRows, zigzag(static_cast<int64_t>(process.ppid) - process.pid));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.readBytesPerSecond, 0.0))));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.writeBytesPerSecond, 0.0))));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.readCallsPerSecond, 0.0) * 10.0)));
+                putVarint(processRows, static_cast<uint64_t>(std::llround(std::max(process.writeCallsPerSecond, 0.0) * 10.0)));
+                previousPid = process.pid;
+            }
+        }
+    }
+    
+    if (sampleCount >= BlockSamples) return flush();
+    return true;
+}
+
+bool Recorder::flush() {
+    if (fd < 0) return false;
+    if (sampleCount == 0) return true;
+    
+    const std::vector<Column>& list = columns();
+    output.clear();
+    output.resize(sizeof(BlockHeader));
+    
+    for (const BitWriter& stream : streams) {
+        uint32_t length = static_cast<uint32_t>(stream.data().size());
+        putBytes(output, &length, sizeof(length));
+    }
+    
+    std::vector<uint8_t> stringCount;
+    if (blockHasProcesses) putVarint(stringCount, blockStrings.size());
+    uint32_t processBytes = blockHasProcesses
+        ? static_cast<uint32_t>(stringCount.size() + stringTable.size() + processRows.size())
+        : 0;
+    putBytes(output, &processBytes, sizeof(processBytes));
+    
+    for (size_t i = 0; i < list.size(); i++) {
+        putBytes(output, streams[i].data().data(), streams[i].data().size());
+    }
+    if (blockHasProcesses) {
+        putBytes(output, stringCount.data(), stringCount.size());
+        putBytes(output, stringTable.data(), stringTable.size());
+        putBytes(output, processRows.data(), processRows.size());
+    }
+    padTo8(output);
+    
+    BlockHeader header;
+    header.magic = BlockMagic;
+    header.sampleCount = sampleCount;
+    header.byteLength = static_cast<uint32_t>(output.size());
+    header.flags = blockHasProcesses ? HasProcesses | HasParents | HasIo : 0;
+    header.firstTime = firstTime;
+    header.lastTime = lastTime;
+    memcpy(output.data(), &header, sizeof(header));
+    
+    resetBlock();
+    
+    // rotate before the block so a segment never ends with a partial one
+    if (segmentSize > headerBytes && segmentSize + output.size() > segmentBytes) {
+        if (!startSegment()) return false;
+    }
+    return writeAll(output.data(), output.size());
+}
+
+void Recorder::close() {
+    if (fd < 0) return;
+    flush();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
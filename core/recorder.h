@@ -0,0 +1,80 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "gorilla.h"
+#include "recording.h"
+#include "stringpool.h"
+
+// appends samples to a --record directory (layout in recording.h).
+// samples are encoded column by column into an in-memory block which is
+// written with a single write(2) once it holds BlockSamples samples or spans
+// BlockSeconds; a segment is closed and the next one started once it grows
+// past the size limit. not thread-safe: feed it from one thread.
+class Recorder {
+public:
+    static const uint32_t BlockSamples = 240;
+    static const int BlockSeconds = 300;
+    
+    Recorder(const std::string& directory, bool withProcesses = false,
+             size_t segmentBytes = 8 * 1024 * 1024);
+    ~Recorder();
+    
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+    
+    // creates the directory if needed and continues after the last segment
+    // already in it; false with error() set on failure
+    bool open();
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    
+    bool recordsProcesses() const { return withProcesses; }
+    
+    // processes/strings may be null when the sample has no process list;
+    // false once a write has failed, and the recorder closes itself
+    bool append(const SystemStats& stats, const std::vector<ProcessInfo>* processes,
+                const StringPool* strings);
+    
+    // write out the pending block now
+    bool flush();
+    
+    const std::string& error() const { return errorText; }
+    
+private:
+    bool startSegment();
+    bool writeAll(const void* data, size_t length);
+    bool fail(const std::string& what);
+    void resetBlock();
+    uint32_t blockString(uint32_t poolId, const StringPool& strings);
+    
+    std::string directory;
+    bool withProcesses;
+    size_t segmentBytes;
+    std::string errorText;
+    
+    int fd;
+    unsigned sequence;
+    size_t segmentSize;
+    size_t headerBytes;
+    
+    // pending block
+    std::vector<BitWriter> streams;
+    std::vector<DeltaEncoder> deltaEncoders;
+    std::vector<XorEncoder> xorEncoders;
+    uint32_t sampleCount;
+    bool blockHasProcesses;
+    double firstTime;
+    double lastTime;
+    
+    std::vector<uint8_t> processRows;
+    std::vector<uint8_t> stringTable;
+    std::unordered_map<uint32_t, uint32_t> blockStrings;
+    std::vector<uint8_t> output;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "recording.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace recording {
+
+#define COLUMN(member, field) { #member, Column::field, offsetof(SystemStats, member), 1.0 }
+#define FIXED(member, scale) { #member, Column::Fixed, offsetof(SystemStats, member), scale }
+
+const std::vector<Column>& columns() {
+    static const std::vector<Column> list = {
+        COLUMN(timestamp, Time),
+        COLUMN(cpu, Double),
+        COLUMN(memory, Double),
+        COLUMN(disk, Double),
+        COLUMN(uptime, Double),
+        COLUMN(processes, Int),
+        COLUMN(cores, Int),
+        COLUMN(temperature, Double),
+        COLUMN(memTotal, UInt64),
+        COLUMN(memAvailable, UInt64),
+        COLUMN(diskTotal, UInt64),
+        COLUMN(diskUsed, UInt64),
+        COLUMN(netRxBytes, UInt64),
+        COLUMN(netTxBytes, UInt64),
+        COLUMN(netRxSpeed, UInt64),
+        COLUMN(netTxSpeed, UInt64),
+        COLUMN(cpuIowait, Double),
+        COLUMN(cpuSteal, Double),
+        COLUMN(pressureCpuSome, Double),
+        COLUMN(pressureCpuFull, Double),
+        COLUMN(pressureMemorySome, Double),
+        COLUMN(pressureMemoryFull, Double),
+        COLUMN(pressureIoSome, Double),
+        COLUMN(pressureIoFull, Double),
+        COLUMN(cpuPeak, Double),
+        FIXED(collectCpuUs, 1.0),
+        FIXED(collectMemoryUs, 1.0),
+        FIXED(collectDiskUs, 1.0),
+        FIXED(collectNetworkUs, 1.0),
+        FIXED(collectProcessesUs, 1.0),
+        FIXED(collectPressureUs, 1.0),
+        FIXED(collectCgroupsUs, 1.0),
+        FIXED(collectSystemUs, 1.0),
+        COLUMN(collectSyscalls, UInt64),
+        COLUMN(collectBytes, UInt64),
+        FIXED(selfCpu, 100.0),
+        COLUMN(selfRss, UInt64),
+        COLUMN(forkRate, Double),
+        COLUMN(exitRate, Double),
+    };
+    return list;
+}
+
+#undef COLUMN
+#undef FIXED
+
+double Column::doubleValue(const SystemStats& stats) const {
+    double value;
+    memcpy(&value, reinterpret_cast<const char*>(&stats) + offset, sizeof(value));
+    return value;
+}
+
+int64_t Column::integerValue(const SystemStats& stats) const {
+    const char* base = reinterpret_cast<const char*>(&stats) + offset;
+    switch (field) {
+    case Time: {
+        double seconds;
+        memcpy(&seconds, base, sizeof(seconds));
+        return static_cast<int64_t>(std::llround(seconds * 1000.0));
+    }
+    case Int: {
+        int value;
+        memcpy(&value, base, sizeof(value));
+        return value;
+    }
+    case UInt64: {
+        unsigned long long value;
+        memcpy(&value, base, sizeof(value));
+        return static_cast<int64_t>(value);
+    }
+    case Fixed: {
+        double value;
+        memcpy(&value, base, sizeof(value));
+        return static_cast<int64_t>(std::llround(value * scale));
+    }
+    default:
+        return 0;
+    }
+}
+
+void Column::setDouble(SystemStats& stats, double value) const {
+    memcpy(reinterpret_cast<char*>(&stats) + offset, &value, sizeof(value));
+}
+
+void Column::setInteger(SystemStats& stats, int64_t value) const {
+    char* base = reinterpret_cast<char*>(&stats) + offset;
+    switch (field) {
+    case Time: {
+        double seconds = value / 1000.0;
+        memcpy(base, &seconds, sizeof(seconds));
+        break;
+    }
+    case Int: {
+        int narrow = static_cast<int>(value);
+        memcpy(base, &narrow, sizeof(narrow));
+        break;
+    }
+    case UInt64: {
+        unsigned long long wide = static_cast<unsigned long long>(value);
+        memcpy(base, &wide, sizeof(wide));
+        break;
+    }
+    case Fixed: {
+        double scaled = value / scale;
+        memcpy(base, &scaled, sizeof(scaled));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+std::string segmentName(unsigned sequence) {
+    char name[32];
+    snprintf(name, sizeof(name), "segment-%06u.spr", sequence);
+    return name;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+}
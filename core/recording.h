@@ -0,0 +1,90 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "systemstats.h"
+
+// on-disk layout of a --record directory, shared by the writer and readers.
+//
+// a recording is a directory of segment files (segment-000001.spr, ...).
+// all fixed-size fields are little-endian and every block starts on an
+// 8-byte boundary, so a segment can be mmap()ed and walked in place:
+//
+//   segment: SegmentHeader, column descriptors (kind, name length, name),
+//            zero padding to 8, then blocks until end of file
+//   block:   BlockHeader, uint32 byte count per column, uint32 byte count
+//            of the process section, the column bit streams, the process
+//            section, zero padding to 8
+//
+// columns are Gorilla-compressed per block (see gorilla.h), so each block
+// decodes on its own. the process section holds varint rows per sample
+// after a per-block string table; blocks flagged HasParents carry the
+// ppid as a sixth field of each row, and blocks flagged HasIo (always with
+// HasParents) four io rates after it.
+namespace recording {
+
+const char SegmentMagic[8] = {'S', 'Y', 'S', 'P', 'U', 'L', 'S', 'E'};
+const uint32_t Version = 1;
+const uint32_t BlockMagic = 0x4b425053;    // "SPBK"
+
+enum ColumnKind : uint8_t {
+    XorColumn = 0,      // doubles
+    DeltaColumn = 1     // integers, timestamps in milliseconds
+};
+
+enum BlockFlags : uint32_t {
+    HasProcesses = 1,
+    HasParents = 2,     // process rows end with zigzag(ppid - pid)
+    HasIo = 4           // then read and write bytes/s, read and write calls/s * 10
+};
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t sampleCount;
+    uint32_t byteLength;    // whole block including header and padding
+    uint32_t flags;
+    double firstTime;       // unix seconds
+    double lastTime;
+};
+
+// one SystemStats field; columns are matched by name when reading so the
+// struct can grow without breaking older files. Fixed columns are noisy
+// doubles (timings, percentages) stored as integers of 1/scale in a delta
+// column, which costs a fraction of their full-precision XOR encoding
+struct Column {
+    enum Field { Time, Double, Int, UInt64, Fixed };
+    
+    const char* name;
+    Field field;
+    size_t offset;
+    double scale;                       // Fixed only
+    
+    ColumnKind kind() const { return field == Double ? XorColumn : DeltaColumn; }
+    
+    double doubleValue(const SystemStats& stats) const;
+    int64_t integerValue(const SystemStats& stats) const;
+    void setDouble(SystemStats& stats, double value) const;
+    void setInteger(SystemStats& stats, int64_t value) const;
+};
+
+const std::vector<Column>& columns();
+
+// file name of segment `sequence` inside a recording directory
+std::string segmentName(unsigned sequence);
+
+// little-endian base-128 varints for the process section
+void putVarint(std::vector<uint8_t>& out, uint64_t value);
+bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value);
+
+}
+
+#endif
@@ -0,0 +1,382 @@
+#include "recordingreader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace recording;
+
+RecordingReader::RecordingReader()
+    : samples(0), cachedBlock(SIZE_MAX), rowFields(5), processBegin(nullptr), processEnd(nullptr) {
+}
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+void RecordingReader::close() {
+    for (const Segment& segment : segments) {
+        munmap(const_cast<uint8_t*>(segment.base), segment.length);
+    }
+    segments.clear();
+    blocks.clear();
+    samples = 0;
+    cachedBlock = SIZE_MAX;
+}
+
+bool RecordingReader::open(const std::string& path) {
+    close();
+    errorText.clear();
+    
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        errorText = path + ": " + strerror(errno);
+        return false;
+    }
+    
+    if (S_ISDIR(info.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            errorText = path + ": " + strerror(errno);
+            return false;
+        }
+        
+        std::vector<unsigned> sequences;
+        while (dirent* entry = readdir(dir)) {
+            unsigned number;
+            char suffix[8];
+            if (sscanf(entry->d_name, "segment-%u.%7s", &number, suffix) == 2 &&
+                strcmp(suffix, "spr") == 0) {
+                sequences.push_back(number);
+            }
+        }
+        closedir(dir);
+        
+        std::sort(sequences.begin(), sequences.end());
+        for (unsigned sequence : sequences) mapSegment(path + "/" + segmentName(sequence));
+    } else {
+        mapSegment(path);
+    }
+    
+    if (blocks.empty()) {
+        if (errorText.empty()) errorText = path + ": no recorded samples";
+        return false;
+    }
+    
+    // runs are appended in order, but keep seeking correct if a clock stepped
+    std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+        return a.firstTime < b.firstTime;
+    });
+    return true;
+}
+
+bool RecordingReader::mapSegment(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        errorText = path + ": " + strerror(errno);
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+        ::close(fd);
+        errorText = path + ": not a recording";
+        return false;
+    }
+    
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        errorText = path + ": " + strerror(errno);
+        return false;
+    }
+    
+    Segment segment;
+    segment.base = static_cast<const uint8_t*>(mapped);
+    segment.length = length;
+    
+    SegmentHeader header;
+    memcpy(&header, segment.base, sizeof(header));
+    if (memcmp(header.magic, SegmentMagic, sizeof(header.magic)) != 0 || header.version > Version) {
+        munmap(mapped, length);
+        errorText = path + ": not a recording";
+        return false;
+    }
+    segment.columnCount = header.columnCount;
+    
+    // match the file's columns to ours by name and codec
+    const std::vector<Column>& list = columns();
+    size_t offset = sizeof(SegmentHeader);
+    for (uint32_t i = 0; i < header.columnCount; i++) {
+        if (offset + 2 > length || offset + 2 + segment.base[offset + 1] > length) {
+            munmap(mapped, length);
+            errorText = path + ": truncated header";
+            return false;
+        }
+        uint8_t kind = segment.base[offset];
+        std::string name(reinterpret_cast<const char*>(segment.base + offset + 2), segment.base[offset + 1]);
+        offset += 2 + name.size();
+        
+        // Fixed columns were full-precision XOR doubles in older files
+        int local = -1;
+        for (size_t j = 0; j < list.size(); j++) {
+            bool codec = kind == list[j].kind() || (kind == XorColumn && list[j].field == Column::Fixed);
+            if (name == list[j].name && codec) local = static_cast<int>(j);
+        }
+        segment.columnMap.push_back(local);
+        segment.columnKinds.push_back(kind);
+    }
+    offset = (offset + 7) & ~static_cast<size_t>(7);
+    
+    // the block headers are the index; stop at a torn block from a crash
+    size_t index = segments.size();
+    while (offset + sizeof(BlockHeader) <= length) {
+        BlockHeader block;
+        memcpy(&block, segment.base + offset, sizeof(block));
+        if (block.magic != BlockMagic || block.sampleCount == 0 ||
+            block.byteLength < sizeof(BlockHeader) || block.byteLength > length - offset) {
+            break;
+        }
+        
+        blocks.push_back({segment.base + offset, index, block.sampleCount, block.flags,
+                          block.firstTime, block.lastTime});
+        samples += block.sampleCount;
+        offset += block.byteLength;
+    }
+    
+    segments.push_back(std::move(segment));
+    return true;
+}
+
+double RecordingReader::startTime() const {
+    return blocks.empty() ? 0.0 : blocks.front().firstTime;
+}
+
+double RecordingReader::endTime() const {
+    return blocks.empty() ? 0.0 : blocks.back().lastTime;
+}
+
+bool RecordingReader::decode(size_t index) {
+    if (index == cachedBlock) return true;
+    cachedBlock = SIZE_MAX;
+    
+    const Block& block = blocks[index];
+    const Segment& segment = segments[block.segment];
+    BlockHeader header;
+    memcpy(&header, block.data, sizeof(header));
+    
+    size_t tableBytes = (segment.columnCount + 1) * sizeof(uint32_t);
+    if (sizeof(BlockHeader) + tableBytes > header.byteLength) return false;
+    
+    std::vector<uint32_t> lengths(segment.columnCount + 1);
+    memcpy(lengths.data(), block.data + sizeof(BlockHeader), tableBytes);
+    
+    const uint8_t* pos = block.data + sizeof(BlockHeader) + tableBytes;
+    const uint8_t* end = block.data + header.byteLength;
+    
+    // columns this build does not know stay zero
+    const std::vector<Column>& list = columns();
+    cachedStats.assign(block.sampleCount, SystemStats());
+    for (uint32_t i = 0; i < segment.columnCount; i++) {
+        if (lengths[i] > static_cast<size_t>(end - pos)) return false;
+        
+        int local = segment.columnMap[i];
+        if (local >= 0) {
+            const Column& column = list[local];
+            BitReader reader(pos, lengths[i]);
+            if (segment.columnKinds[i] == XorColumn) {
+                XorDecoder decoder;
+                for (SystemStats& stats : cachedStats) column.setDouble(stats, decoder.next(reader));
+            } else {
+                DeltaDecoder decoder;
+                for (SystemStats& stats : cachedStats) column.setInteger(stats, decoder.next(reader));
+            }
+            if (reader.overrun()) return false;
+        }
+        pos += lengths[i];
+    }
+    
+    // process section: string table, then one row group per sample
+    rowOffsets.clear();
+    blockStrings.clear();
+    processBegin = processEnd = nullptr;
+    uint32_t processBytes = lengths[segment.columnCount];
+    if ((block.flags & HasProcesses) && processBytes <= static_cast<size_t>(end - pos)) {
+        const uint8_t* cursor = pos;
+        const uint8_t* limit = pos + processBytes;
+        
+        uint64_t count;
+        bool valid = getVarint(cursor, limit, count);
+        for (uint64_t i = 0; valid && i < count; i++) {
+            uint64_t length;
+            valid = getVarint(cursor, limit, length) && length <= static_cast<size_t>(limit - cursor);
+            if (valid) {
+                blockStrings.push_back(stringPool.intern(reinterpret_cast<const char*>(cursor), length));
+                cursor += length;
+            }
+        }
+        
+        processBegin = pos;
+        processEnd = limit;
+        rowFields = (block.flags & HasIo) ? 10 : (block.flags & HasParents) ? 6 : 5;
+        for (uint32_t i = 0; valid && i < block.sampleCount; i++) {
+            rowOffsets.push_back(static_cast<size_t>(cursor - pos));
+            uint64_t rows, value;
+            valid = getVarint(cursor, limit, rows);
+            for (uint64_t j = 0; valid && j < rows * rowFields; j++) valid = getVarint(cursor, limit, value);
+        }
+        
+        // a damaged process section only costs the process list
+        if (!valid) rowOffsets.clear();
+    }
+    
+    cachedBlock = index;
+    return true;
+}
+
+bool RecordingReader::seek(double time, Position& position) {
+    if (blocks.empty()) return false;
+    
+    // last block starting at or before time
+    auto found = std::upper_bound(blocks.begin(), blocks.end(), time, [](double t, const Block& block) {
+        return t < block.firstTime;
+    });
+    size_t index = found == blocks.begin() ? 0 : static_cast<size_t>(found - blocks.begin()) - 1;
+    
+    if (!decode(index)) return false;
+    
+    auto sample = std::upper_bound(cachedStats.begin(), cachedStats.end(), time, [](double t, const SystemStats& stats) {
+        return t < stats.timestamp;
+    });
+    position.block = index;
+    position.sample = sample == cachedStats.begin() ? 0 : static_cast<uint32_t>(sample - cachedStats.begin()) - 1;
+    return true;
+}
+
+bool RecordingReader::read(const Position& position, Snapshot& out, bool withProcesses) {
+    if (position.block >= blocks.size() || !decode(position.block) ||
+        position.sample >= cachedStats.size()) {
+        return false;
+    }
+    
+    out.stats = cachedStats[position.sample];
+    out.hasProcesses = false;
+    out.processes.clear();
+    if (!withProcesses || position.sample >= rowOffsets.size()) return true;
+    
+    const uint8_t* cursor = processBegin + rowOffsets[position.sample];
+    uint64_t rows;
+    if (!getVarint(cursor, processEnd, rows) || rows == 0) return true;
+    
+    out.processes.reserve(rows);
+    int pid = 0;
+    for (uint64_t i = 0; i < rows; i++) {
+        uint64_t pidDelta, cpu, memory, name, user, parentDelta = 0;
+        uint64_t readBytes = 0, writeBytes = 0, readCalls = 0, writeCalls = 0;
+        getVarint(cursor, processEnd, pidDelta);
+        getVarint(cursor, processEnd, cpu);
+        getVarint(cursor, processEnd, memory);
+        getVarint(cursor, processEnd, name);
+        getVarint(cursor, processEnd, user);
+        if (rowFields > 5) getVarint(cursor, processEnd, parentDelta);
+        if (rowFields > 6) {
+            getVarint(cursor, processEnd, readBytes);
+            getVarint(cursor, processEnd, writeBytes);
+            getVarint(cursor, processEnd, readCalls);
+            getVarint(cursor, processEnd, writeCalls);
+        }
+        
+        pid += static_cast<int>(static_cast<int64_t>(pidDelta >> 1) ^ -static_cast<int64_t>(pidDelta & 1));
+        int parentOffset = static_cast<int>(static_cast<int64_t>(parentDelta >> 1) ^ -static_cast<int64_t>(parentDelta & 1));
+        
+        ProcessInfo process;
+        process.pid = pid;
+        // older recordings have no ppid; every process is then a root
+        process.ppid = rowFields > 5 ? pid + parentOffset : 0;
+        process.cpu = cpu / 10.0;
+        process.memory = memory / 100.0;
+        process.nameId = name < blockStrings.size() ? blockStrings[name] : 0;
+        process.userId = user < blockStrings.size() ? blockStrings[user] : 0;
+        process.readBytesPerSecond = static_cast<double>(readBytes);
+        process.writeBytesPerSecond = static_cast<double>(writeBytes);
+        process.readCallsPerSecond = readCalls / 10.0;
+        process.writeCallsPerSecond = writeCalls / 10.0;
+        out.processes.push_back(process);
+    }
+    out.hasProcesses = true;
+    return true;
+}
+
+bool RecordingReader::advance(Position& position) const {
+    if (position.block >= blocks.size()) return false;
+    
+    if (position.sample + 1 < blocks[position.block].sampleCount) {
+        position.sample++;
+        return true;
+    }
+    if (position.block + 1 >= blocks.size()) return false;
+    
+    position.block++;
+    position.sample = 0;
+    return true;
+}
+
+bool parseTimeArgument(const std::string& text, double reference, double& out) {
+    char* end = nullptr;
+    double seconds = strtod(text.c_str(), &end);
+    if (!text.empty() && *end == '\0') {
+        out = seconds;
+        return true;
+    }
+    
+    time_t base = static_cast<time_t>(reference);
+    struct tm parts;
+    localtime_r(&base, &parts);
+    parts.tm_sec = 0;
+    
+    const char* rest = nullptr;
+    bool dated = false;
+    for (const char* format : {"%Y-%m-%d %H:%M:%S", "%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%dT%H:%M"}) {
+        struct tm candidate = parts;
+        rest = strptime(text.c_str(), format, &candidate);
+        if (rest && *rest == '\0') {
+            parts = candidate;
+            dated = true;
+            break;
+        }
+    }
+    if (!dated) {
+        bool timed = false;
+        for (const char* format : {"%H:%M:%S", "%H:%M"}) {
+            struct tm candidate = parts;
+            rest = strptime(text.c_str(), format, &candidate);
+            if (rest && *rest == '\0') {
+                parts = candidate;
+                timed = true;
+                break;
+            }
+        }
+        if (!timed) return false;
+    }
+    
+    parts.tm_isdst = -1;
+    time_t result = mktime(&parts);
+    if (result == static_cast<time_t>(-1)) return false;
+    
+    if (!dated && result < base) {
+        parts.tm_mday++;
+        parts.tm_isdst = -1;
+        result = mktime(&parts);
+    }
+    out = static_cast<double>(result);
+    return true;
+}
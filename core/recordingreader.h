@@ -0,0 +1,97 @@
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "recording.h"
+#include "sampler.h"
+#include "stringpool.h"
+
+// read side of a --record directory (or a single segment file). segments are
+// mmap()ed and only their block headers are walked on open, which gives a
+// sparse index of one (first, last timestamp) pair per block. seeking is a
+// binary search over that index plus decoding the one block it lands in, so
+// it costs the same however long the recording is. the last decoded block is
+// kept, so stepping through samples in order decodes each block once.
+class RecordingReader {
+public:
+    // a sample inside the recording
+    struct Position {
+        size_t block = 0;
+        uint32_t sample = 0;
+    };
+    
+    RecordingReader();
+    ~RecordingReader();
+    
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+    
+    // false with error() set when nothing readable was found
+    bool open(const std::string& path);
+    void close();
+    const std::string& error() const { return errorText; }
+    
+    bool empty() const { return blocks.empty(); }
+    double startTime() const;
+    double endTime() const;
+    size_t sampleCount() const { return samples; }
+    
+    // last sample at or before time, or the first sample when time is earlier
+    bool seek(double time, Position& position);
+    
+    // decode one sample; process rows are skipped unless withProcesses
+    bool read(const Position& position, Snapshot& out, bool withProcesses = true);
+    
+    // step to the following sample; false at the end of the recording
+    bool advance(Position& position) const;
+    
+    // resolves the name/user ids of snapshots read from this recording
+    const StringPool& strings() const { return stringPool; }
+    
+private:
+    struct Segment {
+        const uint8_t* base;
+        size_t length;
+        uint32_t columnCount;
+        std::vector<int> columnMap;     // file column -> columns() index, -1 if unknown
+        std::vector<uint8_t> columnKinds;   // codec of each file column
+    };
+    
+    struct Block {
+        const uint8_t* data;
+        size_t segment;
+        uint32_t sampleCount;
+        uint32_t flags;
+        double firstTime;
+        double lastTime;
+    };
+    
+    bool mapSegment(const std::string& path);
+    bool decode(size_t block);
+    
+    std::string errorText;
+    std::vector<Segment> segments;
+    std::vector<Block> blocks;
+    size_t samples;
+    
+    // the decoded block
+    size_t cachedBlock;
+    std::vector<SystemStats> cachedStats;
+    std::vector<size_t> rowOffsets;         // per sample, into the process section
+    unsigned rowFields;                     // varints per process row
+    std::vector<uint32_t> blockStrings;     // block string index -> pool id
+    const uint8_t* processBegin;
+    const uint8_t* processEnd;
+    
+    StringPool stringPool;
+};
+
+// "1760670724", "2026-10-17 03:12[:05]" or "03:12[:05]" (local time) to unix
+// seconds; a bare time of day is taken on the day of reference, or the day
+// after when that would fall before reference
+bool parseTimeArgument(const std::string& text, double reference, double& out);
+
+#endif
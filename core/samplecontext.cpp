@@ -0,0 +1,140 @@
+#include "samplecontext.h"
+#include "scanner.h"
+#include "selfstats.h"
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdlib>
+
+SampleContext::SampleContext(const std::string& root)
+    : rootPath(root), procPath(root + "/proc"), tick(1), tickStart(Clock::now()), rootFsValid(false),
+      rootFsTick(0), pidsTick(0), cores(-1), memTotalKb(0), ticksPerSecond(-1) {
+    statSource.file.open((procPath + "/stat").c_str());
+    meminfoSource.file.open((procPath + "/meminfo").c_str());
+    uptimeSource.file.open((procPath + "/uptime").c_str());
+    netDevSource.file.open((procPath + "/net/dev").c_str());
+    diskstatsSource.file.open((procPath + "/diskstats").c_str());
+    temperatureSource.file.open((root + "/sys/class/thermal/thermal_zone0/temp").c_str());
+    pressureSources[0].file.open((procPath + "/pressure/cpu").c_str());
+    pressureSources[1].file.open((procPath + "/pressure/memory").c_str());
+    pressureSources[2].file.open((procPath + "/pressure/io").c_str());
+    
+    for (Source* source : {&statSource, &meminfoSource, &uptimeSource, &netDevSource, &diskstatsSource,
+                           &temperatureSource, &pressureSources[0], &pressureSources[1], &pressureSources[2]}) {
+        source->tick = 0;
+        source->readTime = 0.0;
+    }
+}
+
+void SampleContext::beginTick() {
+    tick++;
+    tickStart = Clock::now();
+}
+
+const ProcFile& SampleContext::refresh(Source& source) {
+    if (source.tick != tick) {
+        source.file.read();
+        source.tick = tick;
+        
+        // taken right after the read, so a late tick still gets exact rates
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        source.readTime = now.tv_sec + now.tv_nsec / 1e9;
+    }
+    return source.file;
+}
+
+const ProcFile& SampleContext::stat() {
+    return refresh(statSource);
+}
+
+const ProcFile& SampleContext::meminfo() {
+    return refresh(meminfoSource);
+}
+
+const ProcFile& SampleContext::uptime() {
+    return refresh(uptimeSource);
+}
+
+const ProcFile& SampleContext::netDev() {
+    return refresh(netDevSource);
+}
+
+const ProcFile& SampleContext::diskstats() {
+    return refresh(diskstatsSource);
+}
+
+const ProcFile& SampleContext::temperature() {
+    return refresh(temperatureSource);
+}
+
+const ProcFile& SampleContext::pressure(int resource) {
+    return refresh(pressureSources[resource]);
+}
+
+const struct statvfs* SampleContext::rootFs() {
+    if (rootFsTick != tick) {
+        rootFsValid = statvfs(rootPath.empty() ? "/" : rootPath.c_str(), &rootFsStat) == 0;
+        countSyscalls(1);
+        rootFsTick = tick;
+    }
+    return rootFsValid ? &rootFsStat : nullptr;
+}
+
+const std::vector<int>& SampleContext::pids() {
+    if (pidsTick == tick) return pidList;
+    pidsTick = tick;
+    
+    pidList.clear();
+    DIR* dir = opendir(procPath.c_str());
+    countSyscalls(1);
+    if (!dir) return pidList;
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_type == DT_DIR) {
+            int pid = atoi(entry->d_name);
+            if (pid > 0) pidList.push_back(pid);
+        }
+    }
+    closedir(dir);
+    // the getdents calls behind readdir are not visible here; at least the
+    // final empty one and the close
+    countSyscalls(2);
+    return pidList;
+}
+
+int SampleContext::coreCount() {
+    if (cores >= 0) return cores;
+    
+    // one "cpuN" line per online cpu in /proc/stat, after the aggregate line
+    cores = 0;
+    const ProcFile& file = stat();
+    Scanner sc(file.begin(), file.end());
+    sc.skipLine();
+    while (sc.consume("cpu", 3)) {
+        cores++;
+        sc.skipLine();
+    }
+    return cores;
+}
+
+unsigned long long SampleContext::memTotal() {
+    if (memTotalKb > 0) return memTotalKb;
+    
+    const ProcFile& file = meminfo();
+    Scanner sc(file.begin(), file.end());
+    if (sc.findLine("MemTotal:", 9)) memTotalKb = sc.parseU64();
+    return memTotalKb;
+}
+
+long SampleContext::clockTicks() {
+    if (ticksPerSecond < 0) ticksPerSecond = sysconf(_SC_CLK_TCK);
+    return ticksPerSecond;
+}
+
+void SampleContext::invalidateInvariants() {
+    cores = -1;
+    memTotalKb = 0;
+    ticksPerSecond = -1;
+}
@@ -0,0 +1,90 @@
+#ifndef SAMPLECONTEXT_H
+#define SAMPLECONTEXT_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/statvfs.h>
+#include "procfile.h"
+
+// the data sources of one sampling tick. each accessor reads its source
+// lazily and at most once per tick, so collectors that need the same file
+// share one read. values that do not change while the system is up (core
+// count, MemTotal, clock ticks) are cached until invalidateInvariants().
+// every path is taken below root, so a fixture tree can stand in for /proc
+// and /sys; empty for the live system.
+class SampleContext {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    explicit SampleContext(const std::string& root = std::string());
+    
+    const std::string& root() const { return rootPath; }
+    
+    // start a new tick: every per-tick source becomes stale
+    void beginTick();
+    Clock::time_point tickTime() const { return tickStart; }
+    unsigned tickNumber() const { return tick; }
+    
+    const ProcFile& stat();
+    const ProcFile& meminfo();
+    const ProcFile& uptime();
+    const ProcFile& netDev();
+    // CLOCK_MONOTONIC seconds at which netDev() was last read, for rates
+    double netDevTime() const { return netDevSource.readTime; }
+    const ProcFile& diskstats();
+    double diskstatsTime() const { return diskstatsSource.readTime; }
+    const ProcFile& temperature();
+    // /proc/pressure/<resource>, see PressureResource; empty without PSI
+    const ProcFile& pressure(int resource);
+    
+    // nullptr when statvfs(root) fails
+    const struct statvfs* rootFs();
+    
+    // pids found in /proc, in directory order
+    const std::vector<int>& pids();
+    
+    // invariants
+    int coreCount();
+    unsigned long long memTotal();     // kB
+    long clockTicks();
+    
+    // force the invariants to be re-read, e.g. after cpu or memory hotplug
+    void invalidateInvariants();
+    
+private:
+    // a persistent ProcFile plus the tick and monotonic time it was last read at
+    struct Source {
+        ProcFile file;
+        unsigned tick;
+        double readTime;
+    };
+    
+    const ProcFile& refresh(Source& source);
+    
+    std::string rootPath;
+    std::string procPath;               // root + "/proc", for the pid walk
+    unsigned tick;
+    Clock::time_point tickStart;
+    
+    Source statSource;
+    Source meminfoSource;
+    Source uptimeSource;
+    Source netDevSource;
+    Source diskstatsSource;
+    Source temperatureSource;
+    Source pressureSources[3];
+    
+    struct statvfs rootFsStat;
+    bool rootFsValid;
+    unsigned rootFsTick;
+    
+    std::vector<int> pidList;
+    unsigned pidsTick;
+    
+    int cores;
+    unsigned long long memTotalKb;
+    long ticksPerSecond;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "sampler.h"
+
+Sampler::Sampler(int intervalMs)
+    : sequence(0), interval(intervalMs),
+      running(false), sampleRequested(false), processesRequested(false),
+      collectProcesses(true), recorder(nullptr) {
+}
+
+Sampler::~Sampler() {
+    stop();
+}
+
+void Sampler::start(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    
+    onSample = std::move(callback);
+    running = true;
+    ticker.start(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+    thread = std::thread(&Sampler::run, this);
+}
+
+void Sampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    ticker.interrupt();
+    if (thread.joinable()) thread.join();
+    ticker.stop();
+    
+    std::lock_guard<std::mutex> lock(fastMutex);
+    fast.stop();
+}
+
+bool Sampler::setFastInterval(int periodMs) {
+    std::lock_guard<std::mutex> lock(fastMutex);
+    if (periodMs <= 0) {
+        fast.stop();
+        return true;
+    }
+    return fast.start(periodMs);
+}
+
+void Sampler::setCollectProcesses(bool enabled) {
+    collectProcesses.store(enabled, std::memory_order_relaxed);
+}
+
+bool Sampler::addPressureTrigger(const std::string& spec, std::string& error) {
+    PressureTriggers& triggers = collector.pressureTriggers();
+    if (triggers.add(spec)) return true;
+    error = triggers.error();
+    return false;
+}
+
+void Sampler::setRecorder(Recorder* target) {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    recorder = target;
+}
+
+void Sampler::requestSample(bool withProcesses) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sampleRequested = true;
+        processesRequested = processesRequested || withProcesses;
+    }
+    ticker.interrupt();
+}
+
+void Sampler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    while (running) {
+        bool withProcesses = processesRequested || collectProcesses.load(std::memory_order_relaxed);
+        sampleRequested = false;
+        processesRequested = false;
+        lock.unlock();
+        
+        std::unique_lock<std::mutex> recording(recorderMutex);
+        if (recorder && recorder->recordsProcesses()) withProcesses = true;
+        
+        // the back buffer belongs to this thread until publish()
+        Snapshot& snapshot = buffer.back();
+        snapshot.sequence = ++sequence;
+        collector.collect(snapshot, withProcesses);
+        fast.take(snapshot.fast);
+        snapshot.stats.cpuPeak = snapshot.fast.samples > 0 ? snapshot.fast.cpu.max : snapshot.stats.cpu;
+        if (recorder) {
+            recorder->append(snapshot.stats, withProcesses ? &snapshot.processes : nullptr,
+                             &collector.strings());
+        }
+        recording.unlock();
+        buffer.publish();
+        
+        if (onSample) onSample();
+        
+        // requestSample() and stop() cut the wait short; the schedule stays put
+        ticker.wait();
+        lock.lock();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "fastsampler.h"
+#include "recorder.h"
+#include "snapshot.h"
+#include "systemcollector.h"
+#include "ticker.h"
+#include "triplebuffer.h"
+
+// runs a SystemCollector on its own thread so slow /proc reads never block
+// the caller. snapshots are handed over through a TripleBuffer; the consumer
+// polls with update() and renders latest(). passes run on a Ticker, so the
+// interval does not stretch by the time a pass takes, and a FastSampler
+// summarises the cheap metrics between passes into Snapshot::fast.
+class Sampler {
+public:
+    explicit Sampler(int intervalMs = 2000);
+    ~Sampler();
+    
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+    
+    // onSample runs on the sampler thread after each publish; keep it cheap
+    void start(std::function<void()> onSample = nullptr);
+    void stop();
+    
+    // sample cpu, memory and network every periodMs (10-100) between passes;
+    // 0 turns it off. safe from any thread
+    bool setFastInterval(int periodMs);
+    
+    // walk /proc/<pid> on every pass, or only when requested
+    void setCollectProcesses(bool enabled);
+    
+    // forwarded to SystemCollector::setScanThreads; safe from any thread
+    void setScanThreads(int threads) { collector.setScanThreads(threads); }
+    
+    // forwarded to PressureTriggers::add; false with error set when refused
+    bool addPressureTrigger(const std::string& spec, std::string& error);
+    
+    // forwarded to SystemCollector::trackProcessEvents; safe from any thread
+    bool trackProcessEvents(std::string& error) { return collector.trackProcessEvents(error); }
+    
+    // append every sample to recorder on the sampler thread; waits for a
+    // pass in progress, so after setRecorder(nullptr) the old one is unused
+    void setRecorder(Recorder* recorder);
+    
+    // wake the sampler now instead of at the next interval
+    void requestSample(bool withProcesses);
+    
+    // consumer side
+    bool update() { return buffer.update(); }
+    const Snapshot& latest() const { return buffer.front(); }
+    
+    // resolves the name/user ids of latest().processes
+    const StringPool& strings() const { return collector.strings(); }
+    
+private:
+    void run();
+    
+    SystemCollector collector;
+    TripleBuffer<Snapshot> buffer;
+    std::function<void()> onSample;
+    unsigned long long sequence;
+    
+    std::chrono::milliseconds interval;
+    Ticker ticker;
+    FastSampler fast;
+    std::mutex fastMutex;
+    std::thread thread;
+    std::mutex mutex;
+    bool running;
+    bool sampleRequested;
+    bool processesRequested;
+    std::atomic<bool> collectProcesses;
+    
+    std::mutex recorderMutex;
+    Recorder* recorder;
+};
+
+#endif
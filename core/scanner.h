@@ -0,0 +1,100 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <cstddef>
+#include <cstring>
+
+// forward-only tokenizer over a ProcFile buffer; never allocates
+struct Scanner {
+    const char* pos;
+    const char* end;
+    
+    Scanner(const char* begin, const char* end) : pos(begin), end(end) {}
+    
+    bool atEnd() const { return pos >= end; }
+    
+    void skipSpaces() {
+        while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+    }
+    
+    void skipLine() {
+        const char* nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+        pos = nl ? nl + 1 : end;
+    }
+    
+    // skip one whitespace-delimited token
+    void skipToken() {
+        skipSpaces();
+        while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\n') pos++;
+    }
+    
+    void skipTokens(int count) {
+        for (int i = 0; i < count; i++) skipToken();
+    }
+    
+    // true (and consumes the literal) when the current position starts with it
+    bool consume(const char* literal, size_t len) {
+        if (static_cast<size_t>(end - pos) < len || memcmp(pos, literal, len) != 0) return false;
+        pos += len;
+        return true;
+    }
+    
+    // advance to the line starting with prefix and stop just after it;
+    // call from the start of a line or right after a parsed value
+    bool findLine(const char* prefix, size_t len) {
+        while (pos < end) {
+            if (consume(prefix, len)) return true;
+            skipLine();
+        }
+        return false;
+    }
+    
+    // advance to the character c and step past it
+    bool skipPast(char c) {
+        const char* p = static_cast<const char*>(memchr(pos, c, end - pos));
+        if (!p) {
+            pos = end;
+            return false;
+        }
+        pos = p + 1;
+        return true;
+    }
+    
+    unsigned long long parseU64() {
+        skipSpaces();
+        unsigned long long value = 0;
+        while (pos < end && static_cast<unsigned>(*pos - '0') < 10) {
+            value = value * 10 + static_cast<unsigned>(*pos - '0');
+            pos++;
+        }
+        return value;
+    }
+    
+    long long parseI64() {
+        skipSpaces();
+        bool negative = pos < end && *pos == '-';
+        if (negative) pos++;
+        long long value = static_cast<long long>(parseU64());
+        return negative ? -value : value;
+    }
+    
+    // plain decimal "123.45", which is all /proc emits
+    double parseDouble() {
+        skipSpaces();
+        bool negative = pos < end && *pos == '-';
+        if (negative) pos++;
+        double value = static_cast<double>(parseU64());
+        if (pos < end && *pos == '.') {
+            pos++;
+            double scale = 0.1;
+            while (pos < end && static_cast<unsigned>(*pos - '0') < 10) {
+                value += (*pos - '0') * scale;
+                scale *= 0.1;
+                pos++;
+            }
+        }
+        return negative ? -value : value;
+    }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "selfstats.h"
+#include "procfile.h"
+#include "scanner.h"
+#include <sys/resource.h>
+#include <unistd.h>
+
+IoCounters& threadIo() {
+    static thread_local IoCounters counters = {};
+    return counters;
+}
+
+const char* collectorName(int collector) {
+    static const char* const names[] = {"cpu", "memory", "disk", "network", "processes", "pressure", "cgroups", "system"};
+    return collector >= 0 && collector < CollectorCount ? names[collector] : "";
+}
+
+double CollectorStats::percentileUs(double p) const {
+    if (calls == 0) return 0.0;
+    unsigned long long target = static_cast<unsigned long long>(p * calls + 0.5);
+    if (target == 0) target = 1;
+    unsigned long long seen = 0;
+    for (int i = 0; i < Buckets; i++) {
+        seen += buckets[i];
+        if (seen >= target) return bucketLimitUs(i) < maxUs ? bucketLimitUs(i) : maxUs;
+    }
+    return maxUs;
+}
+
+double SelfStats::lastUs() const {
+    double total = 0.0;
+    for (const CollectorStats& collector : collectors) total += collector.lastUs;
+    return total;
+}
+
+unsigned long long SelfStats::lastSyscalls() const {
+    unsigned long long total = 0;
+    for (const CollectorStats& collector : collectors) total += collector.lastSyscalls;
+    return total;
+}
+
+unsigned long long SelfStats::lastBytes() const {
+    unsigned long long total = 0;
+    for (const CollectorStats& collector : collectors) total += collector.lastBytes;
+    return total;
+}
+
+SelfMonitor::SelfMonitor()
+    : current(), lastCpuSeconds(-1.0), statm("/proc/self/statm"),
+      pageSize(static_cast<unsigned long long>(sysconf(_SC_PAGESIZE))) {
+}
+
+SelfMonitor::Scope::Scope(SelfMonitor& owner, int id)
+    : monitor(owner), collector(id), start(std::chrono::steady_clock::now()), io(threadIo()) {
+}
+
+SelfMonitor::Scope::~Scope() {
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    const IoCounters& after = threadIo();
+    monitor.record(collector, us, after.syscalls - io.syscalls, after.bytes - io.bytes);
+}
+
+void SelfMonitor::beginPass() {
+    for (CollectorStats& collector : current.collectors) {
+        collector.lastUs = 0.0;
+        collector.lastSyscalls = 0;
+        collector.lastBytes = 0;
+    }
+}
+
+void SelfMonitor::record(int collector, double us, unsigned long long syscalls, unsigned long long bytes) {
+    CollectorStats& stats = current.collectors[collector];
+    stats.calls++;
+    stats.lastUs += us;
+    stats.lastSyscalls += syscalls;
+    stats.lastBytes += bytes;
+    stats.totalUs += us;
+    stats.totalSyscalls += syscalls;
+    stats.totalBytes += bytes;
+    if (us > stats.maxUs) stats.maxUs = us;
+    
+    int bucket = 0;
+    while (bucket < CollectorStats::Buckets - 1 && us >= CollectorStats::bucketLimitUs(bucket)) bucket++;
+    stats.buckets[bucket]++;
+}
+
+void SelfMonitor::updateProcess() {
+    // every thread of the process, the pool and the fast sampler included
+    struct rusage usage;
+    auto now = std::chrono::steady_clock::now();
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        double seconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        double elapsed = std::chrono::duration<double>(now - lastCpuSample).count();
+        current.cpuPercent = lastCpuSeconds >= 0.0 && elapsed > 0.0 ? 100.0 * (seconds - lastCpuSeconds) / elapsed : 0.0;
+        lastCpuSeconds = seconds;
+        lastCpuSample = now;
+    }
+    
+    // resident pages are the second field of statm
+    if (statm.read()) {
+        Scanner sc(statm.begin(), statm.end());
+        sc.parseU64();
+        current.rssBytes = sc.parseU64() * pageSize;
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef SELFSTATS_H
+#define SELFSTATS_H
+
+#include <chrono>
+#include "procfile.h"
+
+// syscalls made and bytes read by the calling thread. ProcFile and the other
+// readers of /proc and /sys add to these, so the cost of a piece of code is
+// the difference around it
+struct IoCounters {
+    unsigned long long syscalls;
+    unsigned long long bytes;
+};
+
+IoCounters& threadIo();
+
+inline void countSyscalls(unsigned long long syscalls, unsigned long long bytes = 0) {
+    IoCounters& io = threadIo();
+    io.syscalls += syscalls;
+    io.bytes += bytes;
+}
+
+enum CollectorId {
+    CollectCpu,
+    CollectMemory,
+    CollectDisk,
+    CollectNetwork,
+    CollectProcesses,
+    CollectPressure,
+    CollectCgroups,
+    CollectSystem,                      // uptime, temperature, pid count
+    CollectorCount
+};
+
+// "cpu", "memory", ...
+const char* collectorName(int collector);
+
+// wall time histogram plus the io of one collector. bucket i counts passes
+// that took less than 2^i microseconds (and at least 2^(i-1)); the last one
+// also takes everything slower
+struct CollectorStats {
+    static const int Buckets = 24;
+    
+    unsigned long long calls;
+    double lastUs;
+    unsigned long long lastSyscalls;
+    unsigned long long lastBytes;
+    double totalUs;
+    unsigned long long totalSyscalls;
+    unsigned long long totalBytes;
+    double maxUs;
+    unsigned buckets[Buckets];
+    
+    // upper bound of the bucket holding the p-th fraction of passes
+    double percentileUs(double p) const;
+    static double bucketLimitUs(int bucket) { return static_cast<double>(1ULL << bucket); }
+};
+
+// the monitor's own cost, per collector and as a whole
+struct SelfStats {
+    CollectorStats collectors[CollectorCount];
+    double cpuPercent;                  // of one cpu, the whole process over the last interval
+    unsigned long long rssBytes;
+    
+    // totals of the last pass over every collector
+    double lastUs() const;
+    unsigned long long lastSyscalls() const;
+    unsigned long long lastBytes() const;
+};
+
+// measures the collectors of one SystemCollector. a Scope around a section
+// adds its wall time, syscalls and bytes to that collector's stats
+class SelfMonitor {
+public:
+    SelfMonitor();
+    
+    class Scope {
+    public:
+        Scope(SelfMonitor& monitor, int collector);
+        ~Scope();
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+    private:
+        SelfMonitor& monitor;
+        int collector;
+        std::chrono::steady_clock::time_point start;
+        IoCounters io;
+    };
+    
+    // start of a pass: clears the last-pass figures, so collectors that do
+    // not run this time (the process list) report zero
+    void beginPass();
+    
+    // process cpu and rss, once per pass
+    void updateProcess();
+    
+    const SelfStats& stats() const { return current; }
+    
+private:
+    void record(int collector, double us, unsigned long long syscalls, unsigned long long bytes);
+    
+    SelfStats current;
+    std::chrono::steady_clock::time_point lastCpuSample;
+    double lastCpuSeconds;
+    ProcFile statm;                     // /proc/self/statm, kept open
+    unsigned long long pageSize;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <vector>
+#include "cgroupstats.h"
+#include "cpustats.h"
+#include "diskstats.h"
+#include "fastsampler.h"
+#include "netstats.h"
+#include "pressure.h"
+#include "procevents.h"
+#include "selfstats.h"
+#include "systemstats.h"
+
+// everything one sampling pass produced; read-only once published
+struct Snapshot {
+    unsigned long long sequence = 0;
+    SystemStats stats = {};
+    bool hasProcesses = false;
+    std::vector<ProcessInfo> processes;
+    CoreUsage cores;
+    std::vector<InterfaceStats> interfaces;
+    std::vector<DeviceStats> devices;
+    std::vector<MountUsage> mounts;
+    PressureStats pressure = {};
+    std::vector<CgroupStats> cgroups;
+    FastStats fast = {};
+    SelfStats self = {};
+    ProcessEventCounts events = {};
+};
+
+#endif
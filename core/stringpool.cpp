@@ -0,0 +1,86 @@
+#include "stringpool.h"
+#include <cstring>
+
+StringPool::StringPool() : count(0), blockUsed(BlockSize), index(1024, 0) {
+    for (uint32_t i = 0; i < MaxSegments; i++) segments[i] = nullptr;
+    
+    // id 0 is always the empty string
+    intern("", 0);
+}
+
+StringPool::~StringPool() {
+    for (uint32_t i = 0; i < MaxSegments; i++) delete[] segments[i];
+}
+
+uint32_t StringPool::hashOf(const char* text, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(text[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t StringPool::intern(const char* text, size_t length) {
+    uint32_t hash = hashOf(text, length);
+    size_t mask = index.size() - 1;
+    
+    size_t slot = hash & mask;
+    while (index[slot] != 0) {
+        uint32_t id = index[slot] - 1;
+        const Entry& candidate = entry(id);
+        if (candidate.hash == hash && candidate.length == length
+            && memcmp(candidate.text, text, length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+    
+    // the table is full; hand back the empty string rather than grow without bound
+    if (count == MaxSegments * SegmentSize) return 0;
+    
+    uint32_t id = count;
+    Entry*& segment = segments[id >> SegmentBits];
+    if (!segment) segment = new Entry[SegmentSize];
+    segment[id & (SegmentSize - 1)] = {store(text, length), static_cast<uint32_t>(length), hash};
+    count++;
+    
+    index[slot] = id + 1;
+    if (count * 2 > index.size()) growIndex();
+    
+    return id;
+}
+
+const char* StringPool::store(const char* text, size_t length) {
+    size_t needed = length + 1;
+    if (blockUsed + needed > BlockSize) {
+        size_t size = needed > BlockSize ? needed : BlockSize;
+        blocks.emplace_back(new char[size]);
+        blockUsed = 0;
+    }
+    
+    char* out = blocks.back().get() + blockUsed;
+    memcpy(out, text, length);
+    out[length] = '\0';
+    blockUsed += needed;
+    
+    // an oversized string gets a block to itself
+    if (needed > BlockSize) blockUsed = BlockSize;
+    
+    return out;
+}
+
+void StringPool::growIndex() {
+    std::vector<uint32_t> old;
+    old.swap(index);
+    index.assign(old.size() * 2, 0);
+    size_t mask = index.size() - 1;
+    
+    for (uint32_t slotValue : old) {
+        if (slotValue == 0) continue;
+        size_t slot = entry(slotValue - 1).hash & mask;
+        while (index[slot] != 0) slot = (slot + 1) & mask;
+        index[slot] = slotValue;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// append-only interning pool: equal strings get the same small integer id.
+// intern() must only be called from one thread (the sampler). ids handed to
+// another thread through a synchronizing handoff (e.g. the TripleBuffer) can
+// be resolved there with data()/length() while interning goes on, because
+// neither the characters nor the id table are ever moved.
+class StringPool {
+public:
+    StringPool();
+    ~StringPool();
+    
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    
+    uint32_t intern(const char* text, size_t length);
+    uint32_t intern(const std::string& text) { return intern(text.data(), text.size()); }
+    
+    const char* data(uint32_t id) const { return entry(id).text; }
+    size_t length(uint32_t id) const { return entry(id).length; }
+    std::string str(uint32_t id) const { return std::string(data(id), length(id)); }
+    
+    size_t size() const { return count; }
+    
+private:
+    struct Entry {
+        const char* text;
+        uint32_t length;
+        uint32_t hash;
+    };
+    
+    static const uint32_t SegmentBits = 12;
+    static const uint32_t SegmentSize = 1u << SegmentBits;
+    static const uint32_t MaxSegments = 1024;
+    static const size_t BlockSize = 64 * 1024;
+    
+    static uint32_t hashOf(const char* text, size_t length);
+    
+    const Entry& entry(uint32_t id) const {
+        return segments[id >> SegmentBits][id & (SegmentSize - 1)];
+    }
+    
+    const char* store(const char* text, size_t length);
+    void growIndex();
+    
+    // fixed-size table of segment pointers so readers never see it move
+    Entry* segments[MaxSegments];
+    uint32_t count;
+    
+    // character storage, allocated in blocks that are never reallocated
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockUsed;
+    
+    // open-addressing index from hash to id + 1 (0 = empty); writer only
+    std::vector<uint32_t> index;
+};
+
+#endif
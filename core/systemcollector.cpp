@@ -0,0 +1,394 @@
+#include "systemcollector.h"
+#include "scanner.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// below this many pids a single thread is faster than waking the pool
+static const size_t ParallelScanThreshold = 512;
+// pids per stealable task
+static const size_t ScanChunkSize = 64;
+
+SystemCollector::SystemCollector(const std::string& root)
+    : context(root), network(root), disks(root), cgroups(root), procRoot(root + "/proc"), trackedTick(0),
+      eventCounts(), scanThreads(0), users(stringPool), processGeneration(0) {
+}
+
+SystemStats SystemCollector::sample() {
+    SystemStats stats = {};
+    context.beginTick();
+    self.beginPass();
+    stats.timestamp = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    // each section is timed with the /proc reads it triggers, since the
+    // context reads a source on first use in a tick
+    {
+        SelfMonitor::Scope scope(self, CollectCpu);
+        cpus.update(context.stat());
+        stats.cpu = cpus.busy();
+        stats.cpuIowait = cpus.iowait();
+        stats.cpuSteal = cpus.steal();
+    }
+    {
+        SelfMonitor::Scope scope(self, CollectMemory);
+        readMemory(stats);
+    }
+    {
+        SelfMonitor::Scope scope(self, CollectSystem);
+        stats.uptime = readUptime();
+        stats.processes = static_cast<int>(livePids().size());
+        updateEventRates(stats);
+        stats.cores = context.coreCount();
+        stats.temperature = readTemperature();
+    }
+    {
+        // rates use the time between the two reads, not the nominal interval
+        SelfMonitor::Scope scope(self, CollectNetwork);
+        const ProcFile& netDev = context.netDev();
+        network.update(netDev, context.netDevTime());
+        const InterfaceStats& net = network.total();
+        stats.netRxBytes = net.rxBytes;
+        stats.netTxBytes = net.txBytes;
+        stats.netRxSpeed = static_cast<unsigned long long>(net.rxRate);
+        stats.netTxSpeed = static_cast<unsigned long long>(net.txRate);
+    }
+    {
+        SelfMonitor::Scope scope(self, CollectDisk);
+        readDisk(stats);
+        disks.update(context.diskstats(), context.diskstatsTime());
+        disks.updateMounts();
+    }
+    {
+        SelfMonitor::Scope scope(self, CollectPressure);
+        for (int resource = 0; resource < PressureResourceCount; resource++) {
+            pressure.update(resource, context.pressure(resource));
+        }
+        stats.pressureCpuSome = pressure.resource(PressureCpu).some.avg10;
+        stats.pressureCpuFull = pressure.resource(PressureCpu).full.avg10;
+        stats.pressureMemorySome = pressure.resource(PressureMemory).some.avg10;
+        stats.pressureMemoryFull = pressure.resource(PressureMemory).full.avg10;
+        stats.pressureIoSome = pressure.resource(PressureIo).some.avg10;
+        stats.pressureIoFull = pressure.resource(PressureIo).full.avg10;
+    }
+    {
+        SelfMonitor::Scope scope(self, CollectCgroups);
+        cgroups.update(std::chrono::duration<double>(context.tickTime().time_since_epoch()).count());
+    }
+    
+    return stats;
+}
+
+void SystemCollector::collect(Snapshot& out, bool withProcesses) {
+    // plain assignment keeps each vector's capacity across passes
+    out.stats = sample();
+    out.cores = cpus.cores();
+    out.interfaces = network.interfaces();
+    out.devices = disks.devices();
+    out.mounts = disks.mounts();
+    for (int resource = 0; resource < PressureResourceCount; resource++) {
+        out.pressure.resources[resource] = pressure.resource(resource);
+    }
+    triggers.read(out.pressure.triggers);
+    out.cgroups = cgroups.cgroups();
+    out.events = eventCounts;
+    out.hasProcesses = withProcesses;
+    if (withProcesses) {
+        processList(out.processes);
+    } else {
+        out.processes.clear();
+    }
+    
+    // after the process list, so the pass is complete
+    self.updateProcess();
+    const SelfStats& overhead = self.stats();
+    out.stats.collectCpuUs = overhead.collectors[CollectCpu].lastUs;
+    out.stats.collectMemoryUs = overhead.collectors[CollectMemory].lastUs;
+    out.stats.collectDiskUs = overhead.collectors[CollectDisk].lastUs;
+    out.stats.collectNetworkUs = overhead.collectors[CollectNetwork].lastUs;
+    out.stats.collectProcessesUs = overhead.collectors[CollectProcesses].lastUs;
+    out.stats.collectPressureUs = overhead.collectors[CollectPressure].lastUs;
+    out.stats.collectCgroupsUs = overhead.collectors[CollectCgroups].lastUs;
+    out.stats.collectSystemUs = overhead.collectors[CollectSystem].lastUs;
+    out.stats.collectSyscalls = overhead.lastSyscalls();
+    out.stats.collectBytes = overhead.lastBytes();
+    out.stats.selfCpu = overhead.cpuPercent;
+    out.stats.selfRss = overhead.rssBytes;
+    out.self = overhead;
+}
+
+void SystemCollector::readMemory(SystemStats& stats) {
+    unsigned long long memTotal = context.memTotal();
+    unsigned long long memAvailable = 0;
+    
+    const ProcFile& file = context.meminfo();
+    Scanner sc(file.begin(), file.end());
+    if (sc.findLine("MemAvailable:", 13)) memAvailable = sc.parseU64();
+    
+    stats.memTotal = memTotal;
+    stats.memAvailable = memAvailable;
+    stats.memory = memTotal > 0 ? 100.0 * (memTotal - memAvailable) / memTotal : 0.0;
+}
+
+void SystemCollector::readDisk(SystemStats& stats) {
+    const struct statvfs* stat = context.rootFs();
+    if (!stat || stat->f_blocks == 0) {
+        stats.disk = 0.0;
+        stats.diskTotal = 0;
+        stats.diskUsed = 0;
+        return;
+    }
+    
+    unsigned long long total = stat->f_blocks * stat->f_frsize;
+    unsigned long long available = stat->f_bavail * stat->f_frsize;
+    
+    stats.diskTotal = total;
+    stats.diskUsed = (stat->f_blocks - stat->f_bavail) * stat->f_frsize;
+    stats.disk = 100.0 * (total - available) / total;
+}
+
+double SystemCollector::readUptime() {
+    const ProcFile& file = context.uptime();
+    Scanner sc(file.begin(), file.end());
+    return sc.parseDouble();
+}
+
+double SystemCollector::readTemperature() {
+    const ProcFile& file = context.temperature();
+    if (file.size() == 0) return -1.0;
+    Scanner sc(file.begin(), file.end());
+    return sc.parseI64() / 1000.0;
+}
+
+bool SystemCollector::trackProcessEvents(std::string& error) {
+    if (procRoot != "/proc") {
+        error = "process events only describe the live system";
+        return false;
+    }
+    if (events.start()) return true;
+    error = events.error();
+    return false;
+}
+
+const std::vector<int>& SystemCollector::livePids() {
+    if (!events.active()) return context.pids();
+    if (trackedTick == context.tickNumber()) return trackedPids;
+    trackedTick = context.tickNumber();
+    
+    // the serial is taken before the walk, so events racing it win
+    if (events.scanDue(context.tickTime())) {
+        unsigned long long since = events.serial();
+        events.resync(context.pids(), since, context.tickTime());
+    }
+    events.pids(trackedPids);
+    return trackedPids;
+}
+
+void SystemCollector::updateEventRates(SystemStats& stats) {
+    ProcessEventCounts counts = events.counts();
+    auto now = context.tickTime();
+    double elapsed = std::chrono::duration<double>(now - eventTime).count();
+    
+    // rates need two samples with events on
+    stats.forkRate = 0.0;
+    stats.exitRate = 0.0;
+    if (counts.active && eventCounts.active && elapsed > 0.0) {
+        stats.forkRate = (counts.forks - eventCounts.forks) / elapsed;
+        stats.exitRate = (counts.exits - eventCounts.exits) / elapsed;
+    }
+    eventCounts = counts;
+    eventTime = now;
+}
+
+void SystemCollector::setScanThreads(int threads) {
+    scanThreads.store(threads < 0 ? 0 : threads, std::memory_order_relaxed);
+}
+
+int SystemCollector::scanThreadCount() const {
+    int threads = scanThreads.load(std::memory_order_relaxed);
+    if (threads > 0) return threads;
+    
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores <= 2) return 1;
+    return static_cast<int>(std::min(cores / 2, 16u));
+}
+
+bool SystemCollector::readProcess(const std::string& procRoot, int pid, ProcFile& file, RawProcess& out) {
+    char path[512];
+    out.pid = pid;
+    out.ppid = 0;
+    out.nameLength = 0;
+    out.ticks = 0;
+    out.uid = -1;
+    out.rssKb = 0;
+    out.hasIo = false;
+    out.readBytes = 0;
+    out.writeBytes = 0;
+    out.readCalls = 0;
+    out.writeCalls = 0;
+    
+    // name and cpu time; comm may itself contain ')' so take the last one
+    snprintf(path, sizeof(path), "%s/%d/stat", procRoot.c_str(), pid);
+    if (!file.open(path) || !file.read()) return false;
+    
+    Scanner sc(file.begin(), file.end());
+    if (!sc.skipPast('(')) return false;
+    const char* start = sc.pos;
+    const char* end = file.end();
+    while (end > start && end[-1] != ')') end--;
+    if (end == start) return false;
+    size_t length = static_cast<size_t>(end - 1 - start);
+    if (length > sizeof(out.name)) length = sizeof(out.name);
+    memcpy(out.name, start, length);
+    out.nameLength = static_cast<uint32_t>(length);
+    
+    // state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime
+    sc.pos = end;
+    sc.skipTokens(1);
+    out.ppid = static_cast<int>(sc.parseU64());
+    sc.skipTokens(9);
+    unsigned long long utime = sc.parseU64();
+    unsigned long long stime = sc.parseU64();
+    out.ticks = utime + stime;
+    
+    // owner and resident memory; Uid: precedes VmRSS: in every kernel's status layout
+    snprintf(path, sizeof(path), "%s/%d/status", procRoot.c_str(), pid);
+    if (file.open(path) && file.read()) {
+        Scanner st(file.begin(), file.end());
+        if (st.findLine("Uid:", 4)) out.uid = static_cast<int>(st.parseU64());
+        if (st.findLine("VmRSS:", 6)) out.rssKb = st.parseU64();
+    }
+    
+    // io counters, in the order the kernel prints them; only readable for
+    // our own processes unless we may ptrace the others
+    snprintf(path, sizeof(path), "%s/%d/io", procRoot.c_str(), pid);
+    if (file.open(path) && file.read()) {
+        Scanner io(file.begin(), file.end());
+        out.hasIo = io.findLine("syscr:", 6);
+        if (out.hasIo) out.readCalls = io.parseU64();
+        if (io.findLine("syscw:", 6)) out.writeCalls = io.parseU64();
+        if (io.findLine("read_bytes:", 11)) out.readBytes = io.parseU64();
+        if (io.findLine("write_bytes:", 12)) out.writeBytes = io.parseU64();
+    }
+    file.close();
+    
+    return true;
+}
+
+void SystemCollector::scanPids(const std::vector<int>& pids) {
+    int threads = pids.size() < ParallelScanThreshold ? 1 : scanThreadCount();
+    
+    if (threads > 1 && (!scanPool || scanPool->size() != threads)) {
+        scanPool.reset(new WorkerPool(threads));
+    }
+    while (static_cast<int>(scanBuffers.size()) < threads) {
+        scanBuffers.emplace_back(new ScanBuffer());
+    }
+    for (auto& buffer : scanBuffers) {
+        buffer->results.clear();
+        buffer->vanished.clear();
+        buffer->io = IoCounters();
+    }
+    
+    auto scanChunk = [this, &pids](int worker, size_t chunk) {
+        ScanBuffer& buffer = *scanBuffers[worker];
+        IoCounters before = threadIo();
+        size_t end = std::min(pids.size(), (chunk + 1) * ScanChunkSize);
+        for (size_t i = chunk * ScanChunkSize; i < end; i++) {
+            buffer.results.emplace_back();
+            if (!readProcess(procRoot, pids[i], buffer.file, buffer.results.back())) {
+                // exited between the directory walk (or its exit event) and the read
+                buffer.results.pop_back();
+                buffer.vanished.push_back(pids[i]);
+            }
+        }
+        const IoCounters& after = threadIo();
+        buffer.io.syscalls += after.syscalls - before.syscalls;
+        buffer.io.bytes += after.bytes - before.bytes;
+    };
+    
+    size_t chunks = (pids.size() + ScanChunkSize - 1) / ScanChunkSize;
+    if (threads == 1) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) scanChunk(0, chunk);
+    } else {
+        scanPool->run(chunks, scanChunk);
+        
+        // the caller is worker 0 and has counted its own share already
+        for (int worker = 1; worker < threads; worker++) {
+            countSyscalls(scanBuffers[worker]->io.syscalls, scanBuffers[worker]->io.bytes);
+        }
+    }
+}
+
+void SystemCollector::processList(std::vector<ProcessInfo>& processes) {
+    SelfMonitor::Scope scope(self, CollectProcesses);
+    processes.clear();
+    
+    // cpu% and io rates are counter deltas over the monotonic time since the last call
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = processGeneration > 0
+        ? std::chrono::duration<double>(now - lastProcessSample).count() : 0.0;
+    double ticksToPercent = elapsed > 0.0 ? 100.0 / (elapsed * context.clockTicks()) : 0.0;
+    double perSecond = elapsed > 0.0 ? 1.0 / elapsed : 0.0;
+    lastProcessSample = now;
+    unsigned generation = ++processGeneration;
+    
+    unsigned long long memTotal = context.memTotal();
+    
+    scanPids(livePids());
+    
+    // merge the per-thread results; everything touching shared state happens here
+    size_t total = 0;
+    for (auto& buffer : scanBuffers) total += buffer->results.size();
+    processes.reserve(total);
+    
+    for (auto& buffer : scanBuffers) {
+        for (const RawProcess& raw : buffer->results) {
+            ProcessInfo info;
+            info.pid = raw.pid;
+            info.ppid = raw.ppid;
+            info.nameId = stringPool.intern(raw.name, raw.nameLength);
+            info.userId = raw.uid >= 0 ? users.lookup(raw.uid, now) : 0;
+            info.cpu = 0.0;
+            info.memory = memTotal > 0 ? (raw.rssKb * 100.0) / memTotal : 0.0;
+            info.readBytesPerSecond = 0.0;
+            info.writeBytesPerSecond = 0.0;
+            info.readCallsPerSecond = 0.0;
+            info.writeCallsPerSecond = 0.0;
+            
+            bool inserted;
+            ProcessTimes& times = processTimes.insert(raw.pid, inserted);
+            if (!inserted && raw.ticks >= times.ticks) {
+                info.cpu = (raw.ticks - times.ticks) * ticksToPercent;
+            }
+            // a counter that went backwards means the pid was reused
+            if (!inserted && raw.hasIo && times.hasIo && raw.readBytes >= times.readBytes &&
+                raw.writeBytes >= times.writeBytes && raw.readCalls >= times.readCalls &&
+                raw.writeCalls >= times.writeCalls) {
+                info.readBytesPerSecond = (raw.readBytes - times.readBytes) * perSecond;
+                info.writeBytesPerSecond = (raw.writeBytes - times.writeBytes) * perSecond;
+                info.readCallsPerSecond = (raw.readCalls - times.readCalls) * perSecond;
+                info.writeCallsPerSecond = (raw.writeCalls - times.writeCalls) * perSecond;
+            }
+            times.ticks = raw.ticks;
+            times.hasIo = raw.hasIo;
+            times.readBytes = raw.readBytes;
+            times.writeBytes = raw.writeBytes;
+            times.readCalls = raw.readCalls;
+            times.writeCalls = raw.writeCalls;
+            times.generation = generation;
+            
+            processes.push_back(info);
+        }
+        
+        // don't keep asking for a pid whose exit event is still on its way
+        for (int pid : buffer->vanished) events.forget(pid);
+    }
+    
+    // forget pids that were not seen this time round
+    processTimes.removeIf([generation](const ProcessTimes& times) {
+        return times.generation != generation;
+    });
+}
@@ -0,0 +1,158 @@
+#ifndef SYSTEMCOLLECTOR_H
+#define SYSTEMCOLLECTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cgroupstats.h"
+#include "cpustats.h"
+#include "diskstats.h"
+#include "netstats.h"
+#include "pidtable.h"
+#include "pressure.h"
+#include "procevents.h"
+#include "procfile.h"
+#include "samplecontext.h"
+#include "selfstats.h"
+#include "snapshot.h"
+#include "stringpool.h"
+#include "systemstats.h"
+#include "usercache.h"
+#include "workerpool.h"
+
+// reads /proc and /sys; has no qt dependency so the terminal build can link it alone
+class SystemCollector {
+public:
+    // root is prefixed to every /proc and /sys path, e.g. a fixture tree
+    // for benchmarks; empty for the live system. psi triggers always use
+    // the live /proc/pressure
+    explicit SystemCollector(const std::string& root = std::string());
+    
+    // starts a new tick of the sample context and collects system-wide stats
+    SystemStats sample();
+    
+    // per-process stats for the current tick; call after sample() so both
+    // share the same /proc walk and meminfo read. out keeps its capacity, so
+    // a steady process table is refreshed without allocating
+    void processList(std::vector<ProcessInfo>& out);
+    
+    // sample() plus every per-core, per-interface, per-device and per-cgroup table into
+    // out, and the process list when withProcesses; leaves out.sequence alone
+    void collect(Snapshot& out, bool withProcesses);
+    
+    // per-core busy/iowait/steal of the last sample()
+    const CoreUsage& coreUsage() const { return cpus.cores(); }
+    
+    // every network interface of the last sample(), with rates
+    const std::vector<InterfaceStats>& interfaces() const { return network.interfaces(); }
+    
+    // whole-disk io and per-mount usage of the last sample()
+    const std::vector<DeviceStats>& devices() const { return disks.devices(); }
+    const std::vector<MountUsage>& mounts() const { return disks.mounts(); }
+    
+    // every cgroup v2 group of the last sample(), with rates
+    const std::vector<CgroupStats>& cgroupList() const { return cgroups.cgroups(); }
+    
+    // psi stall thresholds, reported with their event counts by collect()
+    PressureTriggers& pressureTriggers() { return triggers; }
+    
+    // wall time, syscalls and bytes read of each collector, and the
+    // monitor's own cpu and rss, as of the last collect()
+    const SelfStats& selfStats() const { return self.stats(); }
+    
+    // resolves ProcessInfo::nameId and userId
+    const StringPool& strings() const { return stringPool; }
+    
+    // re-read cached invariants (core count, MemTotal) on the next sample
+    void invalidateInvariants() { context.invalidateInvariants(); }
+    
+    // keep the pid set from the kernel's process events instead of walking
+    // /proc every sample, with a full walk now and then as a check (see
+    // ProcessEvents). false with error set when the kernel refuses; the
+    // collector then keeps walking /proc, as it does if events stop later.
+    // live system only; safe from any thread
+    bool trackProcessEvents(std::string& error);
+    
+    // threads used for the /proc/<pid> scan; 0 picks a count from the core count.
+    // small machines and small process tables are always scanned on one thread
+    void setScanThreads(int threads);
+    
+private:
+    // raw fields read from /proc/<pid>/{stat,status,io}, before any shared state is touched
+    struct RawProcess {
+        int pid;
+        int ppid;
+        char name[64];
+        uint32_t nameLength;
+        unsigned long long ticks;
+        int uid;
+        unsigned long long rssKb;
+        bool hasIo;                     // /proc/<pid>/io needs ptrace access to the process
+        unsigned long long readBytes;
+        unsigned long long writeBytes;
+        unsigned long long readCalls;
+        unsigned long long writeCalls;
+    };
+    
+    // per-worker scratch so scan threads share nothing
+    struct ScanBuffer {
+        ProcFile file;
+        std::vector<RawProcess> results;
+        std::vector<int> vanished;      // pids whose /proc entry had gone
+        IoCounters io;                  // of this pass, for threads other than the caller
+    };
+    
+    static bool readProcess(const std::string& procRoot, int pid, ProcFile& file, RawProcess& out);
+    void scanPids(const std::vector<int>& pids);
+    int scanThreadCount() const;
+    // the pids of this tick, from process events or a /proc walk
+    const std::vector<int>& livePids();
+    void updateEventRates(SystemStats& stats);
+
+    void readMemory(SystemStats& stats);
+    void readDisk(SystemStats& stats);
+    double readUptime();
+    double readTemperature();
+    
+    // every /proc source goes through the context, which reads it once per tick
+    SampleContext context;
+    CpuCollector cpus;
+    NetCollector network;
+    DiskCollector disks;
+    PressureCollector pressure;
+    CgroupCollector cgroups;
+    PressureTriggers triggers;
+    SelfMonitor self;
+    std::string procRoot;               // root + "/proc"
+    
+    ProcessEvents events;
+    std::vector<int> trackedPids;       // of tick trackedTick
+    unsigned trackedTick;
+    ProcessEventCounts eventCounts;     // as of the last sample()
+    SampleContext::Clock::time_point eventTime;
+    
+    std::atomic<int> scanThreads;
+    std::unique_ptr<WorkerPool> scanPool;
+    std::vector<std::unique_ptr<ScanBuffer>> scanBuffers;
+    
+    StringPool stringPool;
+    UserCache users;
+    
+    // last counters of each pid, for the per-process rates
+    struct ProcessTimes {
+        unsigned long long ticks;
+        bool hasIo;
+        unsigned long long readBytes;
+        unsigned long long writeBytes;
+        unsigned long long readCalls;
+        unsigned long long writeCalls;
+        unsigned generation;
+    };
+    PidTable<ProcessTimes> processTimes;
+    unsigned processGeneration;
+    std::chrono::steady_clock::time_point lastProcessSample;
+};
+
+#endif
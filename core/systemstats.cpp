@@ -0,0 +1,12 @@
+#include "systemstats.h"
+#include <sstream>
+
+std::string formatUptime(double seconds) {
+    int days = seconds / 86400;
+    int hours = (static_cast<int>(seconds) % 86400) / 3600;
+    int minutes = (static_cast<int>(seconds) % 3600) / 60;
+    
+    std::ostringstream oss;
+    oss << days << "d " << hours << "h " << minutes << "m";
+    return oss.str();
+}
@@ -0,0 +1,67 @@
+#ifndef SYSTEMSTATS_H
+#define SYSTEMSTATS_H
+
+#include <cstdint>
+#include <string>
+
+// one sample of system-wide metrics, shared by the gui and terminal front ends
+struct SystemStats {
+    double timestamp;                   // unix time, seconds
+    double cpu;                         // busy %, all cores
+    double cpuIowait;                   // % of cpu time waiting on io
+    double cpuSteal;                    // % of cpu time taken by the hypervisor
+    double memory;
+    double disk;
+    double uptime;                      // seconds
+    int processes;
+    int cores;
+    double temperature;                 // celsius, -1 when unavailable
+    unsigned long long memTotal;        // kB
+    unsigned long long memAvailable;    // kB
+    unsigned long long diskTotal;       // bytes
+    unsigned long long diskUsed;        // bytes
+    unsigned long long netRxBytes;
+    unsigned long long netTxBytes;
+    unsigned long long netRxSpeed;      // bytes per second
+    unsigned long long netTxSpeed;      // bytes per second
+    double pressureCpuSome;             // psi avg10, % of time stalled
+    double pressureCpuFull;
+    double pressureMemorySome;
+    double pressureMemoryFull;
+    double pressureIoSome;
+    double pressureIoFull;
+    double cpuPeak;                     // highest fast sample since the last one, else cpu
+    double collectCpuUs;                // the monitor's own wall time per collector, last pass
+    double collectMemoryUs;
+    double collectDiskUs;
+    double collectNetworkUs;
+    double collectProcessesUs;          // 0 when the pass skipped the process list
+    double collectPressureUs;
+    double collectCgroupsUs;
+    double collectSystemUs;
+    unsigned long long collectSyscalls; // of the whole pass
+    unsigned long long collectBytes;
+    double selfCpu;                     // % of one cpu, every thread of the monitor
+    unsigned long long selfRss;         // bytes
+    double forkRate;                    // processes started per second, 0 unless process events are on
+    double exitRate;
+};
+
+// name and user are ids into the collector's StringPool
+struct ProcessInfo {
+    int pid;
+    int ppid;                           // 0 for init and kthreadd
+    uint32_t nameId;
+    double cpu;
+    double memory;
+    uint32_t userId;
+    double readBytesPerSecond;          // storage io from /proc/<pid>/io; 0 when it cannot be read
+    double writeBytesPerSecond;
+    double readCallsPerSecond;          // read and write syscalls, whatever the file
+    double writeCallsPerSecond;
+};
+
+// "5d 12h 34m"
+std::string formatUptime(double seconds);
+
+#endif
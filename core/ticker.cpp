@@ -0,0 +1,101 @@
+#include "ticker.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static long long monotonicNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+Ticker::Ticker()
+    : timerFd(-1), wakeFd(-1), periodNs(0), nextDeadline(0), lastLateness(0.0), lastMissed(0) {
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+Ticker::~Ticker() {
+    if (timerFd >= 0) close(timerFd);
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool Ticker::start(long long period) {
+    if (timerFd < 0 || wakeFd < 0) {
+        lastError = std::string("timerfd/eventfd: ") + strerror(errno);
+        return false;
+    }
+    if (period <= 0) {
+        lastError = "period must be positive";
+        return false;
+    }
+    
+    periodNs = period;
+    nextDeadline = monotonicNs() + period;
+    itimerspec spec = {};
+    spec.it_value.tv_sec = nextDeadline / 1000000000LL;
+    spec.it_value.tv_nsec = nextDeadline % 1000000000LL;
+    spec.it_interval.tv_sec = period / 1000000000LL;
+    spec.it_interval.tv_nsec = period % 1000000000LL;
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+        lastError = std::string("timerfd_settime: ") + strerror(errno);
+        periodNs = 0;
+        return false;
+    }
+    return true;
+}
+
+void Ticker::stop() {
+    if (timerFd < 0) return;
+    itimerspec spec = {};
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+    periodNs = 0;
+    
+    // an interrupt() nobody waited for must not end the first wait after a restart
+    uint64_t count;
+    ssize_t got = read(wakeFd, &count, sizeof(count));
+    (void)got;
+}
+
+bool Ticker::wait() {
+    if (periodNs <= 0) return false;
+    
+    struct pollfd fds[2] = {};
+    fds[0].fd = timerFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeFd;
+    fds[1].events = POLLIN;
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t got = read(wakeFd, &count, sizeof(count));
+            (void)got;
+            return false;
+        }
+        
+        // the count of deadlines passed since the last read; all but the
+        // newest were missed
+        uint64_t expirations = 0;
+        if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) continue;
+        long long deadline = nextDeadline + static_cast<long long>(expirations - 1) * periodNs;
+        nextDeadline = deadline + periodNs;
+        lastMissed = expirations - 1;
+        lastLateness = (monotonicNs() - deadline) / 1e9;
+        return true;
+    }
+}
+
+void Ticker::interrupt() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
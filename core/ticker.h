@@ -0,0 +1,49 @@
+#ifndef TICKER_H
+#define TICKER_H
+
+#include <string>
+
+// a periodic CLOCK_MONOTONIC timerfd armed with absolute deadlines
+// (start + n * period), so however long the work between two waits takes,
+// later ticks never shift. a tick that could not be waited for in time is
+// counted as missed rather than delivered late, and every wait() measures
+// how far past its deadline it woke.
+class Ticker {
+public:
+    Ticker();
+    ~Ticker();
+    
+    Ticker(const Ticker&) = delete;
+    Ticker& operator=(const Ticker&) = delete;
+    
+    // first deadline one period from now; restarts a running ticker
+    bool start(long long periodNs);
+    // also drops an interrupt() that no wait() has seen
+    void stop();
+    
+    // block until the next deadline; false when woken by interrupt() or
+    // when the ticker is not running
+    bool wait();
+    
+    // wake a wait() in progress, or make the next one return at once;
+    // safe from any thread
+    void interrupt();
+    
+    // of the last wait() that returned true
+    double lateness() const { return lastLateness; }    // seconds past the deadline
+    unsigned long long missed() const { return lastMissed; }
+    
+    long long period() const { return periodNs; }
+    const std::string& error() const { return lastError; }
+    
+private:
+    int timerFd;
+    int wakeFd;
+    long long periodNs;
+    long long nextDeadline;             // ns on CLOCK_MONOTONIC
+    double lastLateness;
+    unsigned long long lastMissed;
+    std::string lastError;
+};
+
+#endif
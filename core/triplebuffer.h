@@ -0,0 +1,44 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// lock-free single-producer/single-consumer handoff of the latest value.
+// the producer fills back() and publish()es it; the consumer calls update()
+// and reads front(), which stays untouched by the producer until the next
+// update(). stale values are dropped, so the consumer only sees the newest.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), backIndex(0), frontIndex(2) {}
+    
+    // producer side
+    T& back() { return buffers[backIndex]; }
+    
+    void publish() {
+        uint8_t previous = middle.exchange(backIndex | FreshBit, std::memory_order_acq_rel);
+        backIndex = previous & IndexMask;
+    }
+    
+    // consumer side: true when a newer value was published since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FreshBit)) return false;
+        uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & IndexMask;
+        return true;
+    }
+    
+    const T& front() const { return buffers[frontIndex]; }
+    
+private:
+    static const uint8_t IndexMask = 0x3;
+    static const uint8_t FreshBit = 0x4;
+    
+    T buffers[3];
+    alignas(64) std::atomic<uint8_t> middle;
+    alignas(64) uint8_t backIndex;
+    alignas(64) uint8_t frontIndex;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "usercache.h"
+#include <pwd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+UserCache::UserCache(StringPool& strings, std::chrono::seconds ttl)
+    : strings(strings), ttl(ttl), scratch(1024) {
+}
+
+uint32_t UserCache::lookup(int uid, Clock::time_point now) {
+    auto it = entries.find(uid);
+    if (it != entries.end() && now < it->second.expires) {
+        return it->second.nameId;
+    }
+    
+    uint32_t nameId = resolve(uid);
+    entries[uid] = {nameId, now + ttl};
+    return nameId;
+}
+
+uint32_t UserCache::resolve(int uid) {
+    struct passwd pw;
+    struct passwd* result = nullptr;
+    
+    while (true) {
+        int error = getpwuid_r(static_cast<uid_t>(uid), &pw, scratch.data(), scratch.size(), &result);
+        if (error != ERANGE) break;
+        scratch.resize(scratch.size() * 2);
+    }
+    
+    if (result) return strings.intern(result->pw_name, strlen(result->pw_name));
+    
+    // unknown uid: show the number
+    char number[16];
+    int length = snprintf(number, sizeof(number), "%d", uid);
+    return strings.intern(number, static_cast<size_t>(length));
+}
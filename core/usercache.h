@@ -0,0 +1,38 @@
+#ifndef USERCACHE_H
+#define USERCACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "stringpool.h"
+
+// uid -> interned user name. each uid is resolved through NSS (getpwuid_r)
+// once and then served from memory until its entry is older than the ttl,
+// so a refresh costs no NSS/LDAP round trips in the steady state.
+class UserCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    UserCache(StringPool& strings, std::chrono::seconds ttl = std::chrono::seconds(300));
+    
+    uint32_t lookup(int uid, Clock::time_point now);
+    
+    // drop every cached entry, e.g. after /etc/passwd changes
+    void clear() { entries.clear(); }
+    
+private:
+    struct Entry {
+        uint32_t nameId;
+        Clock::time_point expires;
+    };
+    
+    uint32_t resolve(int uid);
+    
+    StringPool& strings;
+    std::chrono::seconds ttl;
+    std::unordered_map<int, Entry> entries;
+    std::vector<char> scratch;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(int threadCount)
+    : ranges(threadCount < 1 ? 1 : threadCount), task(nullptr),
+      batch(0), busy(0), stopping(false) {
+    for (int i = 1; i < size(); i++) {
+        threads.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+void WorkerPool::run(size_t count, const std::function<void(int, size_t)>& fn) {
+    if (count == 0) return;
+    
+    if (size() == 1) {
+        for (size_t i = 0; i < count; i++) fn(0, i);
+        return;
+    }
+    
+    // hand every worker an even slice up front
+    size_t workers = ranges.size();
+    for (size_t w = 0; w < workers; w++) {
+        uint32_t begin = static_cast<uint32_t>(count * w / workers);
+        uint32_t end = static_cast<uint32_t>(count * (w + 1) / workers);
+        ranges[w].bounds.store(pack(begin, end), std::memory_order_relaxed);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        busy = size() - 1;
+        batch++;
+    }
+    start.notify_all();
+    
+    work(0);
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    task = nullptr;
+}
+
+void WorkerPool::workerLoop(int worker) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping) return;
+            seen = batch;
+        }
+        
+        work(worker);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) done.notify_one();
+    }
+}
+
+void WorkerPool::work(int worker) {
+    size_t index;
+    do {
+        while (popOwn(worker, index)) (*task)(worker, index);
+    } while (steal(worker));
+}
+
+bool WorkerPool::popOwn(int worker, size_t& index) {
+    std::atomic<uint64_t>& bounds = ranges[worker].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t begin = static_cast<uint32_t>(current);
+        uint32_t end = static_cast<uint32_t>(current >> 32);
+        if (begin >= end) return false;
+        if (bounds.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkerPool::steal(int worker) {
+    int workers = size();
+    for (int offset = 1; offset < workers; offset++) {
+        std::atomic<uint64_t>& victim = ranges[(worker + offset) % workers].bounds;
+        uint64_t current = victim.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t begin = static_cast<uint32_t>(current);
+            uint32_t end = static_cast<uint32_t>(current >> 32);
+            if (begin >= end) break;
+            
+            // take the upper half, or the last task if only one is left
+            uint32_t middle = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(current, pack(begin, middle), std::memory_order_acq_rel)) {
+                ranges[worker].bounds.store(pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
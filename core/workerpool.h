@@ -0,0 +1,58 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small persistent thread pool that runs a batch of indexed tasks with work
+// stealing. every worker starts with a contiguous slice of the task range;
+// once its slice is empty it steals the upper half of another worker's.
+// the calling thread takes part as worker 0.
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    int size() const { return static_cast<int>(ranges.size()); }
+    
+    // calls task(worker, index) for every index in [0, count) and returns when all are done
+    void run(size_t count, const std::function<void(int, size_t)>& task);
+    
+private:
+    // [begin, end) packed into one word so the owner and thieves can race on a single CAS
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};
+    };
+    
+    static uint64_t pack(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(end) << 32) | begin;
+    }
+    
+    void workerLoop(int worker);
+    void work(int worker);
+    bool popOwn(int worker, size_t& index);
+    bool steal(int worker);
+    
+    std::vector<Range> ranges;
+    std::vector<std::thread> threads;
+    const std::function<void(int, size_t)>* task;
+    
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    unsigned long long batch;
+    int busy;
+    bool stopping;
+};
+
+#endif
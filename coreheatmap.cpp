@@ -0,0 +1,65 @@
+#include "coreheatmap.h"
+#include <QMouseEvent>
+#include <QPainter>
+
+CoreHeatmap::CoreHeatmap(QWidget *parent)
+    : QWidget(parent) {
+    setMouseTracking(true);
+    setMinimumHeight(CellSize);
+}
+
+void CoreHeatmap::setUsage(const CoreUsage &cores) {
+    bool resized = cores.size() != usage.size();
+    usage = cores;
+    if (resized) updateHeight();
+    update();
+}
+
+int CoreHeatmap::columns() const {
+    return qMax(1, (width() + Gap) / (CellSize + Gap));
+}
+
+void CoreHeatmap::updateHeight() {
+    int rows = (static_cast<int>(usage.size()) + columns() - 1) / columns();
+    setMinimumHeight(qMax(1, rows) * (CellSize + Gap));
+}
+
+void CoreHeatmap::resizeEvent(QResizeEvent *) {
+    updateHeight();
+}
+
+void CoreHeatmap::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    int perRow = columns();
+    
+    for (size_t i = 0; i < usage.size(); i++) {
+        int x = static_cast<int>(i % perRow) * (CellSize + Gap);
+        int y = static_cast<int>(i / perRow) * (CellSize + Gap);
+        
+        // hue 120 (green) at idle down to 0 (red) at 100% busy
+        float busy = qBound(0.0f, usage.busy[i], 100.0f);
+        painter.fillRect(x, y, CellSize, CellSize, QColor::fromHsv(static_cast<int>(120 * (1.0f - busy / 100.0f)), 200, 220));
+        
+        int wait = static_cast<int>(qBound(0.0f, usage.iowait[i], 100.0f) * CellSize / 100.0f + 0.5f);
+        if (wait > 0) painter.fillRect(x, y, CellSize, wait, QColor(42, 130, 218));
+        
+        int stolen = static_cast<int>(qBound(0.0f, usage.steal[i], 100.0f) * CellSize / 100.0f + 0.5f);
+        if (stolen > 0) painter.fillRect(x, y + CellSize - stolen, CellSize, stolen, QColor(200, 0, 200));
+    }
+}
+
+void CoreHeatmap::mouseMoveEvent(QMouseEvent *event) {
+    int column = event->pos().x() / (CellSize + Gap);
+    int row = event->pos().y() / (CellSize + Gap);
+    size_t index = static_cast<size_t>(row) * columns() + column;
+    
+    if (column < columns() && index < usage.size()) {
+        setToolTip(QString("cpu%1: busy %2%  iowait %3%  steal %4%")
+                   .arg(usage.ids[index])
+                   .arg(usage.busy[index], 0, 'f', 1)
+                   .arg(usage.iowait[index], 0, 'f', 1)
+                   .arg(usage.steal[index], 0, 'f', 1));
+    } else {
+        setToolTip(QString());
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef COREHEATMAP_H
+#define COREHEATMAP_H
+
+#include <QWidget>
+#include "cpustats.h"
+
+// one square per core, coloured from green (idle) to red (busy). iowait is
+// drawn as a blue strip along the top of a square and steal as a magenta
+// strip along the bottom, so a stalled or stolen core is visible among
+// hundreds. hovering a square shows its numbers.
+class CoreHeatmap : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit CoreHeatmap(QWidget *parent = nullptr);
+    
+    void setUsage(const CoreUsage &cores);
+    
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    
+private:
+    static const int CellSize = 18;
+    static const int Gap = 2;
+    
+    int columns() const;
+    void updateHeight();
+    
+    CoreUsage usage;
+};
+
+#endif
@@ -40,8 +40,45 @@ int main(int argc, char *argv[]) {
                                       "Run in terminal mode (text-based interface)");
     parser.addOption(terminalOption);
     
+    QCommandLineOption scanThreadsOption(QStringList() << "scan-threads",
+                                         "Threads used to scan /proc/<pid> (0 = auto)", "n", "0");
+    parser.addOption(scanThreadsOption);
+    
+    QCommandLineOption recordOption(QStringList() << "record",
+                                    "Append every sample to a compressed recording", "dir");
+    parser.addOption(recordOption);
+    
+    QCommandLineOption recordProcessesOption(QStringList() << "record-processes",
+                                             "Include the process table in the recording");
+    parser.addOption(recordProcessesOption);
+    
+    QCommandLineOption replayOption(QStringList() << "replay",
+                                    "Show a recording instead of sampling /proc", "path");
+    parser.addOption(replayOption);
+    
+    QCommandLineOption fromOption(QStringList() << "from",
+                                  "Replay start: unix seconds, \"YYYY-MM-DD HH:MM\" or \"HH:MM\"", "time");
+    parser.addOption(fromOption);
+    
+    QCommandLineOption fastIntervalOption(QStringList() << "fast-interval",
+                                          "Sample cpu, memory and network every 10-100 ms between updates, 0 for off", "ms", "100");
+    parser.addOption(fastIntervalOption);
+    
+    QCommandLineOption pressureTriggerOption(QStringList() << "psi-trigger",
+                                             "Count pressure stalls, e.g. memory:some:150:1000 (repeatable)", "spec");
+    parser.addOption(pressureTriggerOption);
+    
+    QCommandLineOption processEventsOption(QStringList() << "proc-events",
+                                           "Track processes from kernel fork/exit events instead of walking /proc (needs CAP_NET_ADMIN)");
+    parser.addOption(processEventsOption);
+    
     parser.process(app);
     
+    if (parser.isSet(replayOption) && parser.isSet(recordOption)) {
+        qWarning("--replay and --record cannot be combined");
+        return 1;
+    }
+    
     // dark mode setup
     QPalette darkPalette;
     darkPalette.setColor(QPalette::Window, QColor(53, 53, 53));
@@ -68,6 +105,25 @@ int main(int argc, char *argv[]) {
     );
     
     MainWindow window;
+    window.setScanThreads(parser.value(scanThreadsOption).toInt());
+    int fastInterval = parser.value(fastIntervalOption).toInt();
+    if (fastInterval != 0 && (fastInterval < FastSampler::MinPeriodMs || fastInterval > FastSampler::MaxPeriodMs)) {
+        qWarning("--fast-interval must be 0 or between 10 and 100");
+        return 1;
+    }
+    if (!window.setFastInterval(fastInterval)) return 1;
+    for (const QString &spec : parser.values(pressureTriggerOption)) {
+        if (!window.addPressureTrigger(spec)) return 1;
+    }
+    if (parser.isSet(processEventsOption)) window.trackProcessEvents();
+    if (parser.isSet(recordOption) &&
+        !window.startRecording(parser.value(recordOption), parser.isSet(recordProcessesOption))) {
+        return 1;
+    }
+    if (parser.isSet(replayOption) &&
+        !window.startReplay(parser.value(replayOption), parser.value(fromOption))) {
+        return 1;
+    }
     window.show();
     
     return app.exec();
@@ -11,29 +11,87 @@
 #include <QSplitter>
 #include <QBrush>
 #include <QColor>
-#include <fstream>
-#include <sstream>
-#include <sys/statvfs.h>
-#include <dirent.h>
-#include <pwd.h>
+#include <QMetaObject>
+#include <QDateTime>
+#include <QComboBox>
+#include <QStatusBar>
+#include <algorithm>
 #include <signal.h>
-#include <unistd.h>
+
+// raw samples kept for every interface, ten minutes at the default interval
+static const size_t InterfaceRingPoints = 300;
+// an interface missing from the samples this long leaves the history and the list
+static const double InterfaceExpirySeconds = 600.0;
+
+MainWindow::InterfaceHistory::InterfaceHistory()
+    : download(InterfaceRingPoints, 0, 0), upload(InterfaceRingPoints, 0, 0), lastSeen(0.0) {
+}
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), timePoint(0), lastTotalTime(0), lastIdleTime(0),
+    : QMainWindow(parent), sampler(2000), timePoint(0), lastSampleTime(0.0), chartWindow(60.0),
       autoRefresh(true), updateInterval(2000) {
     
-    lastNetStats = {0, 0, 0, 0};
     setupUI();
+    sampler.setFastInterval(100);
     
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MainWindow::updateStats);
-    timer->start(updateInterval);
-    
-    updateStats();
+    // /proc is read on the sampler thread; it only pokes the event loop when a
+    // snapshot is ready, and updateStats() renders whatever is newest
+    sampler.start([this]() {
+        QMetaObject::invokeMethod(this, [this]() { updateStats(); }, Qt::QueuedConnection);
+    });
+}
+
+MainWindow::~MainWindow() {
+    sampler.stop();
+    if (recorder) recorder->close();
+}
+
+void MainWindow::setScanThreads(int threads) {
+    sampler.setScanThreads(threads);
 }
 
-MainWindow::~MainWindow() {}
+bool MainWindow::setFastInterval(int periodMs) {
+    if (!sampler.setFastInterval(periodMs)) {
+        QMessageBox::warning(this, "Fast Sampling", "Cannot start the fast sampler");
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::addPressureTrigger(const QString &spec) {
+    std::string error;
+    if (!sampler.addPressureTrigger(spec.toStdString(), error)) {
+        QMessageBox::warning(this, "Pressure Trigger",
+                           QString("Cannot add trigger %1:\n%2")
+                           .arg(spec, QString::fromStdString(error)));
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::trackProcessEvents() {
+    std::string error;
+    if (!sampler.trackProcessEvents(error)) {
+        qWarning("Falling back to /proc polling: %s", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::startRecording(const QString &directory, bool withProcesses) {
+    std::unique_ptr<Recorder> next(new Recorder(directory.toStdString(), withProcesses));
+    if (!next->open()) {
+        QMessageBox::warning(this, "Recording", 
+                           QString("Cannot record to %1:\n%2")
+                           .arg(directory, QString::fromStdString(next->error())));
+        return false;
+    }
+    
+    // the sampler stops using the old recorder before it is closed
+    sampler.setRecorder(next.get());
+    recorder = std::move(next);
+    return true;
+}
 
 void MainWindow::setupUI() {
     setWindowTitle("SysPulse - System Resource Monitor");
@@ -55,9 +113,36 @@ void MainWindow::setupUI() {
     setupOverviewTab();
     setupProcessTab();
     setupNetworkTab();
+    setupDiskTab();
+    setupCgroupTab();
     setupChartsTab();
     
     mainLayout->addWidget(tabWidget);
+    
+    selfStatsLabel = new QLabel();
+    statusBar()->addPermanentWidget(selfStatsLabel, 1);
+    
+    // scrub bar for --replay
+    replayBar = new QWidget();
+    QHBoxLayout *replayLayout = new QHBoxLayout(replayBar);
+    replayLayout->setContentsMargins(0, 0, 0, 0);
+    playButton = new QPushButton("Play");
+    scrubSlider = new QSlider(Qt::Horizontal);
+    scrubSlider->setPageStep(60);
+    scrubLabel = new QLabel();
+    replayLayout->addWidget(playButton);
+    replayLayout->addWidget(scrubSlider, 1);
+    replayLayout->addWidget(scrubLabel);
+    replayBar->hide();
+    mainLayout->addWidget(replayBar);
+    
+    replayTimer = new QTimer(this);
+    replayTimer->setSingleShot(true);
+    connect(playButton, &QPushButton::clicked, this, &MainWindow::toggleReplayPlayback);
+    connect(scrubSlider, &QSlider::valueChanged, this, &MainWindow::onScrubMoved);
+    connect(scrubSlider, &QSlider::sliderReleased, this, &MainWindow::onScrubReleased);
+    connect(replayTimer, &QTimer::timeout, this, &MainWindow::stepReplay);
+    
     setCentralWidget(centralWidget);
 }
 
@@ -76,6 +161,12 @@ void MainWindow::setupOverviewTab() {
     sysInfoLayout->addWidget(uptimeLabel, 0, 0);
     sysInfoLayout->addWidget(processCountLabel, 0, 1);
     sysInfoLayout->addWidget(tempLabel, 0, 2);
+    stallEventsLabel = new QLabel();
+    stallEventsLabel->hide();
+    sysInfoLayout->addWidget(stallEventsLabel, 1, 0, 1, 3);
+    samplingLabel = new QLabel();
+    samplingLabel->hide();
+    sysInfoLayout->addWidget(samplingLabel, 2, 0, 1, 3);
     sysInfoGroup->setLayout(sysInfoLayout);
     
     // cpu section
@@ -94,6 +185,13 @@ void MainWindow::setupOverviewTab() {
     cpuLayout->addWidget(cpuLabel);
     cpuLayout->addWidget(cpuBar);
     cpuLayout->addWidget(cpuDetailLabel);
+    cpuBurstLabel = new QLabel();
+    cpuBurstLabel->hide();
+    cpuLayout->addWidget(cpuBurstLabel);
+    cpuPressureLabel = new QLabel("Pressure: N/A");
+    cpuLayout->addWidget(cpuPressureLabel);
+    coreHeatmap = new CoreHeatmap();
+    cpuLayout->addWidget(coreHeatmap);
     cpuGroup->setLayout(cpuLayout);
     
     // memory section
@@ -109,6 +207,11 @@ void MainWindow::setupOverviewTab() {
     memLayout->addWidget(memLabel);
     memLayout->addWidget(memBar);
     memLayout->addWidget(memDetailLabel);
+    memBurstLabel = new QLabel();
+    memBurstLabel->hide();
+    memLayout->addWidget(memBurstLabel);
+    memPressureLabel = new QLabel("Pressure: N/A");
+    memLayout->addWidget(memPressureLabel);
     memGroup->setLayout(memLayout);
     
     // disk section
@@ -124,6 +227,8 @@ void MainWindow::setupOverviewTab() {
     diskLayout->addWidget(diskLabel);
     diskLayout->addWidget(diskBar);
     diskLayout->addWidget(diskDetailLabel);
+    ioPressureLabel = new QLabel("IO Pressure: N/A");
+    diskLayout->addWidget(ioPressureLabel);
     diskGroup->setLayout(diskLayout);
     
     layout->addWidget(sysInfoGroup);
@@ -145,28 +250,57 @@ void MainWindow::setupProcessTab() {
     killButton = new QPushButton("Kill Process");
     autoRefreshCheckbox = new QCheckBox("Auto-refresh");
     autoRefreshCheckbox->setChecked(true);
+    treeViewCheckbox = new QCheckBox("Tree view");
     
     connect(refreshButton, &QPushButton::clicked, this, &MainWindow::refreshProcessList);
     connect(killButton, &QPushButton::clicked, this, &MainWindow::onProcessKillClicked);
     connect(autoRefreshCheckbox, &QCheckBox::toggled, this, &MainWindow::toggleAutoRefresh);
+    connect(treeViewCheckbox, &QCheckBox::toggled, this, &MainWindow::toggleTreeView);
     
     buttonLayout->addWidget(refreshButton);
     buttonLayout->addWidget(killButton);
     buttonLayout->addWidget(autoRefreshCheckbox);
+    buttonLayout->addWidget(treeViewCheckbox);
     buttonLayout->addStretch();
     
-    // process table
-    processTable = new QTableWidget();
-    processTable->setColumnCount(5);
-    processTable->setHorizontalHeaderLabels({"PID", "Name", "CPU %", "Memory %", "User"});
+    // process table: the model diffs snapshots by pid, the proxy sorts
+    processModel = new ProcessModel(sampler.strings(), this);
+    processProxy = new QSortFilterProxyModel(this);
+    processProxy->setSourceModel(processModel);
+    processProxy->setSortRole(ProcessModel::SortRole);
+    processProxy->setDynamicSortFilter(true);
+    
+    processTable = new QTableView();
+    processTable->setModel(processProxy);
     processTable->horizontalHeader()->setStretchLastSection(true);
+    processTable->verticalHeader()->setVisible(false);
     processTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     processTable->setSelectionMode(QAbstractItemView::SingleSelection);
     processTable->setSortingEnabled(true);
+    processTable->sortByColumn(ProcessModel::CpuColumn, Qt::DescendingOrder);
     processTable->setAlternatingRowColors(true);
     
+    // the same processes under their parents, with subtree totals; the
+    // proxy sorts the children of each process among themselves
+    processTreeModel = new ProcessTreeModel(sampler.strings(), this);
+    processTreeProxy = new QSortFilterProxyModel(this);
+    processTreeProxy->setSourceModel(processTreeModel);
+    processTreeProxy->setSortRole(ProcessTreeModel::SortRole);
+    processTreeProxy->setDynamicSortFilter(true);
+    
+    processTree = new QTreeView();
+    processTree->setModel(processTreeProxy);
+    processTree->setSelectionBehavior(QAbstractItemView::SelectRows);
+    processTree->setSelectionMode(QAbstractItemView::SingleSelection);
+    processTree->setSortingEnabled(true);
+    processTree->sortByColumn(ProcessTreeModel::TreeCpuColumn, Qt::DescendingOrder);
+    processTree->setUniformRowHeights(true);
+    processTree->setAlternatingRowColors(true);
+    processTree->setVisible(false);
+    
     layout->addLayout(buttonLayout);
     layout->addWidget(processTable);
+    layout->addWidget(processTree);
     
     tabWidget->addTab(processWidget, "Processes");
 }
@@ -175,6 +309,16 @@ void MainWindow::setupNetworkTab() {
     QWidget *networkWidget = new QWidget();
     QVBoxLayout *layout = new QVBoxLayout(networkWidget);
     
+    // which interface the labels and the traffic chart follow
+    QHBoxLayout *interfaceLayout = new QHBoxLayout();
+    interfaceCombo = new QComboBox();
+    interfaceCombo->addItem("All interfaces", QString());
+    connect(interfaceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onInterfaceChanged);
+    interfaceLayout->addWidget(new QLabel("Interface:"));
+    interfaceLayout->addWidget(interfaceCombo);
+    interfaceLayout->addStretch();
+    layout->addLayout(interfaceLayout);
+    
     QGroupBox *netGroup = new QGroupBox("Network Statistics");
     QGridLayout *netLayout = new QGridLayout();
     
@@ -198,25 +342,106 @@ void MainWindow::setupNetworkTab() {
     netLayout->addWidget(totalDownloadLabel, 1, 0);
     netLayout->addWidget(totalUploadLabel, 1, 1);
     netLayout->addWidget(networkBar, 2, 0, 1, 2);
+    networkPeakLabel = new QLabel();
+    networkPeakLabel->hide();
+    netLayout->addWidget(networkPeakLabel, 3, 0, 1, 2);
     
     netGroup->setLayout(netLayout);
     layout->addWidget(netGroup);
-    layout->addStretch();
+    
+    // one row per interface, loopback included
+    interfaceTable = createTable({"Interface", "RX KB/s", "TX KB/s", "RX pkt/s", "TX pkt/s",
+                                  "RX MB", "TX MB", "Errors", "Drops"});
+    layout->addWidget(interfaceTable);
     
     tabWidget->addTab(networkWidget, "Network");
 }
 
+void MainWindow::setupDiskTab() {
+    QWidget *diskWidget = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(diskWidget);
+    
+    // whole disks from /proc/diskstats
+    QGroupBox *deviceGroup = new QGroupBox("Block Devices");
+    QVBoxLayout *deviceLayout = new QVBoxLayout();
+    deviceTable = createTable({"Device", "Reads/s", "Writes/s", "Read MB/s", "Write MB/s",
+                               "Queue", "Await ms", "Util %"});
+    deviceLayout->addWidget(deviceTable);
+    deviceGroup->setLayout(deviceLayout);
+    
+    // block-backed mounts from /proc/self/mountinfo
+    QGroupBox *mountGroup = new QGroupBox("Filesystems");
+    QVBoxLayout *mountLayout = new QVBoxLayout();
+    mountTable = createTable({"Mount Point", "Device", "Type", "Used GB", "Total GB", "Use %"});
+    mountLayout->addWidget(mountTable);
+    mountGroup->setLayout(mountLayout);
+    
+    layout->addWidget(deviceGroup);
+    layout->addWidget(mountGroup);
+    
+    tabWidget->addTab(diskWidget, "Disks");
+}
+
+void MainWindow::setupCgroupTab() {
+    QWidget *cgroupWidget = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(cgroupWidget);
+    
+    // populated cgroup v2 groups, heaviest first, so a busy container or
+    // service shows up as one row instead of a spread of pids
+    cgroupSummaryLabel = new QLabel("Cgroups: N/A");
+    cgroupTable = createTable({"Cgroup", "CPU %", "Memory MB", "Limit MB", "Read MB/s", "Write MB/s", "Tasks"});
+    layout->addWidget(cgroupSummaryLabel);
+    layout->addWidget(cgroupTable);
+    
+    tabWidget->addTab(cgroupWidget, "Cgroups");
+}
+
+QTableWidget *MainWindow::createTable(const QStringList &headers) {
+    QTableWidget *table = new QTableWidget();
+    table->setColumnCount(headers.size());
+    table->setHorizontalHeaderLabels(headers);
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setAlternatingRowColors(true);
+    return table;
+}
+
+void MainWindow::setRowTexts(QTableWidget *table, int row, const QStringList &cells) {
+    // items are reused, so a steady table only updates text
+    for (int column = 0; column < cells.size(); column++) {
+        QTableWidgetItem *item = table->item(row, column);
+        if (item) {
+            item->setText(cells[column]);
+        } else {
+            table->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+    }
+}
+
 void MainWindow::setupChartsTab() {
-    QWidget *chartsWidget = new QWidget();
+    chartsWidget = new QWidget();
     QVBoxLayout *layout = new QVBoxLayout(chartsWidget);
     
+    // time window selector
+    QHBoxLayout *windowLayout = new QHBoxLayout();
+    windowCombo = new QComboBox();
+    windowCombo->addItem("Last minute", 60);
+    windowCombo->addItem("Last hour", 3600);
+    windowCombo->addItem("Last 24 hours", 86400);
+    connect(windowCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onChartWindowChanged);
+    windowLayout->addWidget(new QLabel("Window:"));
+    windowLayout->addWidget(windowCombo);
+    windowLayout->addStretch();
+    layout->addLayout(windowLayout);
+    
     // cpu chart
     cpuSeries = new QLineSeries();
     cpuChart = new QChart();
     cpuChart->addSeries(cpuSeries);
     cpuChart->setTitle("CPU Usage History");
     cpuChart->createDefaultAxes();
-    cpuChart->axes(Qt::Horizontal).first()->setRange(0, 60);
+    cpuChart->axes(Qt::Horizontal).first()->setRange(-60, 0);
     cpuChart->axes(Qt::Vertical).first()->setRange(0, 100);
     cpuChart->legend()->hide();
     
@@ -239,7 +464,7 @@ void MainWindow::setupChartsTab() {
     memChart->addSeries(memSeries);
     memChart->setTitle("Memory Usage History");
     memChart->createDefaultAxes();
-    memChart->axes(Qt::Horizontal).first()->setRange(0, 60);
+    memChart->axes(Qt::Horizontal).first()->setRange(-60, 0);
     memChart->axes(Qt::Vertical).first()->setRange(0, 100);
     memChart->legend()->hide();
     
@@ -269,7 +494,7 @@ void MainWindow::setupChartsTab() {
     networkChart->addSeries(uploadSeries);
     networkChart->setTitle("Network Traffic");
     networkChart->createDefaultAxes();
-    networkChart->axes(Qt::Horizontal).first()->setRange(0, 60);
+    networkChart->axes(Qt::Horizontal).first()->setRange(-60, 0);
     
     // dark theme for chart
     networkChart->setBackgroundBrush(QBrush(QColor(53, 53, 53)));
@@ -289,47 +514,57 @@ void MainWindow::setupChartsTab() {
     layout->addWidget(networkChartView);
     
     tabWidget->addTab(chartsWidget, "Charts");
+    connect(tabWidget, &QTabWidget::currentChanged, this, [this]() { refreshCharts(); });
 }
 
 void MainWindow::updateStats() {
-    // get metrics
-    double cpu = getCPUUsage();
-    double mem = getMemoryUsage();
-    double disk = getDiskUsage();
-    QString uptime = getUptime();
-    int procCount = getProcessCount();
-    double temp = getCPUTemperature();
-    NetworkStats netStats = getNetworkStats();
+    // a queued update can still arrive after a replay took over
+    if (replay || !sampler.update()) return;
+    
+    const Snapshot &snapshot = sampler.latest();
+    renderSnapshot(snapshot);
+    appendHistory(snapshot.stats, &snapshot.interfaces);
+    refreshCharts();
+    
+    timePoint++;
+}
+
+// psi of one resource; recordings only keep the 10s averages (some, full)
+static QString pressureText(const char *title, const Pressure &pressure, double recordedSome, double recordedFull) {
+    if (pressure.available) {
+        return QString("%1: some %2% (60s %3%)  |  full %4% (60s %5%)")
+               .arg(title)
+               .arg(pressure.some.avg10, 0, 'f', 2)
+               .arg(pressure.some.avg60, 0, 'f', 2)
+               .arg(pressure.full.avg10, 0, 'f', 2)
+               .arg(pressure.full.avg60, 0, 'f', 2);
+    }
+    if (recordedSome > 0.0 || recordedFull > 0.0) {
+        return QString("%1: some %2%  |  full %3%")
+               .arg(title)
+               .arg(recordedSome, 0, 'f', 2)
+               .arg(recordedFull, 0, 'f', 2);
+    }
+    return QString("%1: N/A").arg(title);
+}
+
+void MainWindow::renderSnapshot(const Snapshot &snapshot) {
+    const SystemStats &stats = snapshot.stats;
+    double cpu = stats.cpu;
+    double mem = stats.memory;
     
     // update Overview tab
     cpuLabel->setText(QString("CPU: %1%").arg(cpu, 0, 'f', 1));
     cpuBar->setValue(static_cast<int>(cpu));
-    
-    // cpu details (read from /proc/cpuinfo)
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    int cores = 0;
-    std::string line;
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("processor") == 0) cores++;
-    }
-    cpuDetailLabel->setText(QString("Cores: %1").arg(cores));
+    cpuDetailLabel->setText(QString("Cores: %1  |  iowait %2%  |  steal %3%")
+                           .arg(stats.cores)
+                           .arg(stats.cpuIowait, 0, 'f', 1)
+                           .arg(stats.cpuSteal, 0, 'f', 1));
+    coreHeatmap->setUsage(snapshot.cores);
     
     // memory details
-    std::ifstream meminfo("/proc/meminfo");
-    unsigned long long memTotal = 0, memAvailable = 0;
-    while (std::getline(meminfo, line)) {
-        if (line.find("MemTotal:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memTotal;
-        } else if (line.find("MemAvailable:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memAvailable;
-        }
-    }
-    double memUsedMB = (memTotal - memAvailable) / 1024.0;
-    double memTotalMB = memTotal / 1024.0;
+    double memUsedMB = (stats.memTotal - stats.memAvailable) / 1024.0;
+    double memTotalMB = stats.memTotal / 1024.0;
     
     memLabel->setText(QString("Memory: %1%").arg(mem, 0, 'f', 1));
     memBar->setValue(static_cast<int>(mem));
@@ -338,84 +573,336 @@ void MainWindow::updateStats() {
                            .arg(memTotalMB, 0, 'f', 0));
     
     // disk details
-    struct statvfs stat;
-    if (statvfs("/", &stat) == 0) {
-        double totalGB = (stat.f_blocks * stat.f_frsize) / (1024.0 * 1024.0 * 1024.0);
-        double usedGB = ((stat.f_blocks - stat.f_bavail) * stat.f_frsize) / (1024.0 * 1024.0 * 1024.0);
-        diskDetailLabel->setText(QString("Used: %1 GB / Total: %2 GB")
-                                .arg(usedGB, 0, 'f', 1)
-                                .arg(totalGB, 0, 'f', 1));
-    }
-    
-    diskLabel->setText(QString("Disk: %1%").arg(disk, 0, 'f', 1));
-    diskBar->setValue(static_cast<int>(disk));
-    
-    uptimeLabel->setText(QString("Uptime: %1").arg(uptime));
-    processCountLabel->setText(QString("Processes: %1").arg(procCount));
-    tempLabel->setText(QString("CPU Temp: %1").arg(temp > 0 ? QString::number(temp, 'f', 1) + "°C" : "N/A"));
-    
-    // update Network tab
-    if (lastNetStats.rxBytes > 0) {
-        double downloadSpeed = (netStats.rxBytes - lastNetStats.rxBytes) / 1024.0 / (updateInterval / 1000.0);
-        double uploadSpeed = (netStats.txBytes - lastNetStats.txBytes) / 1024.0 / (updateInterval / 1000.0);
+    double totalGB = stats.diskTotal / (1024.0 * 1024.0 * 1024.0);
+    double usedGB = stats.diskUsed / (1024.0 * 1024.0 * 1024.0);
+    diskDetailLabel->setText(QString("Used: %1 GB / Total: %2 GB")
+                            .arg(usedGB, 0, 'f', 1)
+                            .arg(totalGB, 0, 'f', 1));
+    
+    diskLabel->setText(QString("Disk: %1%").arg(stats.disk, 0, 'f', 1));
+    diskBar->setValue(static_cast<int>(stats.disk));
+    
+    // what the fast sampler saw since the previous update; hidden when it is
+    // off and during replays
+    const FastStats &fast = snapshot.fast;
+    if (fast.samples > 0) {
+        cpuBurstLabel->setText(QString("Last %1 samples @ %2 ms: min %3%  |  mean %4%  |  max %5%")
+                              .arg(fast.samples)
+                              .arg(fast.periodMs, 0, 'f', 0)
+                              .arg(fast.cpu.min, 0, 'f', 1)
+                              .arg(fast.cpu.mean, 0, 'f', 1)
+                              .arg(fast.cpu.max, 0, 'f', 1));
+        memBurstLabel->setText(QString("Min %1%  |  mean %2%  |  max %3%")
+                              .arg(fast.memory.min, 0, 'f', 1)
+                              .arg(fast.memory.mean, 0, 'f', 1)
+                              .arg(fast.memory.max, 0, 'f', 1));
+        samplingLabel->setText(QString("Sampling jitter: %1 ms mean, %2 ms max  |  %3 ticks missed (%4 total)")
+                              .arg(fast.jitterMeanMs, 0, 'f', 3)
+                              .arg(fast.jitterMaxMs, 0, 'f', 3)
+                              .arg(fast.missed)
+                              .arg(fast.missedTotal));
+    }
+    cpuBurstLabel->setVisible(fast.samples > 0);
+    memBurstLabel->setVisible(fast.samples > 0);
+    samplingLabel->setVisible(fast.samples > 0);
+    
+    // pressure stall information next to the bars it explains
+    const PressureStats &pressure = snapshot.pressure;
+    cpuPressureLabel->setText(pressureText("Pressure", pressure.resources[PressureCpu],
+                                           stats.pressureCpuSome, stats.pressureCpuFull));
+    memPressureLabel->setText(pressureText("Pressure", pressure.resources[PressureMemory],
+                                           stats.pressureMemorySome, stats.pressureMemoryFull));
+    ioPressureLabel->setText(pressureText("IO Pressure", pressure.resources[PressureIo],
+                                          stats.pressureIoSome, stats.pressureIoFull));
+    QStringList events;
+    for (const PressureTrigger &trigger : pressure.triggers) {
+        QString text = QString("%1 %2 %3ms/%4ms: %5")
+                       .arg(pressureResourceName(trigger.resource))
+                       .arg(trigger.full ? "full" : "some")
+                       .arg(trigger.stallUs / 1000)
+                       .arg(trigger.windowUs / 1000)
+                       .arg(trigger.events);
+        if (trigger.events > 0) {
+            QDateTime last = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(trigger.lastEvent * 1000.0));
+            text += QString(" (last %1)").arg(last.toString("HH:mm:ss.zzz"));
+        }
+        events << text;
+    }
+    stallEventsLabel->setText("Stall events: " + events.join("  |  "));
+    stallEventsLabel->setVisible(!events.isEmpty());
+    
+    uptimeLabel->setText(QString("Uptime: %1").arg(QString::fromStdString(formatUptime(stats.uptime))));
+    QString processText = QString("Processes: %1").arg(stats.processes);
+    if (stats.forkRate > 0 || stats.exitRate > 0) {
+        processText += QString(" (%1 forks/s, %2 exits/s)")
+                       .arg(stats.forkRate, 0, 'f', 1)
+                       .arg(stats.exitRate, 0, 'f', 1);
+    }
+    processCountLabel->setText(processText);
+    tempLabel->setText(QString("CPU Temp: %1").arg(stats.temperature > 0 ? QString::number(stats.temperature, 'f', 1) + "°C" : "N/A"));
+    
+    // update Network tab: the selected interface, or the sum without loopback
+    updateInterfaceTable(snapshot.interfaces);
+    updateDiskTables(snapshot);
+    updateCgroupTable(snapshot.cgroups);
+    if (timePoint > 0) {
+        double downloadSpeed = stats.netRxSpeed / 1024.0;
+        double uploadSpeed = stats.netTxSpeed / 1024.0;
+        double totalDownload = static_cast<double>(stats.netRxBytes);
+        double totalUpload = static_cast<double>(stats.netTxBytes);
+        for (const InterfaceStats &device : snapshot.interfaces) {
+            if (device.name != selectedInterface) continue;
+            downloadSpeed = device.rxRate / 1024.0;
+            uploadSpeed = device.txRate / 1024.0;
+            totalDownload = static_cast<double>(device.rxBytes);
+            totalUpload = static_cast<double>(device.txBytes);
+        }
         
         downloadLabel->setText(QString("Download Speed: %1 KB/s").arg(downloadSpeed, 0, 'f', 2));
         uploadLabel->setText(QString("Upload Speed: %1 KB/s").arg(uploadSpeed, 0, 'f', 2));
-        totalDownloadLabel->setText(QString("Total Downloaded: %1 MB").arg(netStats.rxBytes / (1024.0 * 1024.0), 0, 'f', 2));
-        totalUploadLabel->setText(QString("Total Uploaded: %1 MB").arg(netStats.txBytes / (1024.0 * 1024.0), 0, 'f', 2));
+        totalDownloadLabel->setText(QString("Total Downloaded: %1 MB").arg(totalDownload / (1024.0 * 1024.0), 0, 'f', 2));
+        totalUploadLabel->setText(QString("Total Uploaded: %1 MB").arg(totalUpload / (1024.0 * 1024.0), 0, 'f', 2));
         
         int networkActivity = qMin(100, static_cast<int>((downloadSpeed + uploadSpeed) / 100));
         networkBar->setValue(networkActivity);
+        
+        // the fast sampler only follows the sum of all interfaces
+        const FastStats &fast = snapshot.fast;
+        networkPeakLabel->setText(QString("Peak: %1 KB/s down, %2 KB/s up")
+                                 .arg(fast.netRx.max / 1024.0, 0, 'f', 2)
+                                 .arg(fast.netTx.max / 1024.0, 0, 'f', 2));
+        networkPeakLabel->setVisible(fast.samples > 0 && selectedInterface.empty());
     }
-    lastNetStats = netStats;
-    
-    // update charts
-    cpuSeries->append(timePoint, cpu);
-    memSeries->append(timePoint, mem);
     
-    if (timePoint > 60) {
-        cpuChart->axes(Qt::Horizontal).first()->setRange(timePoint - 60, timePoint);
-        memChart->axes(Qt::Horizontal).first()->setRange(timePoint - 60, timePoint);
-        networkChart->axes(Qt::Horizontal).first()->setRange(timePoint - 60, timePoint);
+    // the sampler only walks /proc/<pid> when auto-refresh is on or a refresh was asked for
+    if (snapshot.hasProcesses) {
+        processModel->setProcesses(snapshot.processes);
+        processTreeModel->setProcesses(snapshot.processes);
     }
     
-    cpuHistory.append(cpu);
-    memHistory.append(mem);
+    updateSelfStats(snapshot);
+}
+
+void MainWindow::updateSelfStats(const Snapshot &snapshot) {
+    const SystemStats &stats = snapshot.stats;
+    const double recorded[CollectorCount] = {
+        stats.collectCpuUs, stats.collectMemoryUs, stats.collectDiskUs, stats.collectNetworkUs,
+        stats.collectProcessesUs, stats.collectPressureUs, stats.collectCgroupsUs, stats.collectSystemUs,
+    };
+    double total = 0.0;
+    for (double us : recorded) total += us;
+    selfStatsLabel->setText(QString("Sampling: %1 ms, %2 syscalls, %3 KB read  |  SysPulse CPU %4%, RSS %5 MB")
+                           .arg(total / 1000.0, 0, 'f', 2)
+                           .arg(stats.collectSyscalls)
+                           .arg(stats.collectBytes / 1024.0, 0, 'f', 1)
+                           .arg(stats.selfCpu, 0, 'f', 1)
+                           .arg(stats.selfRss / (1024.0 * 1024.0), 0, 'f', 1));
+    
+    // per collector; the histogram only exists live, recordings keep the last pass
+    const SelfStats &self = snapshot.self;
+    QStringList lines;
+    for (int collector = 0; collector < CollectorCount; collector++) {
+        const CollectorStats &entry = self.collectors[collector];
+        if (entry.calls == 0) {
+            if (recorded[collector] > 0.0) {
+                lines << QString("%1: %2 ms").arg(collectorName(collector)).arg(recorded[collector] / 1000.0, 0, 'f', 2);
+            }
+            continue;
+        }
+        lines << QString("%1: %2 ms (p50 %3 ms, p99 %4 ms), %5 syscalls, %6 bytes")
+                 .arg(collectorName(collector))
+                 .arg(entry.lastUs / 1000.0, 0, 'f', 2)
+                 .arg(entry.percentileUs(0.5) / 1000.0, 0, 'f', 2)
+                 .arg(entry.percentileUs(0.99) / 1000.0, 0, 'f', 2)
+                 .arg(entry.lastSyscalls)
+                 .arg(entry.lastBytes);
+    }
+    selfStatsLabel->setToolTip(lines.join("\n"));
+}
+
+void MainWindow::appendHistory(const SystemStats &stats, const std::vector<InterfaceStats> *interfaces) {
+    // history keeps fixed memory however long the window stays open
+    cpuHistory.append(stats.timestamp, stats.cpu);
+    memHistory.append(stats.timestamp, stats.memory);
+    downloadHistory.append(stats.timestamp, stats.netRxSpeed / 1024.0);
+    uploadHistory.append(stats.timestamp, stats.netTxSpeed / 1024.0);
+    
+    if (interfaces) {
+        for (const InterfaceStats &device : *interfaces) {
+            InterfaceHistory &history = interfaceHistories[device.name];
+            history.download.append(stats.timestamp, device.rxRate / 1024.0);
+            history.upload.append(stats.timestamp, device.txRate / 1024.0);
+            history.lastSeen = stats.timestamp;
+            if (device.name == selectedInterface) {
+                selectedDownload.append(stats.timestamp, device.rxRate / 1024.0);
+                selectedUpload.append(stats.timestamp, device.txRate / 1024.0);
+            }
+        }
+        
+        // veth and cali devices come and go on container hosts; without
+        // this the map and the list would grow with every one ever seen
+        for (auto it = interfaceHistories.begin(); it != interfaceHistories.end();) {
+            if (stats.timestamp - it->second.lastSeen < InterfaceExpirySeconds) {
+                ++it;
+                continue;
+            }
+            int index = interfaceCombo->findData(QString::fromStdString(it->first));
+            if (index >= 0) {
+                // falls back to all interfaces when the selected one goes;
+                // removing another item only shifts the current index
+                if (index == interfaceCombo->currentIndex()) interfaceCombo->setCurrentIndex(0);
+                interfaceCombo->blockSignals(true);
+                interfaceCombo->removeItem(index);
+                interfaceCombo->blockSignals(false);
+            }
+            it = interfaceHistories.erase(it);
+        }
+    }
     
-    timePoint++;
+    lastSampleTime = stats.timestamp;
+}
+
+void MainWindow::updateInterfaceTable(const std::vector<InterfaceStats> &interfaces) {
+    // new interfaces become selectable; ones that went away stay in the list
+    // until appendHistory() expires them
+    for (const InterfaceStats &device : interfaces) {
+        QString name = QString::fromStdString(device.name);
+        if (interfaceCombo->findData(name) < 0) interfaceCombo->addItem(name, name);
+    }
     
-    // update process list if auto-refresh is enabled
-    if (autoRefresh) {
-        refreshProcessList();
+    interfaceTable->setRowCount(static_cast<int>(interfaces.size()));
+    for (int row = 0; row < static_cast<int>(interfaces.size()); row++) {
+        const InterfaceStats &device = interfaces[static_cast<size_t>(row)];
+        setRowTexts(interfaceTable, row, {
+            QString::fromStdString(device.name) + (device.loopback ? " (loopback)" : ""),
+            QString::number(device.rxRate / 1024.0, 'f', 2),
+            QString::number(device.txRate / 1024.0, 'f', 2),
+            QString::number(device.rxPacketRate, 'f', 0),
+            QString::number(device.txPacketRate, 'f', 0),
+            QString::number(device.rxBytes / (1024.0 * 1024.0), 'f', 2),
+            QString::number(device.txBytes / (1024.0 * 1024.0), 'f', 2),
+            QString::number(device.rxErrors + device.txErrors),
+            QString::number(device.rxDrops + device.txDrops),
+        });
     }
 }
 
-void MainWindow::refreshProcessList() {
-    QVector<ProcessInfo> processes = getProcessList();
+void MainWindow::updateDiskTables(const Snapshot &snapshot) {
+    const double megabyte = 1024.0 * 1024.0;
+    const double gigabyte = megabyte * 1024.0;
+    
+    deviceTable->setRowCount(static_cast<int>(snapshot.devices.size()));
+    for (int row = 0; row < static_cast<int>(snapshot.devices.size()); row++) {
+        const DeviceStats &device = snapshot.devices[static_cast<size_t>(row)];
+        setRowTexts(deviceTable, row, {
+            QString::fromStdString(device.name),
+            QString::number(device.readsPerSecond, 'f', 0),
+            QString::number(device.writesPerSecond, 'f', 0),
+            QString::number(device.readBytesPerSecond / megabyte, 'f', 2),
+            QString::number(device.writeBytesPerSecond / megabyte, 'f', 2),
+            QString::number(device.queueDepth, 'f', 2),
+            QString::number(device.awaitMs, 'f', 2),
+            QString::number(device.utilization, 'f', 1),
+        });
+    }
     
-    processTable->setRowCount(processes.size());
-    processTable->setSortingEnabled(false);
+    mountTable->setRowCount(static_cast<int>(snapshot.mounts.size()));
+    for (int row = 0; row < static_cast<int>(snapshot.mounts.size()); row++) {
+        const MountUsage &mount = snapshot.mounts[static_cast<size_t>(row)];
+        setRowTexts(mountTable, row, {
+            QString::fromStdString(mount.mountPoint),
+            QString::fromStdString(mount.device),
+            QString::fromStdString(mount.fsType),
+            QString::number(mount.used / gigabyte, 'f', 1),
+            QString::number(mount.total / gigabyte, 'f', 1),
+            QString::number(mount.percent, 'f', 1),
+        });
+    }
+}
+
+void MainWindow::updateCgroupTable(const std::vector<CgroupStats> &cgroups) {
+    const double megabyte = 1024.0 * 1024.0;
     
-    for (int i = 0; i < processes.size(); i++) {
-        processTable->setItem(i, 0, new QTableWidgetItem(QString::number(processes[i].pid)));
-        processTable->setItem(i, 1, new QTableWidgetItem(processes[i].name));
-        processTable->setItem(i, 2, new QTableWidgetItem(QString::number(processes[i].cpu, 'f', 1)));
-        processTable->setItem(i, 3, new QTableWidgetItem(QString::number(processes[i].memory, 'f', 1)));
-        processTable->setItem(i, 4, new QTableWidgetItem(processes[i].user));
+    std::vector<const CgroupStats *> order;
+    order.reserve(cgroups.size());
+    for (const CgroupStats &group : cgroups) {
+        if (group.depth > 0 && group.populated) order.push_back(&group);
+    }
+    std::sort(order.begin(), order.end(), [](const CgroupStats *a, const CgroupStats *b) {
+        if (a->cpuPercent != b->cpuPercent) return a->cpuPercent > b->cpuPercent;
+        return a->memoryCurrent > b->memoryCurrent;
+    });
+    
+    // recordings carry no cgroups; the table just stays empty during a replay
+    cgroupSummaryLabel->setText(cgroups.empty()
+        ? QString("Cgroups: N/A")
+        : QString("Cgroups: %1 with processes, %2 in total").arg(order.size()).arg(cgroups.size() - 1));
+    cgroupTable->setRowCount(static_cast<int>(order.size()));
+    for (int row = 0; row < static_cast<int>(order.size()); row++) {
+        const CgroupStats &group = *order[static_cast<size_t>(row)];
+        setRowTexts(cgroupTable, row, {
+            QString::fromStdString(group.path),
+            QString::number(group.cpuPercent, 'f', 1),
+            QString::number(group.memoryCurrent / megabyte, 'f', 1),
+            group.memoryMax > 0 ? QString::number(group.memoryMax / megabyte, 'f', 0) : QString("-"),
+            QString::number(group.readBytesPerSecond / megabyte, 'f', 2),
+            QString::number(group.writeBytesPerSecond / megabyte, 'f', 2),
+            QString::number(group.pids),
+        });
+    }
+}
+
+void MainWindow::onInterfaceChanged() {
+    selectedInterface = interfaceCombo->currentData().toString().toStdString();
+    
+    // the full history starts with what the ring still holds
+    selectedDownload.clear();
+    selectedUpload.clear();
+    auto selected = interfaceHistories.find(selectedInterface);
+    if (selected != interfaceHistories.end()) {
+        const HistoryTier &download = selected->second.download.tier(MetricHistory::Raw);
+        const HistoryTier &upload = selected->second.upload.tier(MetricHistory::Raw);
+        for (size_t i = 0; i < download.size(); i++) {
+            selectedDownload.append(download.timeAt(i), download.avgAt(i));
+            selectedUpload.append(upload.timeAt(i), upload.avgAt(i));
+        }
     }
     
-    processTable->setSortingEnabled(true);
+    // show the choice now rather than at the next sample
+    if (replay) {
+        renderSnapshot(replayFrame);
+    } else if (timePoint > 0) {
+        renderSnapshot(sampler.latest());
+    }
+    refreshCharts();
+}
+
+void MainWindow::refreshProcessList() {
+    sampler.requestSample(true);
 }
 
 void MainWindow::onProcessKillClicked() {
-    QList<QTableWidgetItem*> selected = processTable->selectedItems();
+    bool tree = treeViewCheckbox->isChecked();
+    QAbstractItemView *view = tree ? static_cast<QAbstractItemView*>(processTree) : processTable;
+    QModelIndexList selected = view->selectionModel()->selectedRows();
     if (selected.isEmpty()) {
         QMessageBox::warning(this, "No Selection", "Please select a process to kill.");
         return;
     }
     
-    int pid = processTable->item(selected[0]->row(), 0)->text().toInt();
-    QString name = processTable->item(selected[0]->row(), 1)->text();
+    // resolve the pid now, through the proxy, so a re-sort can't retarget the kill
+    int pid;
+    QString name;
+    if (tree) {
+        QModelIndex source = processTreeProxy->mapToSource(selected[0]);
+        pid = processTreeModel->pidAt(source);
+        name = processTreeModel->nameAt(source);
+    } else {
+        int row = processProxy->mapToSource(selected[0]).row();
+        pid = processModel->pidAt(row);
+        name = processModel->nameAt(row);
+    }
+    if (pid <= 0) return;
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "Confirm Kill",
@@ -435,238 +922,225 @@ void MainWindow::onProcessKillClicked() {
 
 void MainWindow::toggleAutoRefresh() {
     autoRefresh = autoRefreshCheckbox->isChecked();
+    sampler.setCollectProcesses(autoRefresh);
 }
 
-void MainWindow::exportData() {
-    QString fileName = QFileDialog::getSaveFileName(this, "Export Data", "", "CSV Files (*.csv)");
-    if (fileName.isEmpty()) return;
-    
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Could not open file for writing.");
-        return;
+void MainWindow::toggleTreeView() {
+    bool tree = treeViewCheckbox->isChecked();
+    processTable->setVisible(!tree);
+    processTree->setVisible(tree);
+}
+
+void MainWindow::onChartWindowChanged() {
+    chartWindow = windowCombo->currentData().toDouble();
+    
+    // a replay only holds the history of the previous window
+    if (replay) {
+        rebuildReplayHistory();
+    } else {
+        refreshCharts();
+    }
+}
+
+bool MainWindow::startReplay(const QString &path, const QString &from) {
+    std::unique_ptr<RecordingReader> reader(new RecordingReader());
+    if (!reader->open(path.toStdString())) {
+        QMessageBox::warning(this, "Replay", QString::fromStdString(reader->error()));
+        return false;
     }
     
-    QTextStream out(&file);
-    out << "Time,CPU %,Memory %\n";
-    
-    for (int i = 0; i < cpuHistory.size(); i++) {
-        out << i << "," << cpuHistory[i] << "," << memHistory[i] << "\n";
+    double start = reader->startTime();
+    if (!from.isEmpty() && !parseTimeArgument(from.toStdString(), reader->startTime(), start)) {
+        QMessageBox::warning(this, "Replay", QString("Cannot parse time: %1").arg(from));
+        return false;
     }
     
-    file.close();
-    QMessageBox::information(this, "Success", "Data exported successfully!");
+    // live samples would interleave with the recording
+    sampler.stop();
+    replay = std::move(reader);
+    timePoint = 1;
+    
+    processModel->setStrings(replay->strings());
+    processTreeModel->setStrings(replay->strings());
+    refreshButton->setEnabled(false);
+    killButton->setEnabled(false);
+    autoRefreshCheckbox->setEnabled(false);
+    
+    // recordings only hold the sum over all interfaces
+    interfaceHistories.clear();
+    selectedInterface.clear();
+    selectedDownload.clear();
+    selectedUpload.clear();
+    interfaceCombo->blockSignals(true);
+    interfaceCombo->setCurrentIndex(0);
+    interfaceCombo->blockSignals(false);
+    interfaceCombo->setEnabled(false);
+    setWindowTitle(QString("SysPulse - Replay of %1").arg(path));
+    
+    scrubSlider->blockSignals(true);
+    scrubSlider->setRange(0, static_cast<int>(replay->endTime() - replay->startTime()));
+    scrubSlider->blockSignals(false);
+    replayBar->show();
+    
+    seekReplay(start, true);
+    return true;
 }
 
-double MainWindow::getCPUUsage() {
-    std::ifstream file("/proc/stat");
-    std::string line;
-    std::getline(file, line);
+void MainWindow::seekReplay(double time, bool withCharts) {
+    if (!replay->seek(time, replayPosition)) return;
     
-    std::istringstream ss(line);
-    std::string cpu;
-    unsigned long long user, nice, system, idle, iowait, irq, softirq;
-    
-    ss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq;
+    showReplayFrame();
+    if (withCharts) rebuildReplayHistory();
+}
+
+void MainWindow::showReplayFrame() {
+    if (!replay->read(replayPosition, replayFrame)) return;
     
-    unsigned long long totalTime = user + nice + system + idle + iowait + irq + softirq;
-    unsigned long long idleTime = idle + iowait;
+    renderSnapshot(replayFrame);
     
-    if (lastTotalTime == 0) {
-        lastTotalTime = totalTime;
-        lastIdleTime = idleTime;
-        return 0.0;
+    double time = replayFrame.stats.timestamp;
+    scrubLabel->setText(QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(time * 1000)).toString(Qt::ISODate));
+    scrubSlider->blockSignals(true);
+    scrubSlider->setValue(static_cast<int>(time - replay->startTime()));
+    scrubSlider->blockSignals(false);
+}
+
+void MainWindow::rebuildReplayHistory() {
+    cpuHistory.clear();
+    memHistory.clear();
+    downloadHistory.clear();
+    uploadHistory.clear();
+    
+    // feed the chart window ending at the current frame, stats only
+    double end = replayFrame.stats.timestamp;
+    RecordingReader::Position position;
+    if (replay->seek(end - chartWindow, position)) {
+        do {
+            if (!replay->read(position, replayScratch, false) || replayScratch.stats.timestamp > end) break;
+            appendHistory(replayScratch.stats);
+        } while (replay->advance(position));
     }
     
-    unsigned long long totalDiff = totalTime - lastTotalTime;
-    unsigned long long idleDiff = idleTime - lastIdleTime;
-    
-    double usage = 100.0 * (totalDiff - idleDiff) / totalDiff;
-    
-    lastTotalTime = totalTime;
-    lastIdleTime = idleTime;
-    
-    return usage;
+    lastSampleTime = end;
+    refreshCharts();
 }
 
-double MainWindow::getMemoryUsage() {
-    std::ifstream file("/proc/meminfo");
-    std::string line;
-    unsigned long long memTotal = 0, memAvailable = 0;
-    
-    while (std::getline(file, line)) {
-        if (line.find("MemTotal:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memTotal;
-        } else if (line.find("MemAvailable:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memAvailable;
-        }
+void MainWindow::onScrubMoved(int value) {
+    // rebuilding the charts waits until a drag ends
+    seekReplay(replay->startTime() + value, !scrubSlider->isSliderDown());
+}
+
+void MainWindow::onScrubReleased() {
+    rebuildReplayHistory();
+}
+
+void MainWindow::toggleReplayPlayback() {
+    if (replayTimer->isActive()) {
+        replayTimer->stop();
+        playButton->setText("Play");
+    } else {
+        playButton->setText("Pause");
+        stepReplay();
     }
-    
-    if (memTotal == 0) return 0.0;
-    return 100.0 * (memTotal - memAvailable) / memTotal;
 }
 
-double MainWindow::getDiskUsage() {
-    struct statvfs stat;
-    if (statvfs("/", &stat) != 0) {
-        return 0.0;
+void MainWindow::stepReplay() {
+    double previous = replayFrame.stats.timestamp;
+    if (!replay->advance(replayPosition)) {
+        playButton->setText("Play");
+        return;
     }
     
-    unsigned long long total = stat.f_blocks * stat.f_frsize;
-    unsigned long long available = stat.f_bavail * stat.f_frsize;
+    showReplayFrame();
+    appendHistory(replayFrame.stats);
+    refreshCharts();
     
-    return 100.0 * (total - available) / total;
+    // recorded pacing, without sitting out the gap between two runs
+    double delay = (replayFrame.stats.timestamp - previous) * 1000.0;
+    replayTimer->start(static_cast<int>(qBound(10.0, delay, 5000.0)));
 }
 
-QString MainWindow::getUptime() {
-    std::ifstream file("/proc/uptime");
-    double uptime;
-    file >> uptime;
+void MainWindow::refreshCharts() {
+    // nothing is drawn while the charts are hidden
+    if (tabWidget->currentWidget() != chartsWidget || cpuHistory.tier(MetricHistory::Raw).empty()) return;
+    
+    // x is shown relative to the newest sample, in a unit that suits the window
+    double unit = chartWindow <= 60 ? 1.0 : chartWindow <= 3600 ? 60.0 : 3600.0;
+    QString unitName = unit == 1.0 ? "seconds ago" : unit == 60.0 ? "minutes ago" : "hours ago";
+    
+    // at most one point per pixel column of the plot area
+    int pixels = static_cast<int>(cpuChart->plotArea().width());
+    if (pixels < 2) pixels = 600;
+    
+    // traffic of the selected interface, or the sum when there is no history for it
+    const MetricHistory *download = &downloadHistory;
+    const MetricHistory *upload = &uploadHistory;
+    auto selected = interfaceHistories.find(selectedInterface);
+    if (!selectedInterface.empty() && selected != interfaceHistories.end()) {
+        download = &selectedDownload;
+        upload = &selectedUpload;
+        networkChart->setTitle(QString("Network Traffic (%1)").arg(QString::fromStdString(selectedInterface)));
+    } else {
+        networkChart->setTitle("Network Traffic");
+    }
     
-    int days = uptime / 86400;
-    int hours = (static_cast<int>(uptime) % 86400) / 3600;
-    int minutes = (static_cast<int>(uptime) % 3600) / 60;
+    fillSeries(cpuSeries, cpuHistory, unit, pixels);
+    fillSeries(memSeries, memHistory, unit, pixels);
+    double peak = qMax(fillSeries(downloadSeries, *download, unit, pixels),
+                       fillSeries(uploadSeries, *upload, unit, pixels));
     
-    return QString("%1d %2h %3m").arg(days).arg(hours).arg(minutes);
-}
-
-int MainWindow::getProcessCount() {
-    int count = 0;
-    DIR* dir = opendir("/proc");
-    if (dir) {
-        struct dirent* entry;
-        while ((entry = readdir(dir)) != nullptr) {
-            if (entry->d_type == DT_DIR) {
-                int pid = atoi(entry->d_name);
-                if (pid > 0) count++;
-            }
-        }
-        closedir(dir);
+    for (QChart *chart : {cpuChart, memChart, networkChart}) {
+        QAbstractAxis *axis = chart->axes(Qt::Horizontal).first();
+        axis->setRange(-chartWindow / unit, 0);
+        axis->setTitleText(unitName);
     }
-    return count;
+    networkChart->axes(Qt::Vertical).first()->setRange(0, peak > 0 ? peak * 1.1 : 1.0);
 }
 
-double MainWindow::getCPUTemperature() {
-    std::ifstream tempFile("/sys/class/thermal/thermal_zone0/temp");
-    if (tempFile.is_open()) {
-        int temp;
-        tempFile >> temp;
-        return temp / 1000.0;
+double MainWindow::fillSeries(QLineSeries *series, const MetricHistory &history, double unit, int pixels) {
+    const HistoryTier &tier = history.tier(history.levelFor(chartWindow));
+    size_t first = tier.lowerBound(lastSampleTime - chartWindow);
+    decimateLTTB(tier, first, tier.size() - first, static_cast<size_t>(pixels), decimated);
+    
+    double peak = 0.0;
+    chartPoints.resize(static_cast<int>(decimated.size()));
+    for (size_t i = 0; i < decimated.size(); i++) {
+        chartPoints[static_cast<int>(i)] = QPointF((decimated[i].x - lastSampleTime) / unit, decimated[i].y);
+        peak = qMax(peak, decimated[i].y);
     }
-    return -1.0;
+    
+    // one batched update instead of a repaint per appended point
+    series->replace(chartPoints);
+    return peak;
 }
 
-NetworkStats MainWindow::getNetworkStats() {
-    NetworkStats stats = {0, 0, 0, 0};
-    std::ifstream file("/proc/net/dev");
-    std::string line;
+void MainWindow::exportData() {
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Data", "", "CSV Files (*.csv)");
+    if (fileName.isEmpty()) return;
+    
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::critical(this, "Error", "Could not open file for writing.");
+        return;
+    }
     
-    // skip header lines
-    std::getline(file, line);
-    std::getline(file, line);
+    QTextStream out(&file);
+    out << "Resolution,Time,CPU % min,CPU % avg,CPU % max,Memory % min,Memory % avg,Memory % max\n";
     
-    while (std::getline(file, line)) {
-        if (line.find("lo:") != std::string::npos) continue; // Skip loopback
-        
-        std::istringstream ss(line);
-        std::string interface;
-        unsigned long long rxBytes, rxPackets, txBytes, txPackets;
-        unsigned long long dummy;
+    // coarse tiers first so rows run from oldest to newest within each resolution
+    const char *names[] = {"raw", "1m", "1h"};
+    for (int level = MetricHistory::Hour; level >= MetricHistory::Raw; level--) {
+        const HistoryTier &cpuTier = cpuHistory.tier(static_cast<MetricHistory::Level>(level));
+        const HistoryTier &memTier = memHistory.tier(static_cast<MetricHistory::Level>(level));
         
-        ss >> interface >> rxBytes >> rxPackets;
-        for (int i = 0; i < 6; i++) ss >> dummy;
-        ss >> txBytes >> txPackets;
-        
-        stats.rxBytes += rxBytes;
-        stats.rxPackets += rxPackets;
-        stats.txBytes += txBytes;
-        stats.txPackets += txPackets;
-    }
-    
-    return stats;
-}
-
-QVector<ProcessInfo> MainWindow::getProcessList() {
-    QVector<ProcessInfo> processes;
-    DIR* dir = opendir("/proc");
-    
-    if (!dir) return processes;
-    
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        if (entry->d_type == DT_DIR) {
-            int pid = atoi(entry->d_name);
-            if (pid <= 0) continue;
-            
-            ProcessInfo info;
-            info.pid = pid;
-            
-            // read process name
-            std::string statPath = "/proc/" + std::string(entry->d_name) + "/stat";
-            std::ifstream statFile(statPath);
-            if (statFile.is_open()) {
-                std::string line;
-                std::getline(statFile, line);
-                
-                size_t start = line.find('(');
-                size_t end = line.find(')');
-                if (start != std::string::npos && end != std::string::npos) {
-                    info.name = QString::fromStdString(line.substr(start + 1, end - start - 1));
-                }
-                
-                // simple cpu calculation 
-                info.cpu = 0.0;
-            }
-            
-            // read memory usage
-            std::string statusPath = "/proc/" + std::string(entry->d_name) + "/status";
-            std::ifstream statusFile(statusPath);
-            if (statusFile.is_open()) {
-                std::string line;
-                while (std::getline(statusFile, line)) {
-                    if (line.find("VmRSS:") == 0) {
-                        std::istringstream ss(line);
-                        std::string label;
-                        unsigned long long vmrss;
-                        ss >> label >> vmrss;
-                        
-                        // get total memory
-                        std::ifstream meminfo("/proc/meminfo");
-                        std::string memline;
-                        unsigned long long memTotal = 0;
-                        while (std::getline(meminfo, memline)) {
-                            if (memline.find("MemTotal:") == 0) {
-                                std::istringstream mss(memline);
-                                std::string mlabel;
-                                mss >> mlabel >> memTotal;
-                                break;
-                            }
-                        }
-                        
-                        if (memTotal > 0) {
-                            info.memory = (vmrss * 100.0) / memTotal;
-                        }
-                        break;
-                    }
-                    if (line.find("Uid:") == 0) {
-                        std::istringstream ss(line);
-                        std::string label;
-                        int uid;
-                        ss >> label >> uid;
-                        struct passwd* pw = getpwuid(uid);
-                        info.user = pw ? QString(pw->pw_name) : QString::number(uid);
-                    }
-                }
-            }
-            
-            processes.append(info);
+        for (size_t i = 0; i < cpuTier.size() && i < memTier.size(); i++) {
+            out << names[level] << ","
+                << QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(cpuTier.timeAt(i) * 1000)).toString(Qt::ISODate) << ","
+                << cpuTier.minAt(i) << "," << cpuTier.avgAt(i) << "," << cpuTier.maxAt(i) << ","
+                << memTier.minAt(i) << "," << memTier.avgAt(i) << "," << memTier.maxAt(i) << "\n";
         }
     }
     
-    closedir(dir);
-    return processes;
-}
\ No newline at end of file
+    file.close();
+    QMessageBox::information(this, "Success", "Data exported successfully!");
+}
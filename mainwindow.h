@@ -2,67 +2,102 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTimer>
 #include <QProgressBar>
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QTableView>
+#include <QTreeView>
 #include <QTableWidget>
+#include <QSortFilterProxyModel>
 #include <QTabWidget>
 #include <QPushButton>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QSlider>
+#include <QTimer>
 #include <QtCharts/QChart>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChartView>
 #include <QtCharts/QValueAxis>
 #include <QVector>
+#include <map>
+#include <memory>
+#include <string>
+#include "coreheatmap.h"
+#include "processmodel.h"
+#include "processtreemodel.h"
+#include "decimate.h"
+#include "metrichistory.h"
+#include "recorder.h"
+#include "recordingreader.h"
+#include "sampler.h"
 
 using namespace QtCharts;
 
-struct ProcessInfo {
-    int pid;
-    QString name;
-    double cpu;
-    double memory;
-    QString user;
-};
-
-struct NetworkStats {
-    unsigned long long rxBytes;
-    unsigned long long txBytes;
-    unsigned long long rxPackets;
-    unsigned long long txPackets;
-};
-
 class MainWindow : public QMainWindow {
     Q_OBJECT
-
+    
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    
+    void setScanThreads(int threads);
+    
+    // count psi stall events (see PressureTriggers::add); false with a
+    // message box when the spec is refused
+    bool addPressureTrigger(const QString &spec);
+    
+    // keep the process list from kernel fork/exit events; on failure this
+    // warns and the window keeps walking /proc
+    bool trackProcessEvents();
+    
+    // sample cpu, memory and network every periodMs (10-100) between
+    // updates and show their min/mean/max; 0 turns it off
+    bool setFastInterval(int periodMs);
+    
+    // append every sample to a recording in directory; false with a
+    // message box when it cannot be opened
+    bool startRecording(const QString &directory, bool withProcesses);
+    
+    // stop live sampling and show a recording instead, starting at from
+    // (see parseTimeArgument; empty for the beginning)
+    bool startReplay(const QString &path, const QString &from);
 
 private slots:
     void updateStats();
     void refreshProcessList();
     void onProcessKillClicked();
     void toggleAutoRefresh();
+    void toggleTreeView();
     void exportData();
-
+    void onChartWindowChanged();
+    void onInterfaceChanged();
+    void onScrubMoved(int value);
+    void onScrubReleased();
+    void toggleReplayPlayback();
+    void stepReplay();
+    
 private:
     void setupUI();
     void setupOverviewTab();
     void setupProcessTab();
     void setupNetworkTab();
+    void setupDiskTab();
+    void setupCgroupTab();
     void setupChartsTab();
-    
-    // system metrics
-    double getCPUUsage();
-    double getMemoryUsage();
-    double getDiskUsage();
-    QString getUptime();
-    int getProcessCount();
-    double getCPUTemperature();
-    NetworkStats getNetworkStats();
-    QVector<ProcessInfo> getProcessList();
+    void renderSnapshot(const Snapshot &snapshot);
+    void appendHistory(const SystemStats &stats, const std::vector<InterfaceStats> *interfaces = nullptr);
+    void updateInterfaceTable(const std::vector<InterfaceStats> &interfaces);
+    void updateDiskTables(const Snapshot &snapshot);
+    void updateCgroupTable(const std::vector<CgroupStats> &cgroups);
+    void updateSelfStats(const Snapshot &snapshot);
+    static QTableWidget *createTable(const QStringList &headers);
+    static void setRowTexts(QTableWidget *table, int row, const QStringList &cells);
+    void seekReplay(double time, bool withCharts);
+    void showReplayFrame();
+    void rebuildReplayHistory();
+    void refreshCharts();
+    double fillSeries(QLineSeries *series, const MetricHistory &history, double unit, int pixels);
     
     // ui components - overview tab
     QProgressBar *cpuBar;
@@ -75,23 +110,50 @@ private:
     QLabel *processCountLabel;
     QLabel *tempLabel;
     QLabel *cpuDetailLabel;
+    CoreHeatmap *coreHeatmap;
     QLabel *memDetailLabel;
     QLabel *diskDetailLabel;
+    QLabel *cpuPressureLabel;
+    QLabel *memPressureLabel;
+    QLabel *ioPressureLabel;
+    QLabel *stallEventsLabel;
+    QLabel *cpuBurstLabel;
+    QLabel *memBurstLabel;
+    QLabel *samplingLabel;
     
     // ui components - process tab
-    QTableWidget *processTable;
+    QTableView *processTable;
+    ProcessModel *processModel;
+    QSortFilterProxyModel *processProxy;
+    QTreeView *processTree;
+    ProcessTreeModel *processTreeModel;
+    QSortFilterProxyModel *processTreeProxy;
+    QCheckBox *treeViewCheckbox;
     QPushButton *killButton;
     QPushButton *refreshButton;
     QCheckBox *autoRefreshCheckbox;
     
     // ui components - network tab
+    QComboBox *interfaceCombo;
+    QTableWidget *interfaceTable;
     QLabel *downloadLabel;
     QLabel *uploadLabel;
     QLabel *totalDownloadLabel;
     QLabel *totalUploadLabel;
     QProgressBar *networkBar;
+    QLabel *networkPeakLabel;
+    
+    // ui components - disks tab
+    QTableWidget *deviceTable;
+    QTableWidget *mountTable;
+    
+    // ui components - cgroups tab
+    QTableWidget *cgroupTable;
+    QLabel *cgroupSummaryLabel;
     
     // ui components - charts tab
+    QWidget *chartsWidget;
+    QComboBox *windowCombo;
     QChart *cpuChart;
     QChart *memChart;
     QChart *networkChart;
@@ -105,16 +167,50 @@ private:
     
     // main components
     QTabWidget *tabWidget;
-    QTimer *timer;
     QPushButton *exportButton;
+    QLabel *selfStatsLabel;             // status bar: what sampling costs the monitor
+    
+    // replay bar, hidden while sampling live
+    QWidget *replayBar;
+    QPushButton *playButton;
+    QSlider *scrubSlider;
+    QLabel *scrubLabel;
+    QTimer *replayTimer;
     
     // data tracking
+    Sampler sampler;
+    std::unique_ptr<Recorder> recorder;
+    std::unique_ptr<RecordingReader> replay;
+    RecordingReader::Position replayPosition;
+    Snapshot replayFrame;
+    Snapshot replayScratch;
     int timePoint;
-    unsigned long long lastTotalTime;
-    unsigned long long lastIdleTime;
-    NetworkStats lastNetStats;
-    QVector<double> cpuHistory;
-    QVector<double> memHistory;
+    double lastSampleTime;
+    double chartWindow;
+    std::vector<ChartPoint> decimated;
+    QVector<QPointF> chartPoints;
+    MetricHistory cpuHistory;
+    MetricHistory memHistory;
+    MetricHistory downloadHistory;
+    MetricHistory uploadHistory;
+    
+    // a short raw-only download/upload ring per interface, created when an
+    // interface first shows up and dropped once it has been gone a while;
+    // empty during a replay, which only has the aggregate
+    struct InterfaceHistory {
+        InterfaceHistory();
+        
+        MetricHistory download;
+        MetricHistory upload;
+        double lastSeen;
+    };
+    std::map<std::string, InterfaceHistory> interfaceHistories;
+    std::string selectedInterface;
+    
+    // full-resolution history of the selected interface only, seeded from
+    // its ring when it is chosen
+    MetricHistory selectedDownload;
+    MetricHistory selectedUpload;
     
     // settings
     bool autoRefresh;
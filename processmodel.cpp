@@ -0,0 +1,166 @@
+#include "processmodel.h"
+
+ProcessModel::ProcessModel(const StringPool &strings, QObject *parent)
+    : QAbstractTableModel(parent), strings(&strings) {
+}
+
+void ProcessModel::setStrings(const StringPool &pool) {
+    beginResetModel();
+    strings = &pool;
+    rows.clear();
+    rowOfPid.clear();
+    endResetModel();
+}
+
+QString ProcessModel::text(uint32_t id) const {
+    return QString::fromUtf8(strings->data(id), static_cast<int>(strings->length(id)));
+}
+
+int ProcessModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int ProcessModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ProcessModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+    
+    const ProcessInfo &info = rows[index.row()].info;
+    
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case PidColumn: return info.pid;
+        case NameColumn: return text(info.nameId);
+        case CpuColumn: return QString::number(info.cpu, 'f', 1);
+        case MemoryColumn: return QString::number(info.memory, 'f', 1);
+        case ReadColumn: return QString::number(info.readBytesPerSecond / 1024.0, 'f', 1);
+        case WriteColumn: return QString::number(info.writeBytesPerSecond / 1024.0, 'f', 1);
+        case ReadCallsColumn: return QString::number(info.readCallsPerSecond, 'f', 0);
+        case WriteCallsColumn: return QString::number(info.writeCallsPerSecond, 'f', 0);
+        case UserColumn: return text(info.userId);
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case PidColumn: return info.pid;
+        case NameColumn: return text(info.nameId);
+        case CpuColumn: return info.cpu;
+        case MemoryColumn: return info.memory;
+        case ReadColumn: return info.readBytesPerSecond;
+        case WriteColumn: return info.writeBytesPerSecond;
+        case ReadCallsColumn: return info.readCallsPerSecond;
+        case WriteCallsColumn: return info.writeCallsPerSecond;
+        case UserColumn: return text(info.userId);
+        }
+    } else if (role == Qt::TextAlignmentRole) {
+        if (index.column() != NameColumn && index.column() != UserColumn) {
+            return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+    
+    return QVariant();
+}
+
+QVariant ProcessModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    
+    switch (section) {
+    case PidColumn: return QString("PID");
+    case NameColumn: return QString("Name");
+    case CpuColumn: return QString("CPU %");
+    case MemoryColumn: return QString("Memory %");
+    case ReadColumn: return QString("Read KB/s");
+    case WriteColumn: return QString("Write KB/s");
+    case ReadCallsColumn: return QString("Read Calls/s");
+    case WriteCallsColumn: return QString("Write Calls/s");
+    case UserColumn: return QString("User");
+    }
+    return QVariant();
+}
+
+void ProcessModel::setProcesses(const std::vector<ProcessInfo> &processes) {
+    for (Row &row : rows) row.seen = false;
+    
+    // update rows for pids we already have, collect the new ones. nearly
+    // every row changes each tick, so the changes go out as one range
+    // rather than a signal (and a proxy re-sort) per row
+    std::vector<const ProcessInfo*> added;
+    int firstChanged = rows.size();
+    int lastChanged = -1;
+    for (const ProcessInfo &info : processes) {
+        int rowIndex = rowOfPid.value(info.pid, -1);
+        if (rowIndex < 0) {
+            added.push_back(&info);
+            continue;
+        }
+        
+        Row &row = rows[rowIndex];
+        row.seen = true;
+        
+        bool changed = row.info.cpu != info.cpu || row.info.memory != info.memory
+                       || row.info.readBytesPerSecond != info.readBytesPerSecond
+                       || row.info.writeBytesPerSecond != info.writeBytesPerSecond
+                       || row.info.readCallsPerSecond != info.readCallsPerSecond
+                       || row.info.writeCallsPerSecond != info.writeCallsPerSecond
+                       || row.info.nameId != info.nameId || row.info.userId != info.userId;
+        if (changed) {
+            row.info = info;
+            firstChanged = qMin(firstChanged, rowIndex);
+            lastChanged = qMax(lastChanged, rowIndex);
+        }
+    }
+    if (lastChanged >= 0) emit dataChanged(index(firstChanged, NameColumn), index(lastChanged, UserColumn));
+    
+    removeUnseenRows();
+    
+    if (!added.empty()) {
+        int first = rows.size();
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(added.size()) - 1);
+        for (const ProcessInfo *info : added) {
+            rowOfPid.insert(info->pid, rows.size());
+            rows.append({*info, true});
+        }
+        endInsertRows();
+    }
+}
+
+void ProcessModel::removeUnseenRows() {
+    int lowest = rows.size();
+    
+    // walk backwards so contiguous runs of exited pids go in a single removal
+    int row = rows.size() - 1;
+    while (row >= 0) {
+        if (rows[row].seen) {
+            row--;
+            continue;
+        }
+        
+        int last = row;
+        while (row >= 0 && !rows[row].seen) row--;
+        int first = row + 1;
+        
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int i = first; i <= last; i++) rowOfPid.remove(rows[i].info.pid);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        endRemoveRows();
+        
+        lowest = first;
+    }
+    
+    if (lowest < rows.size()) rebuildIndex(lowest);
+}
+
+void ProcessModel::rebuildIndex(int fromRow) {
+    for (int i = fromRow; i < rows.size(); i++) {
+        rowOfPid.insert(rows[i].info.pid, i);
+    }
+}
+
+int ProcessModel::pidAt(int row) const {
+    return row >= 0 && row < rows.size() ? rows[row].info.pid : -1;
+}
+
+QString ProcessModel::nameAt(int row) const {
+    return row >= 0 && row < rows.size() ? text(rows[row].info.nameId) : QString();
+}
@@ -0,0 +1,65 @@
+#ifndef PROCESSMODEL_H
+#define PROCESSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+#include <vector>
+#include "stringpool.h"
+#include "systemstats.h"
+
+// table model over the latest process snapshot. setProcesses() diffs the new
+// snapshot against the current rows by pid and only emits row inserts,
+// removals and dataChanged for what actually changed, so views keep their
+// selection and scroll position. sorting is left to a QSortFilterProxyModel
+// that sorts on SortRole.
+class ProcessModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        PidColumn,
+        NameColumn,
+        CpuColumn,
+        MemoryColumn,
+        ReadColumn,
+        WriteColumn,
+        ReadCallsColumn,
+        WriteCallsColumn,
+        UserColumn,
+        ColumnCount
+    };
+    
+    static const int SortRole = Qt::UserRole;
+    
+    explicit ProcessModel(const StringPool &strings, QObject *parent = nullptr);
+    
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    
+    void setProcesses(const std::vector<ProcessInfo> &processes);
+    
+    // switch to ids from another pool (e.g. a replay); drops every row
+    void setStrings(const StringPool &pool);
+    
+    int pidAt(int row) const;
+    QString nameAt(int row) const;
+    
+private:
+    struct Row {
+        ProcessInfo info;
+        bool seen;
+    };
+    
+    QString text(uint32_t id) const;
+    void removeUnseenRows();
+    void rebuildIndex(int fromRow);
+    
+    const StringPool *strings;
+    QVector<Row> rows;
+    QHash<int, int> rowOfPid;
+};
+
+#endif
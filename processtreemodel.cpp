@@ -0,0 +1,143 @@
+#include "processtreemodel.h"
+
+ProcessTreeModel::ProcessTreeModel(const StringPool &strings, QObject *parent)
+    : QAbstractItemModel(parent), strings(&strings) {
+}
+
+void ProcessTreeModel::setStrings(const StringPool &pool) {
+    beginResetModel();
+    strings = &pool;
+    tree.clear();
+    endResetModel();
+}
+
+QString ProcessTreeModel::text(uint32_t id) const {
+    return QString::fromUtf8(strings->data(id), static_cast<int>(strings->length(id)));
+}
+
+QModelIndex ProcessTreeModel::indexOf(int pid, int column) const {
+    const ProcessTreeNode *node = pid != 0 ? tree.find(pid) : nullptr;
+    if (!node) return QModelIndex();
+    return createIndex(node->position, column, static_cast<quintptr>(pid));
+}
+
+QModelIndex ProcessTreeModel::index(int row, int column, const QModelIndex &parent) const {
+    if (parent.isValid() && parent.column() != 0) return QModelIndex();
+    
+    const std::vector<int> &children = tree.children(parent.isValid() ? pidAt(parent) : 0);
+    if (row < 0 || row >= static_cast<int>(children.size()) || column < 0 || column >= ColumnCount) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, static_cast<quintptr>(children[row]));
+}
+
+QModelIndex ProcessTreeModel::parent(const QModelIndex &index) const {
+    const ProcessTreeNode *node = index.isValid() ? tree.find(pidAt(index)) : nullptr;
+    return node ? indexOf(node->parent, 0) : QModelIndex();
+}
+
+int ProcessTreeModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() && parent.column() != 0) return 0;
+    return static_cast<int>(tree.children(parent.isValid() ? pidAt(parent) : 0).size());
+}
+
+int ProcessTreeModel::columnCount(const QModelIndex &) const {
+    return ColumnCount;
+}
+
+QVariant ProcessTreeModel::data(const QModelIndex &index, int role) const {
+    const ProcessTreeNode *node = index.isValid() ? tree.find(pidAt(index)) : nullptr;
+    if (!node) return QVariant();
+    
+    const ProcessInfo &info = node->info;
+    
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn: return text(info.nameId);
+        case PidColumn: return info.pid;
+        case CpuColumn: return QString::number(info.cpu, 'f', 1);
+        case TreeCpuColumn: return QString::number(node->subtreeCpu, 'f', 1);
+        case MemoryColumn: return QString::number(info.memory, 'f', 1);
+        case TreeMemoryColumn: return QString::number(node->subtreeMemory, 'f', 1);
+        case UserColumn: return text(info.userId);
+        }
+    } else if (role == SortRole) {
+        switch (index.column()) {
+        case NameColumn: return text(info.nameId);
+        case PidColumn: return info.pid;
+        case CpuColumn: return info.cpu;
+        case TreeCpuColumn: return node->subtreeCpu;
+        case MemoryColumn: return info.memory;
+        case TreeMemoryColumn: return node->subtreeMemory;
+        case UserColumn: return text(info.userId);
+        }
+    } else if (role == Qt::ToolTipRole) {
+        if (node->descendants > 0) {
+            return QString("%1 descendants").arg(node->descendants);
+        }
+    } else if (role == Qt::TextAlignmentRole) {
+        if (index.column() != NameColumn && index.column() != UserColumn) {
+            return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+    
+    return QVariant();
+}
+
+QVariant ProcessTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    
+    switch (section) {
+    case NameColumn: return QString("Name");
+    case PidColumn: return QString("PID");
+    case CpuColumn: return QString("CPU %");
+    case TreeCpuColumn: return QString("Tree CPU %");
+    case MemoryColumn: return QString("Memory %");
+    case TreeMemoryColumn: return QString("Tree Memory %");
+    case UserColumn: return QString("User");
+    }
+    return QVariant();
+}
+
+void ProcessTreeModel::setProcesses(const std::vector<ProcessInfo> &processes) {
+    tree.update(processes, this);
+    
+    // values change everywhere each tick, subtree totals included, so
+    // refresh each level with one signal rather than one per row
+    const std::vector<int> &roots = tree.children(0);
+    if (!roots.empty()) {
+        emit dataChanged(index(0, 0), index(static_cast<int>(roots.size()) - 1, ColumnCount - 1));
+    }
+    for (int pid : tree.order()) {
+        const ProcessTreeNode *node = tree.find(pid);
+        if (node->children.empty()) continue;
+        QModelIndex parent = indexOf(pid, 0);
+        emit dataChanged(index(0, 0, parent),
+                         index(static_cast<int>(node->children.size()) - 1, ColumnCount - 1, parent));
+    }
+}
+
+void ProcessTreeModel::beginInsert(int parent, int position) {
+    beginInsertRows(indexOf(parent, 0), position, position);
+}
+
+void ProcessTreeModel::endInsert() {
+    endInsertRows();
+}
+
+void ProcessTreeModel::beginRemove(int parent, int position) {
+    beginRemoveRows(indexOf(parent, 0), position, position);
+}
+
+void ProcessTreeModel::endRemove() {
+    endRemoveRows();
+}
+
+int ProcessTreeModel::pidAt(const QModelIndex &index) const {
+    return index.isValid() ? static_cast<int>(index.internalId()) : -1;
+}
+
+QString ProcessTreeModel::nameAt(const QModelIndex &index) const {
+    const ProcessTreeNode *node = index.isValid() ? tree.find(pidAt(index)) : nullptr;
+    return node ? text(node->info.nameId) : QString();
+}
@@ -0,0 +1,64 @@
+#ifndef PROCESSTREEMODEL_H
+#define PROCESSTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <vector>
+#include "processtree.h"
+#include "stringpool.h"
+#include "systemstats.h"
+
+// tree model over the latest process snapshot, parent processes above their
+// children. the ProcessTree underneath only reports the pids that appeared,
+// exited or were reparented, and those become single row inserts and
+// removals, so expanded branches and the selection survive a refresh. an
+// index's internal id is its pid. sorting, per level, is left to a
+// QSortFilterProxyModel that sorts on SortRole.
+class ProcessTreeModel : public QAbstractItemModel, private ProcessTree::Listener {
+    Q_OBJECT
+    
+public:
+    enum Column {
+        NameColumn,
+        PidColumn,
+        CpuColumn,
+        TreeCpuColumn,
+        MemoryColumn,
+        TreeMemoryColumn,
+        UserColumn,
+        ColumnCount
+    };
+    
+    static const int SortRole = Qt::UserRole;
+    
+    explicit ProcessTreeModel(const StringPool &strings, QObject *parent = nullptr);
+    
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    
+    void setProcesses(const std::vector<ProcessInfo> &processes);
+    
+    // switch to ids from another pool (e.g. a replay); drops every row
+    void setStrings(const StringPool &pool);
+    
+    int pidAt(const QModelIndex &index) const;
+    QString nameAt(const QModelIndex &index) const;
+    
+private:
+    void beginInsert(int parent, int position) override;
+    void endInsert() override;
+    void beginRemove(int parent, int position) override;
+    void endRemove() override;
+    
+    // index of a linked pid, invalid for 0 (the top level)
+    QModelIndex indexOf(int pid, int column) const;
+    QString text(uint32_t id) const;
+    
+    const StringPool *strings;
+    ProcessTree tree;
+};
+
+#endif
@@ -0,0 +1,234 @@
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "terminalmonitor.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+static TerminalMonitor* runningMonitor = nullptr;
+
+static void requestStop(int) {
+    stopRequested = 1;
+    if (runningMonitor) runningMonitor->interrupt();
+}
+
+// a whole number with nothing after it; atoi() would take "5Oms" as 0,
+// which turns fast sampling off
+static bool parseMilliseconds(const std::string& text, int& out) {
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+// terminal-only entry point: links syspulse_core and nothing from qt
+int main(int argc, char *argv[]) {
+    std::string recordDirectory;
+    bool recordProcesses = false;
+    std::string replayPath;
+    std::string replayFrom;
+    double replaySpeed = 1.0;
+    bool daemon = false;
+    std::vector<std::string> listenAddresses;
+    std::vector<std::string> socketPaths;
+    std::string interfaceName;
+    std::vector<std::string> pressureTriggers;
+    int fastInterval = 100;
+    bool selfStats = false;
+    bool processTree = false;
+    bool processEvents = false;
+    bool topIo = false;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "SysPulse - System Resource Monitor (terminal build)\n\n"
+                      << "Options:\n"
+                      << "  -h, --help            Display help information\n"
+                      << "  -v, --version         Display version information\n"
+                      << "  --record <dir>        Append every sample to a compressed recording\n"
+                      << "  --record-processes    Include the process table in the recording\n"
+                      << "  --replay <path>       Play back a recording instead of sampling /proc\n"
+                      << "  --from <time>         Start the replay at unix seconds, \"YYYY-MM-DD HH:MM\" or \"HH:MM\"\n"
+                      << "  --speed <x>           Replay speed relative to real time (default 1)\n"
+                      << "  --daemon              Serve prometheus metrics instead of drawing\n"
+                      << "  --listen <addr>       Daemon tcp address, [host:]port (default 127.0.0.1:9101)\n"
+                      << "  --socket <path>       Daemon unix socket, instead of or besides --listen\n"
+                      << "  --interface <name>    Show speed and totals of one interface instead of all\n"
+                      << "  --fast-interval <ms>  Sample cpu, memory and network every 10-100 ms\n"
+                      << "                        between frames, 0 for off (default 100)\n"
+                      << "  --psi-trigger <spec>  Count pressure stalls, e.g. memory:some:150:1000 for\n"
+                      << "                        150ms of memory stall within 1s (repeatable)\n"
+                      << "  --self-stats          Show the time, syscalls and bytes each collector costs\n"
+                      << "  --tree                List processes as a tree with subtree cpu and memory\n"
+                      << "  --top-io              List the processes doing the most disk io\n"
+                      << "  --proc-events         Track processes from kernel fork/exit events instead\n"
+                      << "                        of walking /proc each sample (needs CAP_NET_ADMIN)\n";
+            return 0;
+        }
+        if (arg == "--version" || arg == "-v") {
+            std::cout << "SysPulse 2.0" << std::endl;
+            return 0;
+        }
+        if (arg == "--record" || arg == "--replay" || arg == "--from" || arg == "--speed" ||
+            arg == "--listen" || arg == "--socket" || arg == "--interface" || arg == "--psi-trigger" ||
+            arg == "--fast-interval") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value" << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--record") recordDirectory = value;
+            else if (arg == "--replay") replayPath = value;
+            else if (arg == "--from") replayFrom = value;
+            else if (arg == "--listen") listenAddresses.push_back(value);
+            else if (arg == "--socket") socketPaths.push_back(value);
+            else if (arg == "--interface") interfaceName = value;
+            else if (arg == "--psi-trigger") pressureTriggers.push_back(value);
+            else if (arg == "--fast-interval") {
+                if (!parseMilliseconds(value, fastInterval)) {
+                    std::cerr << "--fast-interval needs a whole number of milliseconds, not " << value << std::endl;
+                    return 1;
+                }
+            } else {
+                replaySpeed = std::atof(value.c_str());
+            }
+            continue;
+        }
+        if (arg == "--daemon") {
+            daemon = true;
+            continue;
+        }
+        if (arg == "--record-processes") {
+            recordProcesses = true;
+            continue;
+        }
+        if (arg == "--self-stats") {
+            selfStats = true;
+            continue;
+        }
+        if (arg == "--tree") {
+            processTree = true;
+            continue;
+        }
+        if (arg == "--top-io") {
+            topIo = true;
+            continue;
+        }
+        if (arg == "--proc-events") {
+            processEvents = true;
+            continue;
+        }
+        if (arg != "--terminal" && arg != "-t") {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!replayPath.empty() && (!recordDirectory.empty() || daemon)) {
+        std::cerr << "--replay cannot be combined with --record or --daemon" << std::endl;
+        return 1;
+    }
+    if (!replayPath.empty() && !pressureTriggers.empty()) {
+        std::cerr << "--replay cannot be combined with --psi-trigger" << std::endl;
+        return 1;
+    }
+    if (fastInterval != 0 && (fastInterval < FastSampler::MinPeriodMs || fastInterval > FastSampler::MaxPeriodMs)) {
+        std::cerr << "--fast-interval must be 0 or between 10 and 100" << std::endl;
+        return 1;
+    }
+    if (!replayPath.empty() && processEvents) {
+        std::cerr << "--replay cannot be combined with --proc-events" << std::endl;
+        return 1;
+    }
+    if (replaySpeed <= 0) {
+        std::cerr << "--speed must be positive" << std::endl;
+        return 1;
+    }
+    
+    TerminalMonitor monitor;
+    monitor.setInterface(interfaceName);
+    monitor.setFastInterval(fastInterval);
+    monitor.setSelfStats(selfStats);
+    monitor.setProcessTree(processTree);
+    monitor.setTopIo(topIo);
+    for (const std::string& spec : pressureTriggers) {
+        std::string error;
+        if (!monitor.addPressureTrigger(spec, error)) {
+            std::cerr << "Cannot add pressure trigger: " << error << std::endl;
+            return 1;
+        }
+    }
+    if (processEvents) {
+        // polling still works, just at the cost of a walk per sample
+        std::string error;
+        if (!monitor.trackProcessEvents(error)) {
+            std::cerr << "Falling back to /proc polling: " << error << std::endl;
+        }
+    }
+    
+    // leave the loop on ctrl+c so the recorder can flush its last block
+    runningMonitor = &monitor;
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    
+    if (!replayPath.empty()) {
+        RecordingReader reader;
+        if (!reader.open(replayPath)) {
+            std::cerr << "Cannot replay: " << reader.error() << std::endl;
+            return 1;
+        }
+        
+        double from = reader.startTime();
+        if (!replayFrom.empty() && !parseTimeArgument(replayFrom, reader.startTime(), from)) {
+            std::cerr << "Cannot parse --from time: " << replayFrom << std::endl;
+            return 1;
+        }
+        monitor.replay(reader, from, replaySpeed, &stopRequested);
+        return 0;
+    }
+    
+    std::unique_ptr<Recorder> recorder;
+    if (!recordDirectory.empty()) {
+        recorder.reset(new Recorder(recordDirectory, recordProcesses));
+        if (!recorder->open()) {
+            std::cerr << "Cannot record: " << recorder->error() << std::endl;
+            return 1;
+        }
+        monitor.setRecorder(recorder.get());
+    }
+    
+    if (daemon) {
+        MetricsServer server;
+        if (listenAddresses.empty() && socketPaths.empty()) listenAddresses.push_back("127.0.0.1:9101");
+        for (const std::string& address : listenAddresses) {
+            if (!server.listenTcp(address)) {
+                std::cerr << "Cannot listen: " << server.error() << std::endl;
+                return 1;
+            }
+        }
+        for (const std::string& path : socketPaths) {
+            if (!server.listenUnix(path)) {
+                std::cerr << "Cannot listen: " << server.error() << std::endl;
+                return 1;
+            }
+        }
+        if (!monitor.serve(server, &stopRequested)) {
+            std::cerr << "Daemon stopped: " << server.error() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    monitor.run(&stopRequested);
+    return 0;
+}
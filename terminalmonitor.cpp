@@ -1,53 +1,14 @@
 #include "terminalmonitor.h"
+#include "prometheus.h"
+#include <algorithm>
+#include <climits>
+#include <ctime>
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <iomanip>
-#include <unistd.h>
-#include <sys/statvfs.h>
-#include <thread>
-#include <chrono>
-#include <cmath>
-
-// ANSI color codes
-const std::string TerminalMonitor::RESET = "\033[0m";
-const std::string TerminalMonitor::RED = "\033[31m";
-const std::string TerminalMonitor::GREEN = "\033[32m";
-const std::string TerminalMonitor::YELLOW = "\033[33m";
-const std::string TerminalMonitor::BLUE = "\033[34m";
-const std::string TerminalMonitor::MAGENTA = "\033[35m";
-const std::string TerminalMonitor::CYAN = "\033[36m";
-const std::string TerminalMonitor::BOLD = "\033[1m";
 
 TerminalMonitor::TerminalMonitor() 
-    : lastTotalTime(0), lastIdleTime(0), lastRxBytes(0), lastTxBytes(0) {
-}
-
-void TerminalMonitor::clearScreen() {
-    std::cout << "\033[2J\033[H"; // clear screen and move cursor to home; note to self: don't touch :) 
-}
-
-std::string TerminalMonitor::colorize(const std::string& text, const std::string& color) {
-    return color + text + RESET;
-}
-
-std::string TerminalMonitor::getProgressBar(double percentage, int width) {
-    int filled = static_cast<int>(percentage * width / 100.0);
-    int empty = width - filled;
-    
-    std::string color;
-    if (percentage < 50) color = GREEN;
-    else if (percentage < 80) color = YELLOW;
-    else color = RED;
-    
-    std::string bar = "[";
-    bar += color;
-    for (int i = 0; i < filled; i++) bar += "█";
-    bar += RESET;
-    for (int i = 0; i < empty; i++) bar += "░";
-    bar += "]";
-    
-    return bar;
+    : fastInterval(100), showSelfStats(false), showTree(false), showTopIo(false), processRows(INT_MAX), recorder(nullptr), footer("Refreshing every 2 seconds...") {
 }
 
 std::string TerminalMonitor::formatBytes(unsigned long long bytes) {
@@ -65,192 +26,659 @@ std::string TerminalMonitor::formatBytes(unsigned long long bytes) {
     return oss.str();
 }
 
-SystemStats TerminalMonitor::getStats() {
-    SystemStats stats;
-    
-    // cpu usage
-    std::ifstream cpuFile("/proc/stat");
-    std::string line;
-    std::getline(cpuFile, line);
-    
-    std::istringstream ss(line);
-    std::string cpu;
-    unsigned long long user, nice, system, idle, iowait, irq, softirq;
-    ss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq;
-    
-    unsigned long long totalTime = user + nice + system + idle + iowait + irq + softirq;
-    unsigned long long idleTime = idle + iowait;
-    
-    if (lastTotalTime != 0) {
-        unsigned long long totalDiff = totalTime - lastTotalTime;
-        unsigned long long idleDiff = idleTime - lastIdleTime;
-        stats.cpu = 100.0 * (totalDiff - idleDiff) / totalDiff;
-    } else {
-        stats.cpu = 0.0;
+const Snapshot& TerminalMonitor::collect() {
+    bool recordProcesses = recorder && recorder->recordsProcesses();
+    collector.collect(current, recordProcesses || showTree || showTopIo);
+    fast.take(current.fast);
+    current.stats.cpuPeak = current.fast.samples > 0 ? current.fast.cpu.max : current.stats.cpu;
+    
+    if (recorder) {
+        if (!recorder->append(current.stats, recordProcesses ? &current.processes : nullptr, &collector.strings()) &&
+            !recorder->error().empty()) {
+            std::cerr << "recording stopped: " << recorder->error() << std::endl;
+            recorder = nullptr;
+        }
     }
+    return current;
+}
+
+int TerminalMonitor::openSection(int row, const char* title, uint8_t color) {
+    int col = screen.print(row, 0, "┌─ ", color);
+    col = screen.print(row, col, title, color);
+    col = screen.print(row, col, " ", color);
+    screen.repeat(row, col, SectionWidth - col, "─");
+    return row + 1;
+}
+
+int TerminalMonitor::closeSection(int row) {
+    screen.print(row, 0, "└");
+    screen.repeat(row, 1, SectionWidth - 1, "─");
+    return row + 2;
+}
+
+int TerminalMonitor::drawUsage(int row, const char* title, uint8_t color, double percentage,
+                               const std::string& detail) {
+    row = openSection(row, title, color);
+    int col = screen.print(row, 0, "│ ");
+    col = screen.bar(row, col, percentage, 50);
+    screen.printf(row++, col + 1, TerminalScreen::Bold, "%d%%", static_cast<int>(percentage));
+    if (!detail.empty()) screen.print(row++, 0, "│ " + detail);
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawCores(int row, const CoreUsage& cores) {
+    static const char* const levels[] = {" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    const int perRow = SectionWidth - 5;
     
-    lastTotalTime = totalTime;
-    lastIdleTime = idleTime;
-    
-    // memory usage
-    std::ifstream memFile("/proc/meminfo");
-    unsigned long long memTotal = 0, memAvailable = 0;
-    while (std::getline(memFile, line)) {
-        if (line.find("MemTotal:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memTotal;
-        } else if (line.find("MemAvailable:") == 0) {
-            std::istringstream ss(line);
-            std::string label;
-            ss >> label >> memAvailable;
+    row = openSection(row, "CPU Cores", TerminalScreen::Blue);
+    
+    // one cell per core, height for busy and colour for load; heavy steal
+    // shows in magenta so a noisy neighbour stands out
+    size_t busiest[3] = {0, 0, 0};
+    size_t mostStolen = 0;
+    for (size_t i = 0; i < cores.size(); i++) {
+        if (i % perRow == 0) screen.print(row + static_cast<int>(i / perRow), 0, "│ ");
+        
+        float busy = cores.busy[i];
+        int level = static_cast<int>(busy * 8.0f / 100.0f + 0.5f);
+        level = std::max(0, std::min(8, level));
+        uint8_t color = cores.steal[i] >= 10.0f ? TerminalScreen::Magenta
+                      : busy < 50.0f ? TerminalScreen::Green
+                      : busy < 80.0f ? TerminalScreen::Yellow : TerminalScreen::Red;
+        screen.print(row + static_cast<int>(i / perRow), 2 + static_cast<int>(i % perRow), levels[level], color);
+        
+        // keep the three busiest, best first
+        size_t rank = std::min<size_t>(i, 3);
+        while (rank > 0 && busy > cores.busy[busiest[rank - 1]]) {
+            if (rank < 3) busiest[rank] = busiest[rank - 1];
+            rank--;
         }
+        if (rank < 3) busiest[rank] = i;
+        if (cores.steal[i] > cores.steal[mostStolen]) mostStolen = i;
     }
-    stats.memory = memTotal > 0 ? 100.0 * (memTotal - memAvailable) / memTotal : 0.0;
-    
-    // Disk Usage
-    struct statvfs diskStat;
-    if (statvfs("/", &diskStat) == 0) {
-        unsigned long long total = diskStat.f_blocks * diskStat.f_frsize;
-        unsigned long long available = diskStat.f_bavail * diskStat.f_frsize;
-        stats.disk = 100.0 * (total - available) / total;
-    } else {
-        stats.disk = 0.0;
+    row += static_cast<int>((cores.size() + perRow - 1) / perRow);
+    
+    int col = screen.print(row, 0, "│ busiest:");
+    for (size_t rank = 0; rank < 3 && rank < cores.size(); rank++) {
+        size_t i = busiest[rank];
+        col = screen.printf(row, col, TerminalScreen::Plain, "  cpu%d %.0f%%", cores.ids[i], cores.busy[i]);
     }
+    screen.printf(row++, col, TerminalScreen::Plain, "  │  max steal: cpu%d %.1f%%",
+                  cores.ids[mostStolen], cores.steal[mostStolen]);
+    return closeSection(row);
+}
+
+void TerminalMonitor::displayStats(const Snapshot& snapshot, const StringPool* strings) {
+    // sections left out, first to last, while a frame is taller than the
+    // terminal; the process list goes last
+    static const int dropOrder[] = {
+        SectionCores, SectionBursts, SectionDisks, SectionFilesystems, SectionPressure, SectionSelfStats,
+        SectionCgroups, SectionProcessIo, SectionNetwork,
+    };
+    if (snapshot.hasProcesses && strings && showTree) tree.update(snapshot.processes);
+    processRows = INT_MAX;
     
-    // uptime
-    std::ifstream uptimeFile("/proc/uptime");
-    double uptime;
-    uptimeFile >> uptime;
-    
-    int days = uptime / 86400;
-    int hours = (static_cast<int>(uptime) % 86400) / 3600;
-    int minutes = (static_cast<int>(uptime) % 3600) / 60;
-    
-    std::ostringstream uptimeStream;
-    uptimeStream << days << "d " << hours << "h " << minutes << "m";
-    stats.uptime = uptimeStream.str();
-    
-    // process count
-    stats.processes = 0;
-    std::ifstream loadavg("/proc/loadavg");
-    std::string dummy;
-    int running, total;
-    loadavg >> dummy >> dummy >> dummy >> running >> total;
-    stats.processes = total;
-    
-    // temperature
-    std::ifstream tempFile("/sys/class/thermal/thermal_zone0/temp");
-    if (tempFile.is_open()) {
-        int temp;
-        tempFile >> temp;
-        stats.temperature = temp / 1000.0;
-    } else {
-        stats.temperature = -1.0;
+    // the screen clips whatever is below its last row, so a frame that does
+    // not fit is drawn again without the sections that matter least
+    bool shown[SectionCount];
+    int heights[SectionCount];
+    std::fill(shown, shown + SectionCount, true);
+    int row = drawFrame(snapshot, strings, shown, heights);
+    int hidden = 0;
+    for (int section : dropOrder) {
+        if (row < screen.height()) break;
+        if (heights[section] == 0) continue;
+        shown[section] = false;
+        row -= heights[section];
+        hidden++;
     }
     
-    // network stats
-    std::ifstream netFile("/proc/net/dev");
-    std::getline(netFile, line); // skip header
-    std::getline(netFile, line); // same, skip header
+    // still too tall: shorten the process list, but keep a few of them.
+    // it takes a title, a heading and a closing blank line besides its rows
+    int listed = heights[SectionProcesses] - 4;
+    bool shortened = row >= screen.height() && listed > 3;
+    if (shortened) {
+        processRows = std::max(3, listed - (row - screen.height() + 1));
+        row -= listed - processRows;
+    }
+    if (hidden > 0 || shortened) row = drawFrame(snapshot, strings, shown, heights);
     
-    unsigned long long rxBytes = 0, txBytes = 0;
-    while (std::getline(netFile, line)) {
-        if (line.find("lo:") != std::string::npos) continue;
-        
-        std::istringstream ss(line);
-        std::string interface;
-        unsigned long long rx, tx, dummy;
-        
-        ss >> interface >> rx;
-        for (int i = 0; i < 7; i++) ss >> dummy;
-        ss >> tx;
+    // footer
+    int col = screen.print(row, 0, "Press Ctrl+C to exit", TerminalScreen::Cyan);
+    col = screen.print(row, col, " | " + footer);
+    if (hidden > 0) screen.printf(row, col, TerminalScreen::Yellow, " | %d sections hidden", hidden);
+    
+    screen.present();
+}
+
+int TerminalMonitor::drawFrame(const Snapshot& snapshot, const StringPool* strings, const bool* shown, int* heights) {
+    using Style = TerminalScreen;
+    screen.clear();
+    int row = 0;
+    
+    // header
+    screen.print(row++, 0, "╔════════════════════════════════════════════════════════════════════╗", Style::Cyan);
+    int col = screen.print(row, 0, "║", Style::Cyan);
+    col = screen.print(row, col, "                    SYSPULSE SYSTEM MONITOR                     ", Style::Bold);
+    screen.print(row++, col, "║", Style::Cyan);
+    screen.print(row++, 0, "╚════════════════════════════════════════════════════════════════════╝", Style::Cyan);
+    row++;
+    
+    for (int section = 0; section < SectionCount; section++) {
+        int start = row;
+        if (shown[section]) row = drawSection(section, row, snapshot, strings);
+        heights[section] = row - start;
+    }
+    return row;
+}
+
+int TerminalMonitor::drawSection(int section, int row, const Snapshot& snapshot, const StringPool* strings) {
+    using Style = TerminalScreen;
+    const SystemStats& stats = snapshot.stats;
+    bool processes = snapshot.hasProcesses && strings;
+    
+    switch (section) {
+    case SectionSystem:
+        return drawSystem(row, snapshot);
+    case SectionCpu: {
+        char detail[96];
+        snprintf(detail, sizeof(detail), "iowait %.1f%%  │  steal %.1f%%  │  %d cores",
+                 stats.cpuIowait, stats.cpuSteal, stats.cores);
+        return drawUsage(row, "CPU Usage", Style::Blue, stats.cpu, detail);
+    }
+    case SectionCores:
+        return snapshot.cores.size() > 0 ? drawCores(row, snapshot.cores) : row;
+    case SectionMemory:
+        return drawUsage(row, "Memory Usage", Style::Green, stats.memory);
+    case SectionBursts:
+        return snapshot.fast.samples > 0 ? drawBursts(row, snapshot.fast) : row;
+    case SectionFilesystems:
+        // replays only have the root filesystem
+        if (snapshot.mounts.empty()) return drawUsage(row, "Disk Usage (/)", Style::Yellow, stats.disk);
+        return drawFilesystems(row, snapshot.mounts);
+    case SectionDisks:
+        return !snapshot.devices.empty() ? drawDisks(row, snapshot.devices) : row;
+    case SectionPressure:
+        return drawPressure(row, snapshot);
+    case SectionNetwork:
+        return drawNetwork(row, stats, snapshot.interfaces);
+    case SectionCgroups:
+        return !snapshot.cgroups.empty() ? drawCgroups(row, snapshot.cgroups) : row;
+    case SectionSelfStats:
+        return showSelfStats ? drawSelfStats(row, snapshot) : row;
+    case SectionProcesses:
+        if (!processes) return row;
+        return showTree ? drawProcessTree(row, *strings) : drawProcesses(row, snapshot.processes, *strings);
+    case SectionProcessIo:
+        return processes && showTopIo ? drawProcessIo(row, snapshot.processes, *strings) : row;
+    default:
+        return row;
+    }
+}
+
+int TerminalMonitor::drawSystem(int row, const Snapshot& snapshot) {
+    using Style = TerminalScreen;
+    const SystemStats& stats = snapshot.stats;
+    
+    row = openSection(row, "System Information", Style::Cyan);
+    int col = screen.print(row, 0, "│ ");
+    col = screen.print(row, col, "Uptime:", Style::Bold);
+    col = screen.print(row, col, " " + formatUptime(stats.uptime) + "  │  ");
+    col = screen.print(row, col, "Processes:", Style::Bold);
+    col = screen.printf(row, col, Style::Plain, " %d", stats.processes);
+    if (snapshot.events.active || stats.forkRate > 0 || stats.exitRate > 0) {
+        col = screen.printf(row, col, Style::Plain, " (%.1f forks/s, %.1f exits/s)", stats.forkRate, stats.exitRate);
+    }
+    if (stats.temperature > 0) {
+        col = screen.print(row, col, "  │  ");
+        col = screen.print(row, col, "CPU Temp:", Style::Bold);
+        screen.printf(row, col, Style::Plain, " %.1f°C", stats.temperature);
+    }
+    return closeSection(row + 1);
+}
+
+int TerminalMonitor::drawFilesystems(int row, const std::vector<MountUsage>& mounts) {
+    const size_t shown = 6;
+    const int barWidth = 20;
+    
+    // fullest filesystems first
+    std::vector<const MountUsage*> order;
+    order.reserve(mounts.size());
+    for (const MountUsage& mount : mounts) order.push_back(&mount);
+    size_t count = std::min(shown, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [](const MountUsage* a, const MountUsage* b) { return a->percent > b->percent; });
+    
+    row = openSection(row, "Filesystems", TerminalScreen::Yellow);
+    for (size_t i = 0; i < count; i++) {
+        const MountUsage& mount = *order[i];
+        int col = screen.printf(row, 0, TerminalScreen::Plain, "│ %-16.16s ", mount.mountPoint.c_str());
+        col = screen.bar(row, col, mount.percent, barWidth);
+        col = screen.printf(row, col, TerminalScreen::Bold, " %3.0f%%", mount.percent);
+        screen.print(row++, col, "  " + formatBytes(mount.used) + " / " + formatBytes(mount.total));
+    }
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawDisks(int row, const std::vector<DeviceStats>& devices) {
+    using Style = TerminalScreen;
+    const size_t shown = 6;
+    
+    // busiest devices first
+    std::vector<const DeviceStats*> order;
+    order.reserve(devices.size());
+    for (const DeviceStats& device : devices) order.push_back(&device);
+    size_t count = std::min(shown, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [](const DeviceStats* a, const DeviceStats* b) { return a->utilization > b->utilization; });
+    
+    row = openSection(row, "Disk I/O", Style::Yellow);
+    int col = screen.print(row, 0, "│ ");
+    screen.printf(row++, col, Style::Bold, "%-8s %7s %7s %12s %12s %5s %6s %4s",
+                  "DEVICE", "R/s", "W/s", "READ", "WRITE", "QUEUE", "AWAIT", "UTIL");
+    for (size_t i = 0; i < count; i++) {
+        const DeviceStats& device = *order[i];
+        std::string read = formatBytes(static_cast<unsigned long long>(device.readBytesPerSecond)) + "/s";
+        std::string write = formatBytes(static_cast<unsigned long long>(device.writeBytesPerSecond)) + "/s";
+        col = screen.printf(row, 0, Style::Plain, "│ %-8.8s %7.0f %7.0f %12s %12s %5.1f %6.1f ",
+                            device.name.c_str(), device.readsPerSecond, device.writesPerSecond,
+                            read.c_str(), write.c_str(), device.queueDepth, device.awaitMs);
+        uint8_t color = device.utilization >= 90 ? Style::Red : device.utilization >= 60 ? Style::Yellow : Style::Plain;
+        screen.printf(row++, col, color, "%3.0f%%", device.utilization);
+    }
+    return closeSection(row);
+}
+
+bool TerminalMonitor::addPressureTrigger(const std::string& spec, std::string& error) {
+    PressureTriggers& triggers = collector.pressureTriggers();
+    if (triggers.add(spec)) return true;
+    error = triggers.error();
+    return false;
+}
+
+int TerminalMonitor::drawBursts(int row, const FastStats& fast) {
+    using Style = TerminalScreen;
+    char title[64];
+    snprintf(title, sizeof(title), "Bursts (%u samples @ %.0f ms)", fast.samples, fast.periodMs);
+    row = openSection(row, title, Style::Blue);
+    
+    int col = screen.print(row, 0, "│ ");
+    screen.printf(row++, col, Style::Bold, "%-9s %14s %14s %14s", "", "MIN", "MEAN", "MAX");
+    uint8_t color = fast.cpu.max >= 90 ? Style::Red : fast.cpu.max >= 60 ? Style::Yellow : Style::Plain;
+    col = screen.printf(row, 0, Style::Plain, "│ %-9s %13.1f%% %13.1f%% ", "CPU", fast.cpu.min, fast.cpu.mean);
+    screen.printf(row++, col, color, "%13.1f%%", fast.cpu.max);
+    screen.printf(row++, 0, Style::Plain, "│ %-9s %13.1f%% %13.1f%% %13.1f%%",
+                  "Memory", fast.memory.min, fast.memory.mean, fast.memory.max);
+    screen.printf(row++, 0, Style::Plain, "│ %-9s %14s %14s %14s", "Download",
+                  (formatBytes(static_cast<unsigned long long>(fast.netRx.min)) + "/s").c_str(),
+                  (formatBytes(static_cast<unsigned long long>(fast.netRx.mean)) + "/s").c_str(),
+                  (formatBytes(static_cast<unsigned long long>(fast.netRx.max)) + "/s").c_str());
+    screen.printf(row++, 0, Style::Plain, "│ %-9s %14s %14s %14s", "Upload",
+                  (formatBytes(static_cast<unsigned long long>(fast.netTx.min)) + "/s").c_str(),
+                  (formatBytes(static_cast<unsigned long long>(fast.netTx.mean)) + "/s").c_str(),
+                  (formatBytes(static_cast<unsigned long long>(fast.netTx.max)) + "/s").c_str());
+    
+    // how late the sampler woke; missed ticks mean it could not keep up
+    color = fast.missed > 0 ? Style::Yellow : Style::Plain;
+    screen.printf(row++, 0, color, "│ jitter %.3f ms mean, %.3f ms max  │  %llu missed (%llu total)",
+                  fast.jitterMeanMs, fast.jitterMaxMs, fast.missed, fast.missedTotal);
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawPressure(int row, const Snapshot& snapshot) {
+    using Style = TerminalScreen;
+    const PressureStats& pressure = snapshot.pressure;
+    const SystemStats& stats = snapshot.stats;
+    
+    // recordings only keep the avg10 values, which end up in SystemStats
+    double recorded[PressureResourceCount][2] = {
+        {stats.pressureCpuSome, stats.pressureCpuFull},
+        {stats.pressureMemorySome, stats.pressureMemoryFull},
+        {stats.pressureIoSome, stats.pressureIoFull},
+    };
+    bool live = false;
+    bool any = false;
+    for (int resource = 0; resource < PressureResourceCount; resource++) {
+        live = live || pressure.resources[resource].available;
+        any = any || recorded[resource][0] > 0.0 || recorded[resource][1] > 0.0;
+    }
+    if (!live && !any) return row;
+    
+    row = openSection(row, "Pressure Stall", Style::Red);
+    int col = screen.print(row, 0, "│ ");
+    screen.printf(row++, col, Style::Bold, "%-8s %9s %8s %9s %8s %17s",
+                  "RESOURCE", "SOME 10s", "60s", "FULL 10s", "60s", "STALLED");
+    for (int resource = 0; resource < PressureResourceCount; resource++) {
+        const Pressure& entry = pressure.resources[resource];
+        if (live && !entry.available) continue;
+        const char* name = pressureResourceName(resource);
+        if (!live) {
+            screen.printf(row++, 0, Style::Plain, "│ %-8s %8.2f%% %8s %8.2f%% %8s %17s",
+                          name, recorded[resource][0], "-", recorded[resource][1], "-", "-");
+            continue;
+        }
+        char stalled[24];
+        snprintf(stalled, sizeof(stalled), "%.1fs", entry.some.totalUs / 1e6);
+        uint8_t color = entry.some.avg10 >= 40 ? Style::Red : entry.some.avg10 >= 10 ? Style::Yellow : Style::Plain;
+        screen.printf(row++, 0, color, "│ %-8s %8.2f%% %7.2f%% %8.2f%% %7.2f%% %17s",
+                      name, entry.some.avg10, entry.some.avg60, entry.full.avg10, entry.full.avg60, stalled);
+    }
+    
+    // triggers fire between samples; show how often and when last
+    for (const PressureTrigger& trigger : pressure.triggers) {
+        col = screen.printf(row, 0, Style::Plain, "│ trigger %s %s %ums/%ums: ", pressureResourceName(trigger.resource),
+                            trigger.full ? "full" : "some", trigger.stallUs / 1000, trigger.windowUs / 1000);
+        if (trigger.events == 0) {
+            screen.print(row++, col, "no events");
+            continue;
+        }
+        time_t seconds = static_cast<time_t>(trigger.lastEvent);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        char when[16];
+        strftime(when, sizeof(when), "%H:%M:%S", &local);
+        int millis = static_cast<int>((trigger.lastEvent - seconds) * 1000.0);
+        screen.printf(row++, col, Style::Yellow, "%llu events, last %s.%03d", trigger.events, when, millis);
+    }
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawCgroups(int row, const std::vector<CgroupStats>& cgroups) {
+    using Style = TerminalScreen;
+    const size_t shown = 8;
+    const size_t nameWidth = 24;
+    
+    // heaviest groups with processes in them; the root is the whole machine
+    std::vector<const CgroupStats*> order;
+    order.reserve(cgroups.size());
+    for (const CgroupStats& group : cgroups) {
+        if (group.depth > 0 && group.populated) order.push_back(&group);
+    }
+    if (order.empty()) return row;
+    size_t count = std::min(shown, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [](const CgroupStats* a, const CgroupStats* b) {
+                          if (a->cpuPercent != b->cpuPercent) return a->cpuPercent > b->cpuPercent;
+                          return a->memoryCurrent > b->memoryCurrent;
+                      });
+    
+    row = openSection(row, "Top Cgroups", Style::Blue);
+    int col = screen.print(row, 0, "│ ");
+    screen.printf(row++, col, Style::Bold, "%-24s %6s %10s %10s %11s %4s",
+                  "CGROUP", "CPU%", "MEMORY", "LIMIT", "IO", "PIDS");
+    for (size_t i = 0; i < count; i++) {
+        const CgroupStats& group = *order[i];
         
-        rxBytes += rx;
-        txBytes += tx;
+        // the leaf names matter most, so long paths lose their start
+        std::string name = group.path;
+        if (name.size() > nameWidth) name = "~" + name.substr(name.size() - (nameWidth - 1));
+        std::string limit = group.memoryMax > 0 ? formatBytes(group.memoryMax) : "-";
+        std::string io = formatBytes(static_cast<unsigned long long>(
+                             group.readBytesPerSecond + group.writeBytesPerSecond)) + "/s";
+        screen.printf(row++, 0, Style::Plain, "│ %-24s %6.1f %10s %10s %11s %4llu",
+                      name.c_str(), group.cpuPercent, formatBytes(group.memoryCurrent).c_str(), limit.c_str(),
+                      io.c_str(), group.pids);
     }
+    return closeSection(row);
+}
+
+// "850 us", "12.40 ms"
+static std::string formatMicros(double us) {
+    char text[24];
+    if (us < 1000.0) snprintf(text, sizeof(text), "%.0f us", us);
+    else snprintf(text, sizeof(text), "%.2f ms", us / 1000.0);
+    return text;
+}
+
+int TerminalMonitor::drawSelfStats(int row, const Snapshot& snapshot) {
+    using Style = TerminalScreen;
+    const SelfStats& self = snapshot.self;
+    const SystemStats& stats = snapshot.stats;
     
-    stats.netRxBytes = rxBytes;
-    stats.netTxBytes = txBytes;
+    // recordings keep the last pass of each collector and the pass totals
+    const double recorded[CollectorCount] = {
+        stats.collectCpuUs, stats.collectMemoryUs, stats.collectDiskUs, stats.collectNetworkUs,
+        stats.collectProcessesUs, stats.collectPressureUs, stats.collectCgroupsUs, stats.collectSystemUs,
+    };
+    bool live = self.collectors[CollectCpu].calls > 0;
     
-    if (lastRxBytes > 0) {
-        stats.netRxSpeed = rxBytes - lastRxBytes;
-        stats.netTxSpeed = txBytes - lastTxBytes;
-    } else {
-        stats.netRxSpeed = 0;
-        stats.netTxSpeed = 0;
+    row = openSection(row, "Collector Overhead", Style::Magenta);
+    int col = screen.print(row, 0, "│ ");
+    screen.printf(row++, col, Style::Bold, "%-10s %9s %9s %9s %9s %11s", "COLLECTOR", "LAST", "P50", "P99", "SYSCALLS", "BYTES");
+    double total = 0.0;
+    for (int collector = 0; collector < CollectorCount; collector++) {
+        const CollectorStats& entry = self.collectors[collector];
+        double last = live ? entry.lastUs : recorded[collector];
+        total += last;
+        if (!live) {
+            screen.printf(row++, 0, Style::Plain, "│ %-10s %9s %9s %9s %9s %11s",
+                          collectorName(collector), formatMicros(last).c_str(), "-", "-", "-", "-");
+            continue;
+        }
+        if (entry.calls == 0) continue;
+        // p50/p99 are bucket bounds, so within a factor of two
+        uint8_t color = last >= 100000.0 ? Style::Red : last >= 10000.0 ? Style::Yellow : Style::Plain;
+        screen.printf(row++, 0, color, "│ %-10s %9s %9s %9s %9llu %11s", collectorName(collector),
+                      formatMicros(last).c_str(), formatMicros(entry.percentileUs(0.5)).c_str(),
+                      formatMicros(entry.percentileUs(0.99)).c_str(), entry.lastSyscalls,
+                      formatBytes(entry.lastBytes).c_str());
     }
+    screen.printf(row++, 0, Style::Bold, "│ %-10s %9s %9s %9s %9llu %11s", "total", formatMicros(total).c_str(), "", "",
+                  stats.collectSyscalls, formatBytes(stats.collectBytes).c_str());
+    screen.printf(row++, 0, Style::Plain, "│ monitor cpu %.1f%%  │  rss %s", stats.selfCpu, formatBytes(stats.selfRss).c_str());
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawNetwork(int row, const SystemStats& stats, const std::vector<InterfaceStats>& interfaces) {
+    using Style = TerminalScreen;
+    const size_t shown = 8;
+    
+    // the summary shows the selected interface when it exists, else the sum
+    const InterfaceStats* selected = nullptr;
+    if (!selectedInterface.empty()) {
+        for (const InterfaceStats& device : interfaces) {
+            if (device.name == selectedInterface) selected = &device;
+        }
+    }
+    unsigned long long rxSpeed = selected ? static_cast<unsigned long long>(selected->rxRate) : stats.netRxSpeed;
+    unsigned long long txSpeed = selected ? static_cast<unsigned long long>(selected->txRate) : stats.netTxSpeed;
+    unsigned long long rxBytes = selected ? selected->rxBytes : stats.netRxBytes;
+    unsigned long long txBytes = selected ? selected->txBytes : stats.netTxBytes;
     
-    lastRxBytes = rxBytes;
-    lastTxBytes = txBytes;
+    std::string title = selected ? "Network Statistics (" + selected->name + ")" : "Network Statistics";
+    row = openSection(row, title.c_str(), Style::Magenta);
+    int col = screen.print(row, 0, "│ ");
+    col = screen.print(row, col, "Download Speed:", Style::Bold);
+    col = screen.print(row, col, " " + formatBytes(rxSpeed) + "/s  │  ");
+    col = screen.print(row, col, "Upload Speed:", Style::Bold);
+    screen.print(row++, col, " " + formatBytes(txSpeed) + "/s");
+    col = screen.print(row, 0, "│ ");
+    col = screen.print(row, col, "Total Downloaded:", Style::Bold);
+    col = screen.print(row, col, " " + formatBytes(rxBytes) + "  │  ");
+    col = screen.print(row, col, "Total Uploaded:", Style::Bold);
+    screen.print(row++, col, " " + formatBytes(txBytes));
     
-    return stats;
+    if (!interfaces.empty()) {
+        // busiest interfaces first
+        std::vector<const InterfaceStats*> order;
+        order.reserve(interfaces.size());
+        for (const InterfaceStats& device : interfaces) order.push_back(&device);
+        size_t count = std::min(shown, order.size());
+        std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                          [](const InterfaceStats* a, const InterfaceStats* b) {
+                              return a->rxRate + a->txRate > b->rxRate + b->txRate;
+                          });
+        
+        col = screen.print(row, 0, "│ ");
+        screen.printf(row++, col, Style::Bold, "%-9s %13s %13s %8s %8s %5s %5s",
+                      "IFACE", "RX/s", "TX/s", "RX pkt/s", "TX pkt/s", "ERRS", "DROP");
+        for (size_t i = 0; i < count; i++) {
+            const InterfaceStats& device = *order[i];
+            std::string rx = formatBytes(static_cast<unsigned long long>(device.rxRate)) + "/s";
+            std::string tx = formatBytes(static_cast<unsigned long long>(device.txRate)) + "/s";
+            screen.printf(row++, 0, Style::Plain, "│ %-9.9s %13s %13s %8.0f %8.0f %5llu %5llu",
+                          device.name.c_str(), rx.c_str(), tx.c_str(), device.rxPacketRate, device.txPacketRate,
+                          device.rxErrors + device.txErrors, device.rxDrops + device.txDrops);
+        }
+    }
+    return closeSection(row);
 }
 
-void TerminalMonitor::displayStats(const SystemStats& stats) {
-    clearScreen();
+void TerminalMonitor::run(const volatile sig_atomic_t* stop) {
+    // deadlines are absolute, so a slow frame does not push the next one back
+    ticker.start(2000000000LL);
+    if (fastInterval > 0 && !fast.start(fastInterval)) footer = "Fast sampling off: " + fast.error();
     
-    // header
-    std::cout << colorize("╔════════════════════════════════════════════════════════════════════╗", CYAN) << std::endl;
-    std::cout << colorize("║", CYAN) << colorize("                    SYSPULSE SYSTEM MONITOR                     ", BOLD) << colorize("║", CYAN) << std::endl;
-    std::cout << colorize("╚════════════════════════════════════════════════════════════════════╝", CYAN) << std::endl;
-    std::cout << std::endl;
-    
-    // system info
-    std::cout << colorize("┌─ System Information ", CYAN) << std::string(48, '─') << std::endl;
-    std::cout << "│ " << colorize("Uptime:", BOLD) << " " << stats.uptime 
-              << "  │  " << colorize("Processes:", BOLD) << " " << stats.processes;
-    if (stats.temperature > 0) {
-        std::cout << "  │  " << colorize("CPU Temp:", BOLD) << " " 
-                  << std::fixed << std::setprecision(1) << stats.temperature << "°C";
+    while (!stop || !*stop) {
+        displayStats(collect(), &collector.strings());
+        ticker.wait();
     }
-    std::cout << std::endl;
-    std::cout << "└" << std::string(68, '─') << std::endl;
-    std::cout << std::endl;
-    
-    // cpu
-    std::cout << colorize("┌─ CPU Usage ", BLUE) << std::string(56, '─') << std::endl;
-    std::cout << "│ " << getProgressBar(stats.cpu, 50) 
-              << " " << colorize(std::to_string(static_cast<int>(stats.cpu)) + "%", BOLD) << std::endl;
-    std::cout << "└" << std::string(68, '─') << std::endl;
-    std::cout << std::endl;
-    
-    // memory
-    std::cout << colorize("┌─ Memory Usage ", GREEN) << std::string(53, '─') << std::endl;
-    std::cout << "│ " << getProgressBar(stats.memory, 50) 
-              << " " << colorize(std::to_string(static_cast<int>(stats.memory)) + "%", BOLD) << std::endl;
-    std::cout << "└" << std::string(68, '─') << std::endl;
-    std::cout << std::endl;
-    
-    // disk
-    std::cout << colorize("┌─ Disk Usage (/) ", YELLOW) << std::string(51, '─') << std::endl;
-    std::cout << "│ " << getProgressBar(stats.disk, 50) 
-              << " " << colorize(std::to_string(static_cast<int>(stats.disk)) + "%", BOLD) << std::endl;
-    std::cout << "└" << std::string(68, '─') << std::endl;
-    std::cout << std::endl;
-    
-    // network
-    std::cout << colorize("┌─ Network Statistics ", MAGENTA) << std::string(47, '─') << std::endl;
-    std::cout << "│ " << colorize("Download Speed:", BOLD) << " " << formatBytes(stats.netRxSpeed) << "/s" 
-              << "  │  " << colorize("Upload Speed:", BOLD) << " " << formatBytes(stats.netTxSpeed) << "/s" << std::endl;
-    std::cout << "│ " << colorize("Total Downloaded:", BOLD) << " " << formatBytes(stats.netRxBytes)
-              << "  │  " << colorize("Total Uploaded:", BOLD) << " " << formatBytes(stats.netTxBytes) << std::endl;
-    std::cout << "└" << std::string(68, '─') << std::endl;
-    std::cout << std::endl;
+    ticker.stop();
+    fast.stop();
+}
+
+bool TerminalMonitor::serve(MetricsServer& server, const volatile sig_atomic_t* stop) {
+    if (fastInterval > 0) fast.start(fastInterval);
     
-    // footer
-    std::cout << colorize("Press Ctrl+C to exit", CYAN) << " | Refreshing every 2 seconds..." << std::endl;
+    // rendered once per sample; scrapes only send the finished buffer
+    bool ok = server.run(2000, [this, &server]() {
+        renderPrometheus(collect(), exposition);
+        server.publish(exposition);
+    }, stop);
+    fast.stop();
+    return ok;
 }
 
-void TerminalMonitor::run() {
-    while (true) {
-        SystemStats stats = getStats();
-        displayStats(stats);
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+int TerminalMonitor::drawProcesses(int row, const std::vector<ProcessInfo>& list, const StringPool& strings) {
+    const size_t shown = 10;
+    
+    // top processes by cpu without sorting the whole table
+    std::vector<const ProcessInfo*> top;
+    top.reserve(list.size());
+    for (const ProcessInfo& process : list) top.push_back(&process);
+    size_t count = std::min({shown, top.size(), static_cast<size_t>(processRows)});
+    std::partial_sort(top.begin(), top.begin() + count, top.end(),
+                      [](const ProcessInfo* a, const ProcessInfo* b) { return a->cpu > b->cpu; });
+    
+    row = openSection(row, "Top Processes", TerminalScreen::Cyan);
+    int col = screen.print(row, 0, "│ ");
+    screen.print(row++, col, "    PID  CPU%   MEM%  USER        NAME", TerminalScreen::Bold);
+    for (size_t i = 0; i < count; i++) {
+        const ProcessInfo& process = *top[i];
+        std::string user = strings.str(process.userId).substr(0, 11);
+        col = screen.printf(row, 0, TerminalScreen::Plain, "│ %7d %5.1f %6.1f  %-11s ",
+                            process.pid, process.cpu, process.memory, user.c_str());
+        screen.print(row++, col, strings.str(process.nameId));
+    }
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawProcessIo(int row, const std::vector<ProcessInfo>& list, const StringPool& strings) {
+    const size_t shown = 5;
+    
+    // busiest by bytes moved, then by syscalls, among processes doing any io
+    std::vector<const ProcessInfo*> top;
+    for (const ProcessInfo& process : list) {
+        if (process.readBytesPerSecond + process.writeBytesPerSecond + process.readCallsPerSecond +
+            process.writeCallsPerSecond > 0) {
+            top.push_back(&process);
+        }
+    }
+    size_t count = std::min(shown, top.size());
+    std::partial_sort(top.begin(), top.begin() + count, top.end(),
+                      [](const ProcessInfo* a, const ProcessInfo* b) {
+                          double aBytes = a->readBytesPerSecond + a->writeBytesPerSecond;
+                          double bBytes = b->readBytesPerSecond + b->writeBytesPerSecond;
+                          if (aBytes != bBytes) return aBytes > bBytes;
+                          return a->readCallsPerSecond + a->writeCallsPerSecond >
+                                 b->readCallsPerSecond + b->writeCallsPerSecond;
+                      });
+    
+    row = openSection(row, "Top I/O", TerminalScreen::Yellow);
+    int col = screen.print(row, 0, "│ ");
+    screen.print(row++, col, "    PID       READ/s      WRITE/s  RCALL/s  WCALL/s  NAME", TerminalScreen::Bold);
+    for (size_t i = 0; i < count; i++) {
+        const ProcessInfo& process = *top[i];
+        std::string read = formatBytes(static_cast<unsigned long long>(process.readBytesPerSecond)) + "/s";
+        std::string write = formatBytes(static_cast<unsigned long long>(process.writeBytesPerSecond)) + "/s";
+        col = screen.printf(row, 0, TerminalScreen::Plain, "│ %7d %12s %12s %8.0f %8.0f  ",
+                            process.pid, read.c_str(), write.c_str(),
+                            process.readCallsPerSecond, process.writeCallsPerSecond);
+        screen.print(row++, col, strings.str(process.nameId));
+    }
+    if (count == 0) screen.print(row++, 0, "│ no process did any io over the last interval");
+    return closeSection(row);
+}
+
+int TerminalMonitor::drawProcessTree(int row, const StringPool& strings) {
+    const int shown = 20;
+    const size_t branches = 3;          // children listed under each process
+    
+    row = openSection(row, "Process Tree", TerminalScreen::Cyan);
+    int col = screen.print(row, 0, "│ ");
+    screen.print(row++, col, "    PID  CPU% TREE%   MEM%  TREE%  NAME", TerminalScreen::Bold);
+    
+    // depth first, the busiest subtrees of each level first; pending is a
+    // stack, so the busiest child goes on last
+    std::vector<int> pending;
+    std::vector<int> ranked;
+    auto pushBusiest = [&](const std::vector<int>& children) {
+        ranked = children;
+        size_t count = std::min(branches, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [this](int a, int b) {
+            return tree.find(a)->subtreeCpu > tree.find(b)->subtreeCpu;
+        });
+        for (size_t i = count; i-- > 0; ) pending.push_back(ranked[i]);
+    };
+    pushBusiest(tree.children(0));
+    
+    for (int listed = 0; listed < std::min(shown, processRows) && !pending.empty(); listed++) {
+        const ProcessTreeNode& node = *tree.find(pending.back());
+        pending.pop_back();
+        
+        std::string name = std::string(node.depth * 2, ' ') + strings.str(node.info.nameId);
+        if (node.descendants > 0) name += " (+" + std::to_string(node.descendants) + ")";
+        screen.printf(row++, 0, TerminalScreen::Plain, "│ %7d %5.1f %5.1f %6.1f %6.1f  %.40s",
+                      node.info.pid, node.info.cpu, node.subtreeCpu, node.info.memory, node.subtreeMemory,
+                      name.c_str());
+        pushBusiest(node.children);
+    }
+    return closeSection(row);
+}
+
+void TerminalMonitor::replay(RecordingReader& reader, double from, double speed,
+                             const volatile sig_atomic_t* stop) {
+    RecordingReader::Position position;
+    if (!reader.seek(from, position)) return;
+    
+    // each sample is decoded once: read ahead, it times the wait before it
+    // and is then shown
+    Snapshot snapshot;
+    if (!reader.read(position, snapshot)) return;
+    while (!stop || !*stop) {
+        char when[32];
+        time_t seconds = static_cast<time_t>(snapshot.stats.timestamp);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+        
+        std::ostringstream status;
+        status << "Replaying " << when << " (x" << speed << ")";
+        footer = status.str();
+        
+        displayStats(snapshot, &reader.strings());
+        
+        double shown = snapshot.stats.timestamp;
+        if (!reader.advance(position) || !reader.read(position, snapshot)) break;
+        
+        // keep the recorded pacing, but don't sit out the gap between two
+        // runs; interrupt() ends the wait early
+        double delay = std::min((snapshot.stats.timestamp - shown) / speed, 5.0);
+        if (delay > 0 && ticker.start(static_cast<long long>(delay * 1e9))) ticker.wait();
     }
+    ticker.stop();
 }
 
 void TerminalMonitor::runOnce() {
-    SystemStats stats = getStats();
-    displayStats(stats);
+    displayStats(collect(), &collector.strings());
 }
\ No newline at end of file
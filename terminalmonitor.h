@@ -1,50 +1,129 @@
 #ifndef TERMINALMONITOR_H
 #define TERMINALMONITOR_H
 
+#include <csignal>
 #include <string>
 #include <vector>
-
-struct SystemStats {
-    double cpu;
-    double memory;
-    double disk;
-    std::string uptime;
-    int processes;
-    double temperature;
-    unsigned long long netRxBytes;
-    unsigned long long netTxBytes;
-    unsigned long long netRxSpeed;
-    unsigned long long netTxSpeed;
-};
+#include "fastsampler.h"
+#include "metricsserver.h"
+#include "processtree.h"
+#include "recorder.h"
+#include "recordingreader.h"
+#include "systemcollector.h"
+#include "terminalscreen.h"
+#include "ticker.h"
 
 class TerminalMonitor {
 public:
     TerminalMonitor();
-    void run();
+    
+    // loops until *stop becomes non-zero (e.g. from a signal handler)
+    void run(const volatile sig_atomic_t* stop = nullptr);
     void runOnce();
     
+    // headless: sample every 2 seconds and publish each sample to server
+    // as prometheus text instead of drawing it
+    bool serve(MetricsServer& server, const volatile sig_atomic_t* stop = nullptr);
+    
+    // play a recording from `from` (unix seconds) at `speed` times real time
+    void replay(RecordingReader& reader, double from, double speed,
+                const volatile sig_atomic_t* stop = nullptr);
+    
+    // end the wait between two frames of run() or replay() now, so *stop is
+    // seen at once; async-signal-safe, for the handler that sets it
+    void interrupt() { ticker.interrupt(); }
+    
+    // every sample is also appended to recorder, which the caller owns
+    void setRecorder(Recorder* target) { recorder = target; }
+    
+    // speed and totals of this interface instead of the non-loopback sum;
+    // empty for the sum. live only, recordings keep the sum
+    void setInterface(const std::string& name) { selectedInterface = name; }
+    
+    // sample cpu, memory and network every periodMs (10-100) between frames
+    // and show their min/mean/max; 0 turns it off
+    void setFastInterval(int periodMs) { fastInterval = periodMs; }
+    
+    // show what each collector costs the monitor itself: wall time, syscalls, bytes read
+    void setSelfStats(bool enabled) { showSelfStats = enabled; }
+    
+    // list processes as a parent/child tree with subtree totals instead of
+    // the top ten; samples the process table even when not recording it
+    void setProcessTree(bool enabled) { showTree = enabled; }
+    
+    // list the processes moving the most bytes to and from storage; also
+    // samples the process table when not recording it
+    void setTopIo(bool enabled) { showTopIo = enabled; }
+    
+    // see PressureTriggers::add; events show up in the pressure section
+    bool addPressureTrigger(const std::string& spec, std::string& error);
+    
+    // see SystemCollector::trackProcessEvents; false leaves the /proc walk
+    bool trackProcessEvents(std::string& error) { return collector.trackProcessEvents(error); }
+    
 private:
-    SystemStats getStats();
-    void displayStats(const SystemStats& stats);
-    void clearScreen();
-    std::string getProgressBar(double percentage, int width = 40);
+    // frames are drawn this wide
+    static const int SectionWidth = 69;
+    
+    // the parts of a frame below the header, top to bottom
+    enum Section {
+        SectionSystem,
+        SectionCpu,
+        SectionCores,
+        SectionMemory,
+        SectionBursts,
+        SectionFilesystems,
+        SectionDisks,
+        SectionPressure,
+        SectionNetwork,
+        SectionCgroups,
+        SectionSelfStats,
+        SectionProcesses,
+        SectionProcessIo,
+        SectionCount
+    };
+    
+    // samples into current and appends it to the recorder
+    const Snapshot& collect();
+    // processes are listed when the snapshot has them
+    void displayStats(const Snapshot& snapshot, const StringPool* strings = nullptr);
+    // header and the shown sections; returns the row below them and the
+    // height of each section drawn
+    int drawFrame(const Snapshot& snapshot, const StringPool* strings, const bool* shown, int* heights);
+    int drawSection(int section, int row, const Snapshot& snapshot, const StringPool* strings);
+    int drawSystem(int row, const Snapshot& snapshot);
+    int openSection(int row, const char* title, uint8_t color);
+    int closeSection(int row);
+    int drawUsage(int row, const char* title, uint8_t color, double percentage,
+                  const std::string& detail = std::string());
+    int drawCores(int row, const CoreUsage& cores);
+    int drawFilesystems(int row, const std::vector<MountUsage>& mounts);
+    int drawDisks(int row, const std::vector<DeviceStats>& devices);
+    int drawBursts(int row, const FastStats& fast);
+    int drawPressure(int row, const Snapshot& snapshot);
+    int drawCgroups(int row, const std::vector<CgroupStats>& cgroups);
+    int drawSelfStats(int row, const Snapshot& snapshot);
+    int drawNetwork(int row, const SystemStats& stats, const std::vector<InterfaceStats>& interfaces);
+    int drawProcesses(int row, const std::vector<ProcessInfo>& list, const StringPool& strings);
+    int drawProcessIo(int row, const std::vector<ProcessInfo>& list, const StringPool& strings);
+    int drawProcessTree(int row, const StringPool& strings);
     std::string formatBytes(unsigned long long bytes);
-    std::string colorize(const std::string& text, const std::string& color);
-    
-    // ANSI color codes
-    static const std::string RESET;
-    static const std::string RED;
-    static const std::string GREEN;
-    static const std::string YELLOW;
-    static const std::string BLUE;
-    static const std::string MAGENTA;
-    static const std::string CYAN;
-    static const std::string BOLD;
-    
-    unsigned long long lastTotalTime;
-    unsigned long long lastIdleTime;
-    unsigned long long lastRxBytes;
-    unsigned long long lastTxBytes;
+    
+    TerminalScreen screen;
+    Ticker ticker;                      // paces frames; interrupt() wakes it
+    SystemCollector collector;
+    FastSampler fast;
+    int fastInterval;
+    bool showSelfStats;
+    bool showTree;
+    bool showTopIo;
+    int processRows;                    // most processes listed in this frame
+    ProcessTree tree;
+    Recorder* recorder;
+    Snapshot current;
+    std::string footer;
+    std::string selectedInterface;
+    std::string exposition;
 };
 
 #endif
\ No newline at end of file
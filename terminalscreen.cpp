@@ -0,0 +1,198 @@
+#include "terminalscreen.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static const uint32_t Blank = ' ';
+
+// used when the output is not a terminal
+static const int DefaultWidth = 80;
+static const int DefaultHeight = 60;
+
+TerminalScreen::TerminalScreen(int fd)
+    : fd(fd), rows(0), columns(0), repaint(true), cursorHidden(false), frameBytes(0) {
+}
+
+TerminalScreen::~TerminalScreen() {
+    if (!cursorHidden) return;
+    
+    // leave the cursor below the last frame with default colours
+    char restore[32];
+    int length = snprintf(restore, sizeof(restore), "\033[0m\033[%d;1H\033[?25h", rows);
+    if (length > 0 && ::write(fd, restore, static_cast<size_t>(length)) < 0) {
+        // nothing sensible to do while exiting
+    }
+}
+
+void TerminalScreen::resize(int width, int height) {
+    columns = width;
+    rows = height;
+    back.assign(static_cast<size_t>(rows) * columns, Cell{Blank, Plain});
+    front = back;
+    repaint = true;
+}
+
+void TerminalScreen::clear() {
+    winsize size = {};
+    int width = DefaultWidth;
+    int height = DefaultHeight;
+    if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        width = size.ws_col;
+        height = size.ws_row;
+    }
+    
+    if (width != columns || height != rows) {
+        resize(width, height);
+    } else {
+        std::fill(back.begin(), back.end(), Cell{Blank, Plain});
+    }
+}
+
+int TerminalScreen::put(int row, int col, const char* text, size_t length, uint8_t style) {
+    const unsigned char* pos = reinterpret_cast<const unsigned char*>(text);
+    const unsigned char* end = pos + length;
+    
+    while (pos < end) {
+        // one cell per code point; stray bytes show as '?'
+        size_t size = *pos < 0x80 ? 1 : (*pos >> 5) == 0x6 ? 2 : (*pos >> 4) == 0xe ? 3 : (*pos >> 3) == 0x1e ? 4 : 0;
+        uint32_t glyph = '?';
+        if (size == 0 || pos + size > end) {
+            size = 1;
+        } else {
+            glyph = 0;
+            for (size_t i = 0; i < size; i++) glyph |= static_cast<uint32_t>(pos[i]) << (8 * i);
+        }
+        if (glyph < 0x20) glyph = ' ';
+        pos += size;
+        
+        if (row >= 0 && row < rows && col >= 0 && col < columns) {
+            back[static_cast<size_t>(row) * columns + col] = Cell{glyph, style};
+        }
+        col++;
+    }
+    return col;
+}
+
+int TerminalScreen::print(int row, int col, const char* text, uint8_t style) {
+    return put(row, col, text, strlen(text), style);
+}
+
+int TerminalScreen::print(int row, int col, const std::string& text, uint8_t style) {
+    return put(row, col, text.data(), text.size(), style);
+}
+
+int TerminalScreen::printf(int row, int col, uint8_t style, const char* format, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return col;
+    
+    size_t size = static_cast<size_t>(length) < sizeof(text) ? static_cast<size_t>(length) : sizeof(text) - 1;
+    return put(row, col, text, size, style);
+}
+
+int TerminalScreen::repeat(int row, int col, int count, const char* glyph, uint8_t style) {
+    size_t length = strlen(glyph);
+    for (int i = 0; i < count; i++) col = put(row, col, glyph, length, style);
+    return col;
+}
+
+int TerminalScreen::bar(int row, int col, double percentage, int width) {
+    if (percentage < 0) percentage = 0;
+    if (percentage > 100) percentage = 100;
+    int filled = static_cast<int>(percentage * width / 100.0);
+    
+    uint8_t color = percentage < 50 ? Green : percentage < 80 ? Yellow : Red;
+    col = print(row, col, "[");
+    col = repeat(row, col, filled, "█", color);
+    col = repeat(row, col, width - filled, "░");
+    return print(row, col, "]");
+}
+
+void TerminalScreen::appendStyle(uint8_t style) {
+    // reset first so bold never leaks from the previous cell
+    output += "\033[0";
+    if (style & Bold) output += ";1";
+    if (style & 0x0f) {
+        output += ";3";
+        output += static_cast<char>('0' + (style & 0x0f));
+    }
+    output += 'm';
+}
+
+void TerminalScreen::present() {
+    output.clear();
+    
+    if (repaint) {
+        // a cleared terminal matches an all-blank front buffer
+        output += "\033[?25l\033[0m\033[2J";
+        std::fill(front.begin(), front.end(), Cell{Blank, Plain});
+        cursorHidden = true;
+        repaint = false;
+    }
+    
+    int cursorRow = -1;
+    int cursorCol = -1;
+    int currentStyle = -1;
+    
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < columns; col++) {
+            size_t index = static_cast<size_t>(row) * columns + col;
+            const Cell& cell = back[index];
+            if (cell == front[index]) continue;
+            
+            if (row != cursorRow || col != cursorCol) {
+                // re-sending a short run of unchanged cells is cheaper than a move
+                int gap = col - cursorCol;
+                if (row == cursorRow && gap > 0 && gap <= 4) {
+                    for (int skip = cursorCol; skip < col; skip++) {
+                        const Cell& same = back[static_cast<size_t>(row) * columns + skip];
+                        if (same.style != currentStyle) {
+                            appendStyle(same.style);
+                            currentStyle = same.style;
+                        }
+                        for (uint32_t glyph = same.glyph; glyph; glyph >>= 8) output += static_cast<char>(glyph & 0xff);
+                    }
+                } else {
+                    char move[24];
+                    int length = snprintf(move, sizeof(move), "\033[%d;%dH", row + 1, col + 1);
+                    output.append(move, static_cast<size_t>(length));
+                }
+            }
+            
+            if (cell.style != currentStyle) {
+                appendStyle(cell.style);
+                currentStyle = cell.style;
+            }
+            for (uint32_t glyph = cell.glyph; glyph; glyph >>= 8) output += static_cast<char>(glyph & 0xff);
+            
+            front[index] = cell;
+            cursorRow = row;
+            cursorCol = col + 1;
+        }
+    }
+    if (currentStyle > 0) output += "\033[0m";
+    
+    frameBytes = output.size();
+    
+    // one write per frame; only a full pipe splits it
+    const char* pos = output.data();
+    size_t remaining = output.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, pos, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // the terminal went away; repaint everything if it comes back
+            repaint = true;
+            break;
+        }
+        pos += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
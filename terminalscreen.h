@@ -0,0 +1,80 @@
+#ifndef TERMINALSCREEN_H
+#define TERMINALSCREEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// off-screen cell buffer for the terminal front end. a frame is drawn into
+// the back buffer, and present() compares it with what the terminal already
+// shows and emits only the cells that changed (cursor moves, colour changes
+// and text) as a single write(2). the screen is cleared only on the first
+// frame and after a resize.
+class TerminalScreen {
+public:
+    enum Style : uint8_t {
+        Plain = 0,
+        Red = 1,
+        Green = 2,
+        Yellow = 3,
+        Blue = 4,
+        Magenta = 5,
+        Cyan = 6,
+        Bold = 0x10
+    };
+    
+    explicit TerminalScreen(int fd = 1);
+    ~TerminalScreen();
+    
+    TerminalScreen(const TerminalScreen&) = delete;
+    TerminalScreen& operator=(const TerminalScreen&) = delete;
+    
+    // blank the back buffer, picking up a terminal resize
+    void clear();
+    
+    int width() const { return columns; }
+    int height() const { return rows; }
+    
+    // draw utf-8 text at row/col; anything outside the screen is clipped.
+    // each returns the column after the last cell written.
+    int print(int row, int col, const char* text, uint8_t style = Plain);
+    int print(int row, int col, const std::string& text, uint8_t style = Plain);
+    int printf(int row, int col, uint8_t style, const char* format, ...)
+        __attribute__((format(printf, 5, 6)));
+    int repeat(int row, int col, int count, const char* glyph, uint8_t style = Plain);
+    
+    // [████░░░░] coloured green/yellow/red by percentage
+    int bar(int row, int col, double percentage, int width);
+    
+    // emit the difference to the previous frame
+    void present();
+    
+    // bytes the last present() wrote
+    size_t lastFrameBytes() const { return frameBytes; }
+    
+private:
+    struct Cell {
+        uint32_t glyph;     // utf-8 bytes of one code point, packed little-endian
+        uint8_t style;
+        
+        bool operator==(const Cell& other) const { return glyph == other.glyph && style == other.style; }
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+    
+    void resize(int width, int height);
+    int put(int row, int col, const char* text, size_t length, uint8_t style);
+    void appendStyle(uint8_t style);
+    
+    int fd;
+    int rows;
+    int columns;
+    bool repaint;
+    bool cursorHidden;
+    std::vector<Cell> back;
+    std::vector<Cell> front;
+    std::string output;
+    size_t frameBytes;
+};
+
+#endif